@@ -0,0 +1,210 @@
+/**
+ *  @file   arena.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Allocator interface and bump arena for the containers
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "arena.h"
+
+#define AR_ROUND(n) (((n) + AR_ALIGN - 1) & ~(size_t)(AR_ALIGN - 1))
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Chunk {
+    struct _Chunk *next;
+    size_t size;
+};
+
+#define AR_HEADSIZE AR_ROUND(sizeof(struct _Chunk))
+
+/*
+ * base comes first so the allocator handed out is the arena itself. last
+ * is the latest allocation, the only one that can grow in place or be
+ * given back.
+ */
+struct _Arena {
+    allocator base;
+    size_t chunk;
+    size_t limit;
+    size_t taken;
+    struct _Chunk *chunks;
+    char *bump;
+    char *end;
+    char *last;
+};
+
+
+/**
+ * Static-scope functions declaration
+ *
+ */
+static void *arenaalloc(size_t, void *);
+static void *arenaresize(void *, size_t, size_t, void *);
+static void arenarelease(void *, size_t, void *);
+static int newchunk(struct _Arena *, size_t);
+
+
+/**
+ * Functions definition
+ *
+ */
+allocator *ARnew(size_t chunk, size_t limit) {
+    struct _Arena *ar = malloc(sizeof(struct _Arena));
+    
+    if (ar == NULL) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    memset(ar, 0, sizeof(struct _Arena));
+    ar->base.alloc = arenaalloc;
+    ar->base.resize = arenaresize;
+    ar->base.release = arenarelease;
+    ar->base.ctx = ar;
+    ar->chunk = (chunk > AR_MINCHUNK)?chunk:AR_MINCHUNK;
+    ar->limit = limit;
+    return &ar->base;
+}
+
+/*
+ * Frees everything the arena handed out, keeping its latest chunk for
+ * reuse. Lists allocated from it must have been disposed.
+ */
+void ARreset(allocator *al) {
+    struct _Arena *ar = al->ctx;
+    struct _Chunk *c = NULL;
+    
+    if (ar->chunks == NULL) {
+        return;
+    }
+    while ((c = ar->chunks->next) != NULL) {
+        ar->chunks->next = c->next;
+        free(c);
+    }
+    ar->taken = ar->chunks->size;
+    ar->bump = (char *)ar->chunks + AR_HEADSIZE;
+    ar->last = NULL;
+}
+
+void ARdispose(allocator *al) {
+    struct _Arena *ar = al->ctx;
+    struct _Chunk *c = NULL;
+    
+    while ((c = ar->chunks) != NULL) {
+        ar->chunks = c->next;
+        free(c);
+    }
+    free(ar);
+}
+
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *arenaalloc(size_t size, void *ctx) {
+    struct _Arena *ar = ctx;
+    char *p = NULL;
+    
+    if (size > ((size_t)-1 >> 1)) {
+        errno = ENOMEM;
+        return NULL;
+    }
+    size = AR_ROUND(size);
+    if (((size_t)(ar->end - ar->bump) < size) && (newchunk(ar, size) != 0)) {
+        return NULL;
+    }
+    p = ar->bump;
+    ar->bump += size;
+    ar->last = p;
+    return p;
+}
+
+static void *arenaresize(void *p, size_t old, size_t size, void *ctx) {
+    struct _Arena *ar = ctx;
+    char *q = NULL;
+    
+    if (p == NULL) {
+        return arenaalloc(size, ctx);
+    }
+    if ((p == ar->last) && (size <= ((size_t)-1 >> 1))
+        && ((size_t)(ar->end - ar->last) >= AR_ROUND(size))) {
+        ar->bump = ar->last + AR_ROUND(size);
+        return p;
+    }
+    if ((q = arenaalloc(size, ctx)) != NULL) {
+        memcpy(q, p, (old < size)?old:size);
+    }
+    return q;
+}
+
+static void arenarelease(void *p, size_t size, void *ctx) {
+    struct _Arena *ar = ctx;
+    
+    (void)size;
+    if ((p != NULL) && (p == ar->last)) {
+        ar->bump = ar->last;
+        ar->last = NULL;
+    }
+}
+
+/*
+ * Starts a chunk with room for at least size bytes, cut down to what is
+ * left under the limit when a full chunk would go past it.
+ */
+static int newchunk(struct _Arena *ar, size_t size) {
+    struct _Chunk *c = NULL;
+    size_t n = AR_HEADSIZE + size;
+    
+    if (n < ar->chunk) {
+        n = ar->chunk;
+    }
+    if ((ar->limit > 0) && (ar->taken + n > ar->limit)) {
+        n = AR_HEADSIZE + size;
+        if (ar->taken + n > ar->limit) {
+            errno = ENOMEM;
+            return -1;
+        }
+    }
+    if ((c = malloc(n)) == NULL) {
+        errno = ENOMEM;
+        return -1;
+    }
+    c->size = n;
+    c->next = ar->chunks;
+    ar->chunks = c;
+    ar->taken += n;
+    ar->bump = (char *)c + AR_HEADSIZE;
+    ar->end = (char *)c + n;
+    ar->last = NULL;
+    return 0;
+}
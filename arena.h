@@ -0,0 +1,63 @@
+/**
+ *  @file   arena.h
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Allocator interface and bump arena for the containers
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  An allocator is a table of alloc, resize and release functions plus
+ *  the context they get. Sizes are passed back on resize and release so
+ *  allocators need not record them. An arena hands out memory from
+ *  chunks of at least chunk bytes by bumping a pointer. Release only
+ *  gives back the latest allocation; everything else comes back at once
+ *  with ARreset or ARdispose. A non-zero limit caps the bytes an arena
+ *  takes from the heap, past which its allocations fail. Arenas are not
+ *  locked, so lists sharing one must not be used concurrently.
+ */
+#ifndef moustached_arena_h
+#define moustached_arena_h
+
+#include <stddef.h>
+
+#if !defined(MOUSTASHED_ALLOCATOR)
+#define MOUSTASHED_ALLOCATOR
+struct _Allocator {
+    void *(*alloc)(size_t, void*);
+    void *(*resize)(void*, size_t, size_t, void*);
+    void (*release)(void*, size_t, void*);
+    void *ctx;
+};
+typedef struct _Allocator allocator;
+#endif
+
+#define AR_ALIGN 16
+#define AR_MINCHUNK 4096
+
+
+allocator *ARnew(size_t, size_t);
+void ARreset(allocator *);
+void ARdispose(allocator *);
+
+#endif
@@ -31,11 +31,43 @@
  *  @URL    https://github.com/joaolpinho
  */
 
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#if !defined(_DEFAULT_SOURCE)
+#define _DEFAULT_SOURCE
+#endif
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
+#include <limits.h>
+#include <stdint.h>
 
 #include "arraylist.h"
+#include "controller.h"
+#include "threadpool.h"
+#include "snapshot.h"
+#include "epoch.h"
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(MOUSTASHED_NOSIMD)
+#define A_SIMD
+#include <immintrin.h>
+#endif
+
+#if defined(__linux__)
+#define A_MADVISE
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#define A_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #ifndef MOUSTASHED_ERROR_STRINGS
     #define MOUSTASHED_ERROR_STRINGS
@@ -44,278 +76,2910 @@
 #endif
 
 #define A_INITCAPACITY 30
+#define A_SORTCUTOFF 8192
+#define A_INSERTIONSORT 16
+#define A_PARCUTOFF 4096
+#define A_PARCHUNKS 8
+#define A_MINBLOCKSHIFT 4
+#define A_MAXBLOCKSHIFT 24
+#define A_RELEASEMIN (1 << 20)
+#define A_BLOCKHEAD 16
+#define BLOCKREFS(p) ((int *)((p) - A_BLOCKHEAD))
+#define BLOCKFILLED(p) ((int *)((p) - A_BLOCKHEAD) + 1)
+
+/*
+ * Builds without GNU atomics get plain accesses, as in controller.c, and
+ * so do not support concurrent or snapshotted lists across threads.
+ */
+#if defined(__GNUC__)
+#define A_LOAD(v) __atomic_load_n(&(v), __ATOMIC_ACQUIRE)
+#define A_PEEK(v) __atomic_load_n(&(v), __ATOMIC_RELAXED)
+#define A_STORE(v, x) __atomic_store_n(&(v), (x), __ATOMIC_RELEASE)
+#define A_EXCHANGE(v, x) __atomic_exchange_n(&(v), (x), __ATOMIC_ACQ_REL)
+#define A_CAS(v, old, x) __atomic_compare_exchange_n(&(v), (old), (x), 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)
+#define A_ADD(v, n) __atomic_add_fetch(&(v), (n), __ATOMIC_ACQ_REL)
+#define A_RESERVE(v, n) __atomic_fetch_add(&(v), (n), __ATOMIC_RELAXED)
+#else
+#define A_LOAD(v) (v)
+#define A_PEEK(v) (v)
+#define A_STORE(v, x) ((v) = (x))
+#define A_EXCHANGE(v, x) exchange((void **)&(v), (x))
+#define A_CAS(v, old, x) (((v) == *(old))?((v) = (x), 1):(*(old) = (v), 0))
+#define A_ADD(v, n) ((v) += (n))
+#define A_RESERVE(v, n) (((v) += (n)) - (n))
+#endif
+
+#if defined(MOUSTASHED_STATS)
+#define A_COUNT(a, counter, n) ((a)->stats.counter += (n))
+#define A_ALLOCATED(a, from, to) allocated((a), (from), (to))
+#else
+#define A_COUNT(a, counter, n) ((void)0)
+#define A_ALLOCATED(a, from, to) ((void)0)
+#endif
 
 /**
  * Struct and Type definitions
  *
  */
-struct _Controller {
+/*
+ * Elements live inline in buckets, elemsize bytes each. Plain lists store
+ * pointers; record lists store the records themselves and hand out the
+ * addresses of their slots. The first element sits head slots into the
+ * buffer, so both ends can grow and shrink without moving the rest.
+ *
+ * Segmented lists leave buckets NULL and keep their elements in blocks of
+ * 1 << shift slots listed in a directory. Blocks never move, and head
+ * stays 0.
+ *
+ * Segmented lists also publish immutable views of themselves for readers
+ * that take no lock. Their blocks carry a reference count A_BLOCKHEAD
+ * bytes in front of them, held by the list and by every view covering
+ * them, and once shared is set writers copy a block a view still holds
+ * before writing to it.
+ *
+ * Append-only lists are segmented lists whose appends take no lock.
+ * Appenders reserve slots by adding to reserved and, once they have
+ * written them, add their number to the filled count next to the
+ * reference count of their block. acquire moves used_buckets past every
+ * block whose reserved slots are all filled. The directory, nblocks and
+ * total_buckets only change under the lock, the directory being replaced
+ * rather than reallocated and the old one retired to the epoch
+ * collector.
+ *
+ * Lists growing incrementally move to a larger buffer step elements per
+ * operation. Until they are done, the elements in [moved, oldused) are
+ * still in old, oldhead slots in, and everything else is in buckets.
+ *
+ * Lists loaded with ALloadmapped keep their buckets in a private mapping
+ * of maplen bytes until the buffer first has to move.
+ *
+ * Lists created with ALnewwith take their memory from alloc and get
+ * ENOMEM back when it runs out, where the others exit. oldbytes is the
+ * size of old.
+ *
+ * Builds with MOUSTASHED_STATS count what the list does in stats. Mapped
+ * pages are not counted as allocated.
+ */
+struct _Array {
     int total_buckets;
     int used_buckets;
-    struct _Array *buckets;
+    int head;
+    unsigned int modcount;
+    size_t elemsize;
+    char record;
+    char *buckets;
+    
+    char **blocks;
+    int nblocks;
+    int maxblocks;
+    int shift;
+    struct _View *published;
+    char shared;
+    char appendonly;
+    int reserved;
+    
+    int step;
+    char *old;
+    int oldhead;
+    int oldused;
+    int moved;
+    size_t released;
+    
+    char *mapping;
+    size_t maplen;
+    
+    allocator alloc;
+    size_t oldbytes;
+    
+#if defined(MOUSTASHED_STATS)
+    stats stats;
+#endif
+    
+    char policy;
+    double factor;
+    int increment;
+    growpolicy grow;
+    void *growctx;
+    int kept;
 };
 
-struct _Array {
-    int total_buckets;
-    int used_buckets;
-    void **buckets;
+#define SLOT(a, i) ((a)->buckets + (size_t)((a)->head + (i))*(a)->elemsize)
+
+/*
+ * The list holds one reference to its published view and every
+ * ALsnapshot takes another. The last one out retires it to the epoch
+ * collector, as a reader may still be about to take a reference.
+ */
+struct _View {
+    int refs;
+    int used;
+    int shift;
+    size_t elemsize;
+    char record;
+    int nblocks;
+    char **blocks;
+};
+
+/*
+ * Sorting works on raw slots. Plain lists hand the comparator the stored
+ * pointers, record lists the slot addresses, exactly as ALget would.
+ */
+struct _Sorter {
+    size_t es;
+    char record;
+    comparator cmp;
+};
+
+struct _MergeSort {
+    struct _Sorter *s;
+    char *src;
+    char *dst;
+    int n;
+    char intodst;
+};
+
+struct _Merge {
+    struct _Sorter *s;
+    char *a;
+    int na;
+    char *b;
+    int nb;
+    char *out;
+};
+
+/*
+ * A range of a list being traversed in parallel. Elements reach the
+ * callbacks the way ALget returns them, from the view when there is one.
+ */
+struct _Traversal {
+    struct _Array *a;
+    struct _View *v;
+    int from;
+    int to;
+    int grain;
+    visitor visit;
+    mapper map;
+    reducer fold;
+    reducer combine;
+    void *ctx;
+    void **out;
+    void *acc;
+};
+
+/*
+ * Linear scans for a pointer. The best set of kernels the CPU supports is
+ * picked on first use.
+ */
+struct _Scanner {
+    int (*first)(void **, int, void *);
+    int (*last)(void **, int, void *);
+    int (*count)(void **, int, void *);
 };
 
 /**
  * Static-scope variables declaration
  *
  */
-static struct _Controller controller;
+static struct _Controller controller = CT_INITIALIZER(struct _Array);
+static const struct _Scanner *bestscanner = NULL;
 
 /**
  * Static-scope functions declaration
  *
  */
-static void check(struct _Array *);
-static int getfreearray();
+static int newarray(int, size_t, char, int, const allocator *);
+static void *elemat(struct _Array *, int);
+static char *slotat(struct _Array *, int);
+static int runat(struct _Array *, int, char **);
+static int runbefore(struct _Array *, int, char **);
+static void moverange(struct _Array *, int, int, int);
+static void copyrange(struct _Array *, int, char *, int, char);
+static int addblocks(struct _Array *, int);
+static void trimblocks(struct _Array *);
+static char *newblock(struct _Array *);
+static void dropblock(char *);
+static int own(struct _Array *, int, int);
+static char *append(struct _Array *, int, char *, int);
+static int reach(struct _Array *, int, int);
+static int extend(struct _Array *, int);
+static void commit(struct _Array *);
+static struct _View *pin(struct _Array *);
+static int publish(struct _Array *);
+static void freeview(void *);
+static int grown(struct _Array *, double);
+static double maxcapacity(struct _Array *);
+static int toolarge(void);
+static int check(struct _Array *, int);
+static int checkfront(struct _Array *, int);
+static int resize(struct _Array *, int, int);
+static void migrate(struct _Array *, int);
+static int unmap(struct _Array *);
+static void *allocate(struct _Array *, size_t);
+static void *reallocate(struct _Array *, void *, size_t, size_t);
+static void release(struct _Array *, void *, size_t);
+static int nomem(struct _Array *);
+static int readheader(FILE *, size_t *, size_t *);
+static struct _Array *acquire(int);
+static int insertrange(struct _Array *, int, void **, int);
+static int removerange(struct _Array *, int, int);
 static void *ALitnext(iterator *);
 static void *ALitprev(iterator *);
 static void ALupdateit(iterator *);
 static void ALresetit(iterator *);
+static void updateit(iterator *, struct _Array *);
+static struct _Array *acquireit(iterator *);
+static int lowerbound(struct _Array *, void *, comparator);
+static int compare(struct _Sorter *, const char *, const char *);
+static void copyelem(struct _Sorter *, char *, const char *);
+static void swapelems(struct _Sorter *, char *, char *);
+static void msort(void *);
+static void pmerge(void *);
+static void merge(struct _Sorter *, char *, int, char *, int, char *);
+static void introsort(struct _Sorter *, char *, int, int);
+static int partition(struct _Sorter *, char *, int);
+static void heapsort(struct _Sorter *, char *, int);
+static void siftdown(struct _Sorter *, char *, int, int);
+static void insertionsort(struct _Sorter *, char *, int);
+static const struct _Scanner *scanner(void);
+static int firstscalar(void **, int, void *);
+static int lastscalar(void **, int, void *);
+static int countscalar(void **, int, void *);
+#if defined(A_SIMD)
+static int firstsse2(void **, int, void *);
+static int lastsse2(void **, int, void *);
+static int countsse2(void **, int, void *);
+static __m128i eq64sse2(void **, __m128i);
+static int firstavx2(void **, int, void *);
+static int lastavx2(void **, int, void *);
+static int countavx2(void **, int, void *);
+#endif
+static int search(struct _Array *, void *, size_t, size_t, char);
+static int keyscan(char *, int, size_t, void *, size_t, size_t, char);
+static void traverse(struct _Traversal *);
+static void traversetask(void *);
+static int starttraversal(struct _Traversal *, struct _Array *);
+static void endtraversal(struct _Traversal *);
+static void *traversed(struct _Traversal *, int);
+static int sortbuffer(struct _Array *, struct _Sorter *, char *, int);
+static void dumpstats(int, void *, void *);
+#if defined(MOUSTASHED_STATS)
+static void allocated(struct _Array *, size_t, size_t);
+#endif
+#if !defined(__GNUC__)
+static void *exchange(void **, void *);
+#endif
 
 /**
  * Functions definition
  *
  */
 int ALnew(int init_size) {
-    int handler = -1;
-    struct _Array *tmp = NULL;
-    struct _Array *array = NULL;
+    return newarray(init_size, sizeof(void *), 0, 0, NULL);
+}
+
+int ALnewsized(int init_size, size_t elem_size) {
+    if (elem_size == 0) {
+        errno = EINVAL;
+        return -1;
+    }
+    return newarray(init_size, elem_size, 1, 0, NULL);
+}
+
+/*
+ * A list that grows by whole blocks of block slots, rounded up to a power
+ * of two, and never moves its elements. An elem_size of 0 makes a plain
+ * list. ALtoarray does not apply to these lists, and they have no front
+ * gap, so front operations shift the whole list.
+ */
+int ALnewsegmented(int block, size_t elem_size) {
+    int shift = A_MINBLOCKSHIFT;
     
-    if (controller.buckets == NULL) {
-        controller.buckets = malloc((A_INITCAPACITY)*(sizeof(void **)));
-        if (controller.buckets == NULL) {
-            perror(S_NOMEM);
-            exit(EXIT_FAILURE);
-        }
-        controller.total_buckets = A_INITCAPACITY;
+    if (block > (1 << A_MAXBLOCKSHIFT)) {
+        errno = EINVAL;
+        return -1;
     }
-    if (controller.used_buckets > controller.total_buckets*A_LOADFACT) {
-        tmp = realloc(controller.buckets, sizeof(struct _Array) * controller.used_buckets*A_EXPRATE);
-        if (tmp == NULL) {
-            perror(S_NOMEM); 
-            exit(EXIT_FAILURE);
-        }
-        controller.buckets = tmp;
-        controller.total_buckets *= A_EXPRATE;
+    while ((1 << shift) < block) {
+        shift++;
     }
-    handler = getfreearray();
-    array = &controller.buckets[handler];
-    array->buckets = malloc(sizeof(void **)*init_size);
-    if (array->buckets == NULL) {
-        perror(S_NOMEM);
-        exit(EXIT_FAILURE);
+    if (elem_size == 0) {
+        return newarray(0, sizeof(void *), 0, shift, NULL);
+    }
+    return newarray(0, elem_size, 1, shift, NULL);
+}
+
+/*
+ * A segmented list any number of threads can append to at once. ALadd,
+ * ALaddall and ALpushback reserve their slots with an atomic add and
+ * only take the lock when the list runs out of blocks. Every other call
+ * sees the elements whose appends have completed, in the order their
+ * slots were reserved. Nothing else may change the list: inserting,
+ * removing, setting and sorting fail with EINVAL. Dispose it only once
+ * every producer is done.
+ */
+int ALnewconcurrent(int block, size_t elem_size) {
+    struct _Array *a;
+    int handler = ALnewsegmented(block, elem_size);
+    
+    if ((handler >= 0) && ((a = CTacquire(&controller, handler)) != NULL)) {
+        a->appendonly = 1;
+        CTrelease(a);
     }
-    controller.used_buckets++;
-    array->total_buckets = init_size;
-    array->used_buckets = 0;
     return handler;
 }
 
+/*
+ * A list whose memory all comes from alloc, an elem_size of 0 making a
+ * plain list. Running out of memory fails the operation with ENOMEM and
+ * leaves the list as it was. Sort scratch space comes from alloc too.
+ */
+int ALnewwith(int init_size, size_t elem_size, const allocator *alloc) {
+    if ((alloc == NULL) || (alloc->alloc == NULL) || (alloc->resize == NULL)
+        || (alloc->release == NULL)) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (elem_size == 0) {
+        return newarray(init_size, sizeof(void *), 0, 0, alloc);
+    }
+    return newarray(init_size, elem_size, 1, 0, alloc);
+}
+
 void ALpurge(int handler) {
-    if (handler <= controller.used_buckets) {
-        free(controller.buckets[handler].buckets);
-        controller.buckets[handler].buckets = malloc(sizeof(void **)*A_INITCAPACITY);
-        if (controller.buckets[handler].buckets == NULL) {
-            perror(S_NOMEM); 
-            exit(EXIT_FAILURE);
-        }
-        controller.buckets[handler].total_buckets = A_INITCAPACITY;
-        controller.buckets[handler].used_buckets = 0;
-    } else {
-        errno = EFAULT;
-        perror(S_EFAULT);
+    struct _Array *a;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if (a->appendonly) {
+            errno = EINVAL;
+            CTrelease(a);
+            return;
+        }
+        a->used_buckets = 0;
+        a->modcount++;
+        a->head = 0;
+        if (a->old != NULL) {
+            A_ALLOCATED(a, a->oldbytes, 0);
+            release(a, a->old, a->oldbytes);
+            a->old = NULL;
+        }
+        CTrelease(a);
     }
 }
 
+/*
+ * Segmented lists also collect what they left to the epoch collector,
+ * their views and the directories an append-only list outgrew.
+ */
 void ALdispose(int handler) {
-    if (handler <= controller.used_buckets) {
-        controller.buckets[handler].total_buckets = 0;
-        controller.buckets[handler].used_buckets = 0;
-        if (controller.buckets[handler].buckets != NULL) {
-            free(controller.buckets[handler].buckets);
+    struct _Array *a;
+    char segmented = 0;
+    
+    if ((a = acquire(handler)) != NULL) {
+        a->used_buckets = 0;
+        if (a->mapping != NULL) {
+#if defined(A_MMAP)
+            munmap(a->mapping, a->maplen);
+#endif
+            a->mapping = NULL;
+            a->buckets = NULL;
+        }
+        if (a->buckets != NULL) {
+            release(a, a->buckets, a->elemsize*a->total_buckets);
+            a->buckets = NULL;
+        }
+        if (a->old != NULL) {
+            release(a, a->old, a->oldbytes);
+            a->old = NULL;
+        }
+        if (a->published != NULL) {
+            ALviewrelease(A_EXCHANGE(a->published, NULL));
+        }
+        if (a->blocks != NULL) {
+            while (a->nblocks > 0) {
+                dropblock(a->blocks[--a->nblocks]);
+            }
+            release(a, a->blocks, sizeof(char *)*a->maxblocks);
+            a->blocks = NULL;
+            segmented = 1;
+        }
+        a->total_buckets = 0;
+        CTdispose(&controller, a);
+        if (segmented) {
+            EPcollect();
         }
-        controller.used_buckets--;
-    } else {
-        errno = EFAULT;
-        perror(S_EFAULT);
     }
     return;
 }
 
-void *ALadd(int handler, void *elem) {
+int ALgrowbyfactor(int handler, double factor) {
     struct _Array *a;
+    int ret = -1;
     
-    if (handler <= controller.used_buckets) {
-        a = &controller.buckets[handler];
-        a->buckets[a->used_buckets] = elem;
-        a->used_buckets++;
-        check(a);
-    } else {
-        errno = EFAULT;
-        perror(S_EFAULT);
-    } 
+    if ((a = acquire(handler)) != NULL) {
+        if (factor > 1.0) {
+            a->policy = A_GROWFACTOR;
+            a->factor = factor;
+            ret = 0;
+        } else {
+            errno = EINVAL;
+        }
+        CTrelease(a);
+    }
+    return ret;
+}
+
+int ALgrowbyamount(int handler, int increment) {
+    struct _Array *a;
+    int ret = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if (increment > 0) {
+            a->policy = A_GROWADD;
+            a->increment = increment;
+            ret = 0;
+        } else {
+            errno = EINVAL;
+        }
+        CTrelease(a);
+    }
+    return ret;
+}
+
+int ALgrowwith(int handler, growpolicy grow, void *ctx) {
+    struct _Array *a;
+    int ret = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if (grow != NULL) {
+            a->policy = A_GROWCALLBACK;
+            a->grow = grow;
+            a->growctx = ctx;
+            ret = 0;
+        } else {
+            errno = EINVAL;
+        }
+        CTrelease(a);
+    }
+    return ret;
+}
+
+/*
+ * Growing a list incrementally allocates the larger buffer and leaves the
+ * elements where they are; every later operation on the list then moves
+ * up to step of them, so no single append pays for the whole copy. The
+ * default policy needs a step of at least 3 to finish before the next
+ * growth, which otherwise completes the move at once. A step of 0 goes
+ * back to growing in one go.
+ */
+int ALgrowincrementally(int handler, int step) {
+    struct _Array *a;
+    int ret = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if (step >= 0) {
+            if (step == 0) {
+                migrate(a, a->used_buckets);
+            }
+            a->step = step;
+            ret = 0;
+        } else {
+            errno = EINVAL;
+        }
+        CTrelease(a);
+    }
+    return ret;
+}
+
+/*
+ * The default policy leaves a reserved capacity alone until it is full,
+ * rather than growing once the list reaches A_LOADFACT of it.
+ */
+int ALreserve(int handler, int capacity) {
+    struct _Array *a;
+    int total = -1;
+    int status = 0;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if (a->appendonly) {
+            status = extend(a, capacity);
+        } else if (a->blocks != NULL) {
+            status = addblocks(a, capacity);
+        } else if (capacity > a->total_buckets) {
+            status = resize(a, capacity, 0);
+        }
+        if (status == 0) {
+            a->kept = capacity;
+            total = a->total_buckets;
+        }
+        CTrelease(a);
+    }
+    return total;
+}
+
+int ALshrinktofit(int handler) {
+    struct _Array *a;
+    int total = -1;
+    int status = 0;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if (a->appendonly) {
+            errno = EINVAL;
+            status = -1;
+        } else if (a->blocks != NULL) {
+            trimblocks(a);
+        } else if (a->total_buckets > a->used_buckets) {
+            status = resize(a, (a->used_buckets > 0)?a->used_buckets:1, 0);
+        }
+        if (status == 0) {
+            a->kept = 0;
+            total = a->total_buckets;
+        }
+        CTrelease(a);
+    }
+    return total;
+}
+
+int ALcapacity(int handler) {
+    struct _Array *a;
+    int total = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        total = a->total_buckets;
+        CTrelease(a);
+    }
+    return total;
+}
+
+/*
+ * Record lists copy the record elem points to and return its slot.
+ */
+void *ALadd(int handler, void *elem) {
+    struct _Array *a = CTpeek(&controller, handler);
+    char *slot = NULL;
+    
+    if ((a != NULL) && a->appendonly) {
+        slot = append(a, handler, a->record?elem:(char *)&elem, 1);
+        return (a->record || (slot == NULL))?(void *)slot:elem;
+    }
+    if ((a = acquire(handler)) != NULL) {
+        if (insertrange(a, a->used_buckets, a->record?elem:&elem, 1) > 0) {
+            elem = elemat(a, a->used_buckets - 1);
+        } else {
+            elem = NULL;
+        }
+        CTrelease(a);
+    }
     return elem;
 }
 
+/*
+ * src holds n pointers, or n contiguous records for record lists.
+ */
+int ALaddall(int handler, void **src, int n) {
+    struct _Array *a = CTpeek(&controller, handler);
+    int added = -1;
+    
+    if ((a != NULL) && a->appendonly) {
+        if (n < 0) {
+            errno = EINVAL;
+            return -1;
+        }
+        return ((n > 0) && (append(a, handler, (char *)src, n) == NULL))?-1:n;
+    }
+    if ((a = acquire(handler)) != NULL) {
+        added = insertrange(a, a->used_buckets, src, n);
+        CTrelease(a);
+    }
+    return added;
+}
+
 void *ALget(int handler, int i) {
+    struct _Array *a;
     void *elem = NULL;
-    if (handler <= controller.used_buckets) {
-        if (controller.buckets[handler].total_buckets >= i)
-            elem = controller.buckets[handler].buckets[i];
-    } else {
-        errno = EFAULT;
-        perror(S_EFAULT);
+    
+    if ((a = acquire(handler)) != NULL) {
+        if ((i >= 0) && (i < a->used_buckets))
+            elem = elemat(a, i);
+        CTrelease(a);
     }
     return elem;
 }
 
+/*
+ * An index out of range is reported but, as before, elem is handed back;
+ * any other failure returns NULL.
+ */
 void *ALset(int handler, int i, void *elem) {
     struct _Array *a;
-    void *holder = NULL, *next = NULL;
-    int j = 0;
-    if ((handler <= controller.used_buckets) && (i <= controller.buckets[handler].used_buckets)) {
-        a = &controller.buckets[handler];
-        next = a->buckets[i];
-        a->buckets[i] = elem;
-        j = i+1;
-        while (j <= a->total_buckets) {
-            holder = a->buckets[j];
-            a->buckets[j] = next;
-            next = holder;
-            j++;
-        }
-        a->used_buckets++;
-        check(a);
-    } else {
-        errno = EFAULT;
-        perror(S_EFAULT);
+    
+    if ((a = acquire(handler)) != NULL) {
+        if ((i < 0) || (i > a->used_buckets)) {
+            errno = EFAULT;
+            perror(S_EFAULT);
+        } else if (insertrange(a, i, a->record?elem:&elem, 1) > 0) {
+            elem = elemat(a, i);
+        } else {
+            elem = NULL;
+        }
+        CTrelease(a);
+    }
+    return elem;
+}
+
+int ALinsertrange(int handler, int i, void **src, int n) {
+    struct _Array *a;
+    int inserted = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        inserted = insertrange(a, i, src, n);
+        CTrelease(a);
+    }
+    return inserted;
+}
+
+/*
+ * Deque operations, all amortised O(1). Pushes return what ALadd would,
+ * pops what ALremove would.
+ */
+void *ALpushfront(int handler, void *elem) {
+    struct _Array *a;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if ((checkfront(a, 1) == 0)
+            && (insertrange(a, 0, a->record?elem:&elem, 1) > 0)) {
+            elem = elemat(a, 0);
+        } else {
+            elem = NULL;
+        }
+        CTrelease(a);
+    }
+    return elem;
+}
+
+void *ALpushback(int handler, void *elem) {
+    return ALadd(handler, elem);
+}
+
+void *ALpopfront(int handler) {
+    struct _Array *a;
+    void *elem = NULL;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if (a->used_buckets > 0) {
+            if (!a->record) {
+                elem = elemat(a, 0);
+            }
+            if (removerange(a, 0, 1) < 0) {
+                elem = NULL;
+            }
+        }
+        CTrelease(a);
+    }
+    return elem;
+}
+
+void *ALpopback(int handler) {
+    struct _Array *a;
+    void *elem = NULL;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if (a->used_buckets > 0) {
+            if (!a->record) {
+                elem = elemat(a, a->used_buckets - 1);
+            }
+            if (removerange(a, a->used_buckets - 1, a->used_buckets) < 0) {
+                elem = NULL;
+            }
+        }
+        CTrelease(a);
     }
     return elem;
 }
 
+/*
+ * The removed record of a record list is gone once this returns, so
+ * they get NULL back.
+ */
 void *ALremove(int handler, int i) {
     struct _Array *a;
-    void *prev = NULL, *elem = NULL;
-    int j = 0;
-    if ((handler <= controller.used_buckets) && (i <= controller.buckets[handler].total_buckets)) {
-        a = &controller.buckets[handler];
-        elem = prev = a->buckets[i];
-        j = i+1;
-        while (j <= a->total_buckets) {
-            a->buckets[j-1] = a->buckets[j];
-            j++;
-        }
-        a->used_buckets--;
-    } else {
-        errno = EFAULT;
-        perror(S_EFAULT);
+    void *elem = NULL;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if ((i >= 0) && (i < a->used_buckets) && !a->record) {
+            elem = elemat(a, i);
+        }
+        if (removerange(a, i, i+1) < 0) {
+            elem = NULL;
+        }
+        CTrelease(a);
     }
     return elem;
 }
 
+int ALremoverange(int handler, int from, int to) {
+    struct _Array *a;
+    int removed = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        removed = removerange(a, from, to);
+        CTrelease(a);
+    }
+    return removed;
+}
+
 int ALsize(int handler) {
+    struct _Array *a;
     int size = -1;
-    if (handler <= controller.used_buckets) {
-        size = controller.buckets[handler].used_buckets;
-    } else {
-        errno = EFAULT;
-        perror(S_EFAULT);
+    
+    if ((a = acquire(handler)) != NULL) {
+        size = a->used_buckets;
+        CTrelease(a);
     }
     return size;
 }
 
+/*
+ * Segmented lists have no single buffer to hand out and fail with
+ * EINVAL.
+ */
 void** ALtoarray(int handler) {
+    struct _Array *a;
     void **array = NULL;
-    if (handler <= controller.used_buckets) {
-        array =  controller.buckets[handler].buckets;
-    } else {
-        errno = EFAULT;
-        perror(S_EFAULT);
+    
+    if ((a = acquire(handler)) != NULL) {
+        if (a->blocks != NULL) {
+            errno = EINVAL;
+        } else {
+            migrate(a, a->used_buckets);
+            array = (void **)SLOT(a, 0);
+        }
+        CTrelease(a);
     }
     return array;
 }
 
-iterator ALiterator(int handler) {
-    iterator it;
-    if (handler <= controller.used_buckets) {
-        it.handler = handler;
-        it.carriage = 0;
-        it.next = ALitnext;
-        it.prev = ALitprev;
-        it.update = ALupdateit;
-        it.reset = ALresetit;
-        it.update(&it);
-    } else {
-        errno = EFAULT;
-        perror(S_EFAULT);
+/*
+ * Parallel merge sort over the thread pool. Ranges below A_SORTCUTOFF
+ * are left to an introsort on the calling thread. Segmented lists are
+ * gathered into one buffer, sorted there and scattered back. Scratch
+ * space comes from the list's allocator; when it runs out the list is
+ * left unsorted with errno set to ENOMEM.
+ */
+void ALsort(int handler, comparator cmp) {
+    struct _Array *a;
+    struct _Sorter s;
+    char *tmp = NULL;
+    
+    if ((a = acquire(handler)) != NULL) {
+        s.es = a->elemsize;
+        s.record = a->record;
+        s.cmp = cmp;
+        if (a->appendonly) {
+            errno = EINVAL;
+        } else if (a->blocks == NULL) {
+            migrate(a, a->used_buckets);
+            sortbuffer(a, &s, SLOT(a, 0), a->used_buckets);
+        } else if (a->used_buckets > 0) {
+            if ((tmp = allocate(a, a->elemsize*a->used_buckets)) == NULL) {
+                nomem(a);
+            } else {
+                copyrange(a, 0, tmp, a->used_buckets, 1);
+                if (sortbuffer(a, &s, tmp, a->used_buckets) == 0) {
+                    own(a, 0, a->used_buckets);
+                    copyrange(a, 0, tmp, a->used_buckets, 0);
+                }
+                release(a, tmp, a->elemsize*a->used_buckets);
+            }
+        }
+        CTrelease(a);
     }
-    return it;
 }
 
-
-/**
- * Static-scope functions definition
- *
+/*
+ * Index of key in a list sorted by cmp, or -1. cmp gets an element first
+ * and the key second.
  */
-static void check(struct _Array *a) {
-    void **tmp = NULL;
+int ALbsearch(int handler, void *key, comparator cmp) {
+    struct _Array *a;
+    int i = -1;
     
-    if (a->used_buckets > a->total_buckets*A_LOADFACT) {
-        tmp = realloc(a->buckets, sizeof(void**) * a->used_buckets*A_EXPRATE);
-        if (tmp == NULL) {
-            errno = ENOMEM;
-            perror(S_NOMEM); 
-            exit(EXIT_FAILURE);
+    if ((a = acquire(handler)) != NULL) {
+        i = lowerbound(a, key, cmp);
+        if ((i == a->used_buckets) || (cmp(elemat(a, i), key) != 0)) {
+            i = -1;
         }
-        a->buckets = tmp;
-        a->total_buckets *= A_EXPRATE;
+        CTrelease(a);
     }
-    
+    return i;
 }
 
-static int getfreearray() {
-    int handler = 0;
-    while ((handler < controller.used_buckets) 
-           && (controller.buckets[handler].buckets != NULL))
-            handler++;
+/*
+ * Index of the first element not lower than key.
+ */
+int ALlowerbound(int handler, void *key, comparator cmp) {
+    struct _Array *a;
+    int i = -1;
     
-    return handler;
-}
-
-static void *ALitnext(iterator *it) {
-    void *elem = NULL;
-    if (it->hasnext) {
-        elem = controller.buckets[it->handler].buckets[it->carriage];
-        it->carriage++;
-        it->update(it);
+    if ((a = acquire(handler)) != NULL) {
+        i = lowerbound(a, key, cmp);
+        CTrelease(a);
     }
-    return elem;
+    return i;
+}
+
+/*
+ * Index of the first element equal to elem, or -1. Plain lists compare
+ * the pointers, record lists whole records against the one elem points
+ * to.
+ */
+int ALindexof(int handler, void *elem) {
+    struct _Array *a;
+    int i = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        i = search(a, elem, 0, a->elemsize, 0);
+        CTrelease(a);
+    }
+    return i;
+}
+
+int ALlastindexof(int handler, void *elem) {
+    struct _Array *a;
+    int i = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        i = search(a, elem, 0, a->elemsize, 1);
+        CTrelease(a);
+    }
+    return i;
+}
+
+int ALcontains(int handler, void *elem) {
+    return ALindexof(handler, elem) >= 0;
+}
+
+int ALcount(int handler, void *elem) {
+    struct _Array *a;
+    int n = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        n = search(a, elem, 0, a->elemsize, 2);
+        CTrelease(a);
+    }
+    return n;
+}
+
+/*
+ * Index of the first record whose width bytes at offset equal key, or
+ * -1. Fails with EINVAL on plain lists or a key outside the record.
+ */
+int ALindexofkey(int handler, void *key, size_t offset, size_t width) {
+    struct _Array *a;
+    int i = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if (!a->record || (width == 0) || (offset + width > a->elemsize)) {
+            errno = EINVAL;
+        } else {
+            i = search(a, key, offset, width, 0);
+        }
+        CTrelease(a);
+    }
+    return i;
+}
+
+int ALcountkey(int handler, void *key, size_t offset, size_t width) {
+    struct _Array *a;
+    int n = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        if (!a->record || (width == 0) || (offset + width > a->elemsize)) {
+            errno = EINVAL;
+        } else {
+            n = search(a, key, offset, width, 2);
+        }
+        CTrelease(a);
+    }
+    return n;
+}
+
+/*
+ * Calls visit(elem, ctx) on every element. Lists longer than A_PARCUTOFF
+ * are split over the thread pool, so visit must be safe to run
+ * concurrently on different elements. Segmented lists are visited as
+ * they were on the call and may be used by visit; any other list stays
+ * locked throughout, and visit must not use it nor wait on a thread that
+ * does.
+ */
+void ALforeach(int handler, visitor visit, void *ctx) {
+    struct _Array *a;
+    struct _Traversal t;
+    
+    if (((a = acquire(handler)) != NULL) && (starttraversal(&t, a) == 0)) {
+        t.visit = visit;
+        t.ctx = ctx;
+        traverse(&t);
+        endtraversal(&t);
+    }
+}
+
+/*
+ * Returns a new plain list holding map(elem, ctx) for every element, in
+ * order, or -1 on an invalid handler. map is called as visit is by
+ * ALforeach. Nobody knows the new handle yet, so it is filled in
+ * unlocked.
+ */
+int ALmap(int handler, mapper map, void *ctx) {
+    struct _Array *a, *b;
+    struct _Traversal t;
+    int mapped = -1;
+    
+    if (((a = acquire(handler)) != NULL) && (starttraversal(&t, a) == 0)) {
+        mapped = newarray(t.to, sizeof(void *), 0, 0,
+                          ((t.a != NULL) && (t.a->alloc.alloc != NULL))?&t.a->alloc:NULL);
+        if (mapped >= 0) {
+            b = CTacquire(&controller, mapped);
+            b->used_buckets = t.to;
+            t.out = (void **)SLOT(b, 0);
+            CTrelease(b);
+            t.map = map;
+            t.ctx = ctx;
+            traverse(&t);
+        }
+        endtraversal(&t);
+    }
+    return mapped;
+}
+
+/*
+ * Folds the list with acc = fold(acc, elem, ctx). Parallel runs fold
+ * every chunk from init and join neighbouring results, left first, with
+ * combine(left, right, ctx), so init must be an identity for it and
+ * combine associative. A NULL combine means fold serves for both. Both
+ * are called as visit is by ALforeach.
+ */
+void *ALreduce(int handler, reducer fold, reducer combine, void *init, void *ctx) {
+    struct _Array *a;
+    struct _Traversal t;
+    
+    if (((a = acquire(handler)) != NULL) && (starttraversal(&t, a) == 0)) {
+        t.fold = fold;
+        t.combine = (combine != NULL)?combine:fold;
+        t.ctx = ctx;
+        t.acc = init;
+        traverse(&t);
+        init = t.acc;
+        endtraversal(&t);
+    }
+    return init;
+}
+
+/*
+ * Writes the list to path. Record lists without a serializer are written
+ * raw and can be loaded back with ALloadmapped; otherwise every element
+ * goes through save as ALget would return it. Plain lists need a
+ * serializer. Returns 0, or -1 with errno set.
+ */
+int ALsave(int handler, const char *path, serializer save, void *ctx) {
+    struct _Array *a;
+    FILE *f = NULL;
+    char *run = NULL;
+    int status = -1;
+    int i = 0;
+    int n = 0;
+    
+    if ((a = acquire(handler)) == NULL) {
+        return -1;
+    }
+    if ((save == NULL) && !a->record) {
+        errno = EINVAL;
+    } else if ((f = fopen(path, "wb")) != NULL) {
+        migrate(a, a->used_buckets);
+        status = SNwriteheader(f, (save == NULL)?SN_RECORDS:SN_SERIALIZED,
+                               a->record?a->elemsize:0, a->used_buckets);
+        for (i = 0; (status == 0) && (i < a->used_buckets); i += n) {
+            if (save == NULL) {
+                n = runat(a, i, &run);
+                if (n > a->used_buckets - i) {
+                    n = a->used_buckets - i;
+                }
+                if (fwrite(run, a->elemsize, n, f) != (size_t)n) {
+                    status = -1;
+                }
+            } else {
+                n = 1;
+                if (save(elemat(a, i), f, ctx) != 0) {
+                    status = -1;
+                }
+            }
+        }
+        if ((fclose(f) != 0) && (status == 0)) {
+            status = -1;
+        }
+    }
+    CTrelease(a);
+    return status;
+}
+
+/*
+ * Reads a list written by ALsave or LLsave. Raw records load into a
+ * record list, serialized elements go through load into a plain list
+ * grown as they come, so a bad count cannot claim memory up front.
+ * When load fails, the elements it already produced are passed to
+ * release, if given, before the list is disposed.
+ * Returns the new handle, or -1 with errno set.
+ */
+int ALload(const char *path, deserializer load, visitor release, void *ctx) {
+    struct _Array *a = NULL;
+    FILE *f = NULL;
+    size_t es = 0;
+    size_t count = 0;
+    int handler = -1;
+    int kind = 0;
+    int i = 0;
+    
+    if ((f = fopen(path, "rb")) == NULL) {
+        return -1;
+    }
+    kind = readheader(f, &es, &count);
+    if (kind == SN_RECORDS) {
+        handler = newarray((int)count, es, 1, 0, NULL);
+    } else if ((kind == SN_SERIALIZED) && (load != NULL)) {
+        handler = newarray(0, sizeof(void *), 0, 0, NULL);
+    }
+    if (((kind == SN_RECORDS) || ((kind == SN_SERIALIZED) && (load != NULL)))
+        && ((handler < 0) || ((a = acquire(handler)) == NULL))) {
+        fclose(f);
+        return -1;
+    }
+    if (kind == SN_RECORDS) {
+        if (fread(a->buckets, es, count, f) == count) {
+            a->used_buckets = (int)count;
+            kind = 0;
+        } else if (!ferror(f)) {
+            errno = EINVAL;
+        }
+        CTrelease(a);
+    } else if ((kind == SN_SERIALIZED) && (load != NULL)) {
+        while (a->used_buckets < (int)count) {
+            if ((check(a, 1) != 0)
+                || (load(f, (void **)SLOT(a, a->used_buckets), ctx) != 0)) {
+                break;
+            }
+            a->used_buckets++;
+        }
+        if (a->used_buckets == (int)count) {
+            kind = 0;
+        } else if (release != NULL) {
+            for (i = 0; i < a->used_buckets; i++) {
+                release(*(void **)SLOT(a, i), ctx);
+            }
+        }
+        CTrelease(a);
+    } else if (kind == SN_SERIALIZED) {
+        errno = EINVAL;
+    }
+    fclose(f);
+    if ((kind != 0) && (handler >= 0)) {
+        ALdispose(handler);
+        handler = -1;
+    }
+    return handler;
+}
+
+/*
+ * Maps a raw record snapshot copy-on-write instead of reading it, so
+ * loading costs nothing up front and pages come in as they are touched.
+ * The list stays mapped until its buffer first has to be reallocated,
+ * and changes never reach the file. Builds without mmap read the file
+ * instead.
+ */
+int ALloadmapped(const char *path) {
+#if defined(A_MMAP)
+    struct _Array *a = NULL;
+    FILE *f = NULL;
+    char *map = NULL;
+    size_t es = 0;
+    size_t count = 0;
+    size_t len = 0;
+    int handler = -1;
+    int kind = 0;
+    
+    if ((f = fopen(path, "rb")) == NULL) {
+        return -1;
+    }
+    kind = readheader(f, &es, &count);
+    if (kind == SN_RECORDS) {
+        len = SN_HEADERSIZE + es*count;
+        map = mmap(NULL, len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(f), 0);
+        if (map != MAP_FAILED) {
+            if ((handler = CTclaim(&controller, (void **)&a)) < 0) {
+                munmap(map, len);
+            } else {
+                a->elemsize = es;
+                a->record = 1;
+                a->mapping = map;
+                a->maplen = len;
+                a->buckets = map + SN_HEADERSIZE;
+                a->total_buckets = (int)count;
+                a->used_buckets = (int)count;
+                CTrelease(a);
+            }
+        }
+    } else if (kind == SN_SERIALIZED) {
+        errno = EINVAL;
+    }
+    fclose(f);
+    return handler;
+#else
+    return ALload(path, NULL, NULL, NULL);
+#endif
+}
+
+/*
+ * Copies the counters of the list into st. Fails with ENOTSUP unless the
+ * library was built with MOUSTASHED_STATS.
+ */
+int ALstats(int handler, stats *st) {
+    struct _Array *a;
+    
+    if ((a = acquire(handler)) == NULL) {
+        return -1;
+    }
+#if defined(MOUSTASHED_STATS)
+    *st = a->stats;
+    CTrelease(a);
+    return 0;
+#else
+    memset(st, 0, sizeof(*st));
+    CTrelease(a);
+    errno = ENOTSUP;
+    return -1;
+#endif
+}
+
+/*
+ * Writes one line per live list to f.
+ */
+void ALdumpstats(FILE *f) {
+    CTforeach(&controller, dumpstats, f);
+}
+
+iterator ALiterator(int handler) {
+    struct _Array *a;
+    iterator it;
+    
+    if ((a = acquire(handler)) != NULL) {
+        it.handler = handler;
+        it.carriage = 0;
+        it.modcount = a->modcount;
+        it.cursor = NULL;
+        it.last = NULL;
+        it.offset = 0;
+        it.next = ALitnext;
+        it.prev = ALitprev;
+        it.remove = NULL;
+        it.insert = NULL;
+        it.update = ALupdateit;
+        it.reset = ALresetit;
+        updateit(&it, a);
+        CTrelease(a);
+    }
+    return it;
+}
+
+/*
+ * Writes up to n elements from the iterator's position to out, as next
+ * would return them one by one, and moves past them. Returns how many
+ * were written, 0 at the end, or -1 if the iterator is no longer valid.
+ */
+int ALnextbatch(iterator *it, void **out, int n) {
+    struct _Array *a;
+    int count = -1;
+    int k = 0;
+    
+    if ((a = acquireit(it)) != NULL) {
+        count = a->used_buckets - it->carriage;
+        if (count > n) {
+            count = n;
+        }
+        if (count < 0) {
+            count = 0;
+        }
+        if (a->record) {
+            for (k = 0; k < count; k++) {
+                out[k] = slotat(a, it->carriage + k);
+            }
+        } else {
+            migrate(a, a->used_buckets);
+            copyrange(a, it->carriage, (char *)out, count, 1);
+        }
+        it->carriage += count;
+        A_COUNT(a, steps, count);
+        updateit(it, a);
+        CTrelease(a);
+    }
+    return count;
+}
+
+/*
+ * Zero-copy ALnextbatch. Returns the slots from the iterator's position
+ * to the end of their contiguous run, stored pointers for plain lists
+ * and records for record lists, sets *len to their number and moves past
+ * them. The span points into the list and stays valid only until the
+ * list is next modified. Returns NULL with *len 0 at the end or if the
+ * iterator is no longer valid.
+ */
+void *ALnextspan(iterator *it, int *len) {
+    struct _Array *a;
+    char *span = NULL;
+    
+    *len = 0;
+    if ((a = acquireit(it)) != NULL) {
+        if (it->carriage < a->used_buckets) {
+            migrate(a, a->used_buckets);
+            *len = runat(a, it->carriage, &span);
+            if (*len > a->used_buckets - it->carriage) {
+                *len = a->used_buckets - it->carriage;
+            }
+            it->carriage += *len;
+            A_COUNT(a, steps, *len);
+        }
+        updateit(it, a);
+        CTrelease(a);
+    }
+    return span;
+}
+
+/*
+ * Makes the current contents of a segmented list what ALsnapshot hands
+ * out, until the next call. Costs a reference per block, the elements
+ * themselves are only copied when a writer later touches a block a view
+ * still holds, so records must not be written through pointers from
+ * ALget once published. Other lists fail with EINVAL.
+ */
+int ALpublish(int handler) {
+    struct _Array *a;
+    int status = -1;
+    
+    if ((a = acquire(handler)) != NULL) {
+        status = publish(a);
+        CTrelease(a);
+    }
+    return status;
+}
+
+/*
+ * The last published view of a segmented list, publishing one if there
+ * is none yet. Taking a published view takes no lock, so any number of
+ * readers can do it while a writer works on the list. The view never
+ * changes and must be given back with ALviewrelease.
+ */
+view *ALsnapshot(int handler) {
+    struct _Array *a = CTpeek(&controller, handler);
+    struct _View *v = NULL;
+    int refs = 0;
+    
+    if (a == NULL) {
+        perror(S_EFAULT);
+        return NULL;
+    }
+    EPenter();
+    do {
+        v = A_LOAD(a->published);
+        if (v == NULL) {
+            break;
+        }
+        refs = A_LOAD(v->refs);
+        while ((refs > 0)
+               && !A_CAS(v->refs, &refs, refs + 1)) {
+        }
+    } while (refs == 0);
+    EPexit();
+    
+    if ((v == NULL) && ((a = acquire(handler)) != NULL)) {
+        if ((a->published != NULL) || (publish(a) == 0)) {
+            v = a->published;
+            A_ADD(v->refs, 1);
+        }
+        CTrelease(a);
+    }
+    return v;
+}
+
+int ALviewsize(view *v) {
+    return v->used;
+}
+
+/*
+ * Element i of the view, as ALget returned it when the view was
+ * published, or NULL if out of range.
+ */
+void *ALviewget(view *v, int i) {
+    char *slot = NULL;
+    
+    if ((i < 0) || (i >= v->used)) {
+        return NULL;
+    }
+    slot = v->blocks[i >> v->shift] + (size_t)(i & ((1 << v->shift) - 1))*v->elemsize;
+    return v->record?(void *)slot:*(void **)slot;
+}
+
+/*
+ * The last reference out retires the view and collects right away, so a
+ * program that stops taking snapshots does not keep the last ones around.
+ */
+void ALviewrelease(view *v) {
+    if (A_ADD(v->refs, -1) == 0) {
+        EPretire(v, freeview);
+        EPcollect();
+    }
+}
+
+
+/**
+ * Static-scope functions definition
+ *
+ */
+/*
+ * A non-zero shift makes a segmented list with blocks of 1 << shift
+ * slots.
+ */
+static int newarray(int init_size, size_t elem_size, char record, int shift, const allocator *alloc) {
+    int handler = -1;
+    struct _Array *array = NULL;
+    int status = 0;
+    
+    if (init_size <= 0) {
+        init_size = A_INITCAPACITY;
+    }
+    if ((handler = CTclaim(&controller, (void **)&array)) < 0) {
+        return -1;
+    }
+    array->used_buckets = 0;
+    array->elemsize = elem_size;
+    array->record = record;
+    if (alloc != NULL) {
+        array->alloc = *alloc;
+    }
+    if (shift > 0) {
+        array->shift = shift;
+        status = addblocks(array, 1);
+    } else if ((array->buckets = allocate(array, elem_size*init_size)) == NULL) {
+        status = nomem(array);
+    } else {
+        array->total_buckets = init_size;
+        A_ALLOCATED(array, 0, elem_size*init_size);
+    }
+    if (status != 0) {
+        if (array->blocks != NULL) {
+            release(array, array->blocks, sizeof(char *)*array->maxblocks);
+            array->blocks = NULL;
+        }
+        CTdispose(&controller, array);
+        errno = ENOMEM;
+        return -1;
+    }
+    CTrelease(array);
+    return handler;
+}
+static void *elemat(struct _Array *a, int i) {
+    return a->record?(void *)slotat(a, i):*(void **)slotat(a, i);
+}
+
+static char *slotat(struct _Array *a, int i) {
+    if ((a->old != NULL) && (i >= a->moved) && (i < a->oldused)) {
+        return a->old + (size_t)(a->oldhead + i)*a->elemsize;
+    }
+    if (a->blocks != NULL) {
+        return a->blocks[i >> a->shift] + (size_t)(i & ((1 << a->shift) - 1))*a->elemsize;
+    }
+    return SLOT(a, i);
+}
+
+/*
+ * Number of slots from i up to the end of its block, or of the buffer,
+ * with *p pointing at slot i.
+ */
+static int runat(struct _Array *a, int i, char **p) {
+    *p = slotat(a, i);
+    if (a->blocks != NULL) {
+        return (1 << a->shift) - (i & ((1 << a->shift) - 1));
+    }
+    return a->total_buckets - a->head - i;
+}
+
+/*
+ * Number of slots before i back to the start of their block, or of the
+ * list, with *p pointing at the first of them.
+ */
+static int runbefore(struct _Array *a, int i, char **p) {
+    int start = 0;
+    
+    if (a->blocks != NULL) {
+        start = (i - 1) & ~((1 << a->shift) - 1);
+    }
+    *p = slotat(a, start);
+    return i - start;
+}
+
+/*
+ * Moves n elements from src to dst a block run at a time, walking
+ * backwards when moving up so overlapping ranges are safe.
+ */
+static void moverange(struct _Array *a, int dst, int src, int n) {
+    char *d = NULL, *s = NULL;
+    int len = 0, ls = 0;
+    
+    if (dst > src) {
+        while (n > 0) {
+            len = runbefore(a, dst + n, &d);
+            ls = runbefore(a, src + n, &s);
+            len = (len < ls)?len:ls;
+            len = (len < n)?len:n;
+            n -= len;
+            memmove(slotat(a, dst + n), slotat(a, src + n), a->elemsize*len);
+        }
+    } else if (dst < src) {
+        while (n > 0) {
+            len = runat(a, dst, &d);
+            ls = runat(a, src, &s);
+            len = (len < ls)?len:ls;
+            len = (len < n)?len:n;
+            memmove(d, s, a->elemsize*len);
+            dst += len;
+            src += len;
+            n -= len;
+        }
+    }
+}
+
+/*
+ * Copies n elements between the list at i and buf, out of the list when
+ * out is set and into it otherwise.
+ */
+static void copyrange(struct _Array *a, int i, char *buf, int n, char out) {
+    char *p = NULL;
+    int len = 0;
+    
+    while (n > 0) {
+        len = runat(a, i, &p);
+        len = (len < n)?len:n;
+        if (out) {
+            memcpy(buf, p, a->elemsize*len);
+        } else {
+            memcpy(p, buf, a->elemsize*len);
+        }
+        buf += a->elemsize*len;
+        i += len;
+        n -= len;
+    }
+}
+
+/*
+ * Allocates blocks until the list holds total slots. Only the directory
+ * is ever reallocated.
+ */
+static int addblocks(struct _Array *a, int total) {
+    char **tmp = NULL;
+    int max = 0;
+    
+    while (a->total_buckets < total) {
+        if (a->nblocks == a->maxblocks) {
+            max = (a->maxblocks > 0)?a->maxblocks*2:8;
+            tmp = reallocate(a, a->blocks, sizeof(char *)*a->maxblocks, sizeof(char *)*max);
+            if (tmp == NULL) {
+                return nomem(a);
+            }
+            A_COUNT(a, reallocs, 1);
+            A_ALLOCATED(a, sizeof(char *)*a->maxblocks, sizeof(char *)*max);
+            a->blocks = tmp;
+            a->maxblocks = max;
+        }
+        a->blocks[a->nblocks] = newblock(a);
+        if (a->blocks[a->nblocks] == NULL) {
+            return nomem(a);
+        }
+        A_ALLOCATED(a, 0, a->elemsize << a->shift);
+        a->nblocks++;
+        a->total_buckets += 1 << a->shift;
+    }
+    return 0;
+}
+
+/*
+ * Frees the blocks past the last element, keeping the first one.
+ */
+static void trimblocks(struct _Array *a) {
+    int keep = (a->used_buckets + (1 << a->shift) - 1) >> a->shift;
+    
+    if (keep < 1) {
+        keep = 1;
+    }
+    while (a->nblocks > keep) {
+        dropblock(a->blocks[--a->nblocks]);
+        A_ALLOCATED(a, a->elemsize << a->shift, 0);
+        a->total_buckets -= 1 << a->shift;
+    }
+}
+
+/*
+ * Blocks always come from the heap, segmented lists having no
+ * allocator, as the last view holding one may free it on any thread.
+ */
+static char *newblock(struct _Array *a) {
+    char *p = malloc(A_BLOCKHEAD + (a->elemsize << a->shift));
+    
+    if (p == NULL) {
+        return NULL;
+    }
+    p += A_BLOCKHEAD;
+    *BLOCKREFS(p) = 1;
+    *BLOCKFILLED(p) = 0;
+    return p;
+}
+
+static void dropblock(char *p) {
+    if (A_ADD(*BLOCKREFS(p), -1) == 0) {
+        free(p - A_BLOCKHEAD);
+    }
+}
+
+/*
+ * Gives the list its own copy of every block holding a slot in
+ * [from, to) that a view still holds, before those slots are written.
+ */
+static int own(struct _Array *a, int from, int to) {
+    char *p = NULL;
+    int k = 0;
+    
+    if (!a->shared || (from >= to)) {
+        return 0;
+    }
+    for (k = from >> a->shift; k <= ((to - 1) >> a->shift); k++) {
+        if (A_LOAD(*BLOCKREFS(a->blocks[k])) > 1) {
+            if ((p = newblock(a)) == NULL) {
+                return nomem(a);
+            }
+            memcpy(p, a->blocks[k], a->elemsize << a->shift);
+            dropblock(a->blocks[k]);
+            a->blocks[k] = p;
+            A_COUNT(a, reallocs, 1);
+        }
+    }
+    return 0;
+}
+
+/*
+ * Reserves n slots at the end of an append-only list, copies src into
+ * them and marks them filled. Returns the first slot.
+ */
+static char *append(struct _Array *a, int handler, char *src, int n) {
+    int i = A_RESERVE(a->reserved, n);
+    char **blocks = NULL;
+    char *first = NULL;
+    char *p = NULL;
+    int len = 0;
+    
+    if (reach(a, handler, i + n) != 0) {
+        return NULL;
+    }
+    EPenter();
+    blocks = A_LOAD(a->blocks);
+    while (n > 0) {
+        p = A_LOAD(blocks[i >> a->shift]);
+        len = (1 << a->shift) - (i & ((1 << a->shift) - 1));
+        len = (len < n)?len:n;
+        p += (size_t)(i & ((1 << a->shift) - 1))*a->elemsize;
+        memcpy(p, src, a->elemsize*len);
+        A_ADD(*BLOCKFILLED(blocks[i >> a->shift]), len);
+        if (first == NULL) {
+            first = p;
+        }
+        src += a->elemsize*len;
+        i += len;
+        n -= len;
+    }
+    EPexit();
+    return first;
+}
+
+/*
+ * Makes sure an append-only list has at least total slots, taking the
+ * lock only when it has not, and then allocating a block more so that
+ * appenders rarely meet there.
+ */
+static int reach(struct _Array *a, int handler, int total) {
+    int status = 0;
+    
+    if (A_LOAD(a->total_buckets) >= total) {
+        return 0;
+    }
+    if ((a = acquire(handler)) == NULL) {
+        return -1;
+    }
+    if (a->total_buckets < total) {
+        status = extend(a, total + (1 << a->shift));
+    }
+    CTrelease(a);
+    return status;
+}
+
+/*
+ * addblocks for append-only lists. Appenders read the directory without
+ * the lock, so a full one is copied into a larger one and retired rather
+ * than reallocated, and total_buckets only grows once the blocks are in.
+ */
+static int extend(struct _Array *a, int total) {
+    char **tmp = NULL;
+    char *p = NULL;
+    int max = 0;
+    
+    while (a->total_buckets < total) {
+        if (a->nblocks == a->maxblocks) {
+            max = a->maxblocks*2;
+            if ((tmp = allocate(a, sizeof(char *)*max)) == NULL) {
+                return nomem(a);
+            }
+            memcpy(tmp, a->blocks, sizeof(char *)*a->nblocks);
+            A_COUNT(a, reallocs, 1);
+            A_ALLOCATED(a, sizeof(char *)*a->maxblocks, sizeof(char *)*max);
+            EPretire(A_EXCHANGE(a->blocks, tmp), free);
+            a->maxblocks = max;
+        }
+        if ((p = newblock(a)) == NULL) {
+            return nomem(a);
+        }
+        A_ALLOCATED(a, 0, a->elemsize << a->shift);
+        A_STORE(a->blocks[a->nblocks], p);
+        a->nblocks++;
+        A_STORE(a->total_buckets, a->total_buckets + (1 << a->shift));
+    }
+    return 0;
+}
+
+/*
+ * Called with the lock held. A block is complete once its filled count
+ * reaches the number of its slots reserved, which is read after the
+ * count, so no slot reserved later can have been counted.
+ */
+static void commit(struct _Array *a) {
+    int k = a->used_buckets >> a->shift;
+    int filled = 0;
+    int end = 0;
+    
+    while (k < a->nblocks) {
+        filled = A_LOAD(*BLOCKFILLED(a->blocks[k]));
+        end = A_PEEK(a->reserved);
+        if (end > (k + 1) << a->shift) {
+            end = (k + 1) << a->shift;
+        }
+        if ((end <= a->used_buckets) || (filled != end - (k << a->shift))) {
+            break;
+        }
+        a->used_buckets = end;
+        k++;
+    }
+}
+
+/*
+ * A view of the current contents of a segmented list, taking a reference
+ * to every block it covers. Returns NULL if it cannot be allocated.
+ */
+static struct _View *pin(struct _Array *a) {
+    struct _View *v = NULL;
+    int k = 0;
+    
+    if ((v = malloc(sizeof(struct _View) + sizeof(char *)*a->nblocks)) == NULL) {
+        return NULL;
+    }
+    v->refs = 1;
+    v->used = a->used_buckets;
+    v->shift = a->shift;
+    v->elemsize = a->elemsize;
+    v->record = a->record;
+    v->nblocks = (a->used_buckets + (1 << a->shift) - 1) >> a->shift;
+    v->blocks = (char **)(v + 1);
+    for (k = 0; k < v->nblocks; k++) {
+        v->blocks[k] = a->blocks[k];
+        A_ADD(*BLOCKREFS(v->blocks[k]), 1);
+    }
+    a->shared = 1;
+    return v;
+}
+
+/*
+ * Swaps in a view of the current contents and lets go of the list's
+ * reference to the last one.
+ */
+static int publish(struct _Array *a) {
+    struct _View *v = NULL;
+    
+    if (a->blocks == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((v = pin(a)) == NULL) {
+        return nomem(a);
+    }
+    v = A_EXCHANGE(a->published, v);
+    if (v != NULL) {
+        ALviewrelease(v);
+    }
+    EPcollect();
+    return 0;
+}
+
+/*
+ * Called by the epoch collector once no reader can reach the view.
+ */
+static void freeview(void *p) {
+    struct _View *v = p;
+    int k = 0;
+    
+    for (k = 0; k < v->nblocks; k++) {
+        dropblock(v->blocks[k]);
+    }
+    free(v);
+}
+
+/*
+ * Capacity the growth policy picks for needed elements. The default
+ * policy keeps the array under A_LOADFACT, except within a capacity kept
+ * by ALreserve; the others only grow once the array is full. Whatever a
+ * policy picks is cut down to the largest capacity a list can have and
+ * raised to needed. Fails with ENOMEM when needed is beyond that.
+ */
+static int grown(struct _Array *a, double needed) {
+    double limit = maxcapacity(a);
+    double total = a->total_buckets;
+    
+    if (needed > limit) {
+        return toolarge();
+    }
+    switch (a->policy) {
+        case A_GROWFACTOR:
+            if (needed > total)
+                total = total*a->factor + 1;
+            break;
+        case A_GROWADD:
+            if (needed > total)
+                total += a->increment;
+            break;
+        case A_GROWCALLBACK:
+            if (needed > total)
+                total = a->grow(a->total_buckets, (int)needed, a->growctx);
+            break;
+        default:
+            if ((needed > a->kept) && (needed > total*A_LOADFACT))
+                total = needed*A_EXPRATE;
+            break;
+    }
+    if (total > limit) {
+        total = limit;
+    }
+    return (int)((total > needed)?total:needed);
+}
+
+/*
+ * Reports a list that would outgrow maxcapacity. perror may change errno
+ * the first time it writes, so it is set again.
+ */
+static int toolarge(void) {
+    errno = ENOMEM;
+    perror(S_NOMEM);
+    errno = ENOMEM;
+    return -1;
+}
+
+/*
+ * Slots are counted in ints and their bytes in a size_t.
+ */
+static double maxcapacity(struct _Array *a) {
+    double bytes = (double)SIZE_MAX/a->elemsize;
+    
+    return (bytes < INT_MAX)?bytes:INT_MAX;
+}
+
+/*
+ * Makes room for n more elements at the back with a single realloc. When
+ * the policy keeps the capacity but the tail ran into the end of the
+ * buffer, the elements slide down over the front gap if that gap is
+ * large enough to pay for the move, and the buffer grows otherwise.
+ * Incremental lists swap in a fresh buffer and leave the elements to
+ * migrate.
+ */
+static int check(struct _Array *a, int n) {
+    double needed = (double)a->used_buckets + n;
+    int total = grown(a, needed);
+    char *tmp = NULL;
+    
+    if (total < 0) {
+        return -1;
+    }
+    if ((total != a->total_buckets) && (a->step > 0)) {
+        migrate(a, a->used_buckets);
+        if (unmap(a) != 0) {
+            return -1;
+        }
+        tmp = allocate(a, a->elemsize*total);
+        if (tmp == NULL) {
+            return nomem(a);
+        }
+        A_COUNT(a, reallocs, 1);
+        A_ALLOCATED(a, 0, a->elemsize*total);
+        a->oldbytes = a->elemsize*a->total_buckets;
+        a->old = a->buckets;
+        a->oldhead = a->head;
+        a->oldused = a->used_buckets;
+        a->moved = 0;
+        a->released = 0;
+        a->buckets = tmp;
+        a->head = 0;
+        a->total_buckets = total;
+    } else if (total != a->total_buckets) {
+        return resize(a, total, 0);
+    } else if (a->head + needed > total) {
+        if ((a->head >= (a->used_buckets >> 1))
+            || ((double)total + 1 + a->head > maxcapacity(a))) {
+            return resize(a, total, 0);
+        }
+        total = grown(a, (double)total + 1);
+        if ((double)total + a->head > maxcapacity(a)) {
+            total = (int)maxcapacity(a) - a->head;
+        }
+        return resize(a, total + a->head, a->head);
+    }
+    return 0;
+}
+
+/*
+ * Makes room for n more elements at the front. A buffer without enough
+ * front gap is regrown with half a list of slack and the elements are
+ * centred in it, so pushes at either end stay amortised O(1).
+ */
+static int checkfront(struct _Array *a, int n) {
+    double needed = (double)a->used_buckets + n;
+    double slack = needed + (int)(needed/2);
+    int total = 0;
+    
+    if ((a->head >= n) || (a->blocks != NULL)) {
+        return 0;
+    }
+    if ((total = grown(a, (slack > maxcapacity(a))?needed:slack)) < 0) {
+        return -1;
+    }
+    return resize(a, total, n + (int)((total - needed)/2));
+}
+
+/*
+ * Reallocates the buffer to total slots with the elements starting head
+ * slots in. They are moved down before shrinking and up after growing,
+ * so they are never cut off.
+ */
+static int resize(struct _Array *a, int total, int head) {
+    char *tmp = NULL;
+    size_t es = a->elemsize;
+    
+    migrate(a, a->used_buckets);
+    if (unmap(a) != 0) {
+        return -1;
+    }
+    if (head < a->head) {
+        memmove(a->buckets + es*head, SLOT(a, 0), es*a->used_buckets);
+        a->head = head;
+    }
+    if (total != a->total_buckets) {
+        tmp = reallocate(a, a->buckets, es*a->total_buckets, es*total);
+        if (tmp == NULL) {
+            return nomem(a);
+        }
+        A_COUNT(a, reallocs, 1);
+        A_ALLOCATED(a, es*a->total_buckets, es*total);
+        a->buckets = tmp;
+        a->total_buckets = total;
+    }
+    if (head > a->head) {
+        memmove(a->buckets + es*head, SLOT(a, 0), es*a->used_buckets);
+        a->head = head;
+    }
+    return 0;
+}
+
+/*
+ * Locks the handle's array, reporting invalid handlers the way every
+ * public function of this module always has.
+ */
+static struct _Array *acquire(int handler) {
+    struct _Array *a = CTacquire(&controller, handler);
+    if (a == NULL) {
+        perror(S_EFAULT);
+    } else if (a->old != NULL) {
+        migrate(a, a->step);
+    } else if (a->appendonly) {
+        commit(a);
+    }
+    return a;
+}
+
+/*
+ * Moves up to n elements of an incremental growth into the new buffer
+ * and frees the old one once it is empty. Large old buffers hand their
+ * copied pages back as they go, otherwise the final free would unmap
+ * them all in one go. Only heap buffers do: the pages of a user
+ * allocator or an arena are not the list's to give back.
+ */
+static void migrate(struct _Array *a, int n) {
+#if defined(A_MADVISE)
+    size_t page = 0, lo = 0, hi = 0;
+#endif
+    
+    if (a->old == NULL) {
+        return;
+    }
+    if (n > a->oldused - a->moved) {
+        n = a->oldused - a->moved;
+    }
+    memcpy(SLOT(a, a->moved), a->old + (size_t)(a->oldhead + a->moved)*a->elemsize, a->elemsize*n);
+    a->moved += n;
+#if defined(A_MADVISE)
+    if ((a->alloc.alloc == NULL) && (a->elemsize*a->oldused >= A_RELEASEMIN)) {
+        page = (size_t)sysconf(_SC_PAGESIZE);
+        lo = ((size_t)a->old + a->released + page - 1) & ~(page - 1);
+        hi = ((size_t)a->old + (size_t)(a->oldhead + a->moved)*a->elemsize) & ~(page - 1);
+        if (hi > lo) {
+            madvise((void *)lo, hi - lo, MADV_DONTNEED);
+            a->released = hi - (size_t)a->old;
+        }
+    }
+#endif
+    if (a->moved == a->oldused) {
+        A_ALLOCATED(a, a->oldbytes, 0);
+        release(a, a->old, a->oldbytes);
+        a->old = NULL;
+    }
+}
+
+/*
+ * Moves a mapped list onto the heap, the buffer being about to be
+ * reallocated or freed.
+ */
+static int unmap(struct _Array *a) {
+    char *tmp = NULL;
+    int total = (a->total_buckets > 0)?a->total_buckets:1;
+    
+    if (a->mapping == NULL) {
+        return 0;
+    }
+    tmp = allocate(a, a->elemsize*total);
+    if (tmp == NULL) {
+        return nomem(a);
+    }
+    memcpy(tmp, a->buckets, a->elemsize*a->used_buckets);
+#if defined(A_MMAP)
+    munmap(a->mapping, a->maplen);
+#endif
+    A_COUNT(a, reallocs, 1);
+    A_ALLOCATED(a, 0, a->elemsize*total);
+    a->mapping = NULL;
+    a->maplen = 0;
+    a->buckets = tmp;
+    a->total_buckets = total;
+    return 0;
+}
+
+/*
+ * Every buffer of a list goes through these, so lists created with
+ * ALnewwith never touch the heap for their elements.
+ */
+static void *allocate(struct _Array *a, size_t size) {
+    if (a->alloc.alloc != NULL) {
+        return a->alloc.alloc(size, a->alloc.ctx);
+    }
+    return malloc(size);
+}
+
+static void *reallocate(struct _Array *a, void *p, size_t old, size_t size) {
+    if (a->alloc.alloc != NULL) {
+        return a->alloc.resize(p, old, size, a->alloc.ctx);
+    }
+    return realloc(p, size);
+}
+
+static void release(struct _Array *a, void *p, size_t size) {
+    if (a->alloc.alloc != NULL) {
+        a->alloc.release(p, size, a->alloc.ctx);
+    } else {
+        free(p);
+    }
+}
+
+/*
+ * Running out of memory ends the process for heap lists, as it always
+ * has, and fails with ENOMEM for lists with an allocator.
+ */
+static int nomem(struct _Array *a) {
+    errno = ENOMEM;
+    if (a->alloc.alloc == NULL) {
+        perror(S_NOMEM);
+        exit(EXIT_FAILURE);
+    }
+    return -1;
+}
+/*
+ * Reads a snapshot header and, for raw records, checks that the file is
+ * long enough for them, leaving it positioned at the payload. Returns the
+ * payload kind, or -1 with errno set.
+ */
+static int readheader(FILE *f, size_t *es, size_t *count) {
+    int kind = 0;
+    long size = 0;
+    
+    if (SNreadheader(f, &kind, es, count) != 0) {
+        return -1;
+    }
+    if (kind == SN_RECORDS) {
+        if ((fseek(f, 0, SEEK_END) != 0) || ((size = ftell(f)) < 0)
+            || (fseek(f, SN_HEADERSIZE, SEEK_SET) != 0)) {
+            return -1;
+        }
+        if ((*es == 0) || ((size_t)size < SN_HEADERSIZE)
+            || ((*count > 0) && (*es > ((size_t)size - SN_HEADERSIZE) / *count))) {
+            errno = EINVAL;
+            return -1;
+        }
+    }
+    return kind;
+}
+
+/*
+ * Opens a gap of n slots at i and copies src into it. The elements before
+ * i move down into the front gap when there are fewer of them and the gap
+ * is large enough; otherwise the tail moves up. Returns the number of
+ * elements inserted, or -1 if the range is invalid.
+ */
+static int insertrange(struct _Array *a, int i, void **src, int n) {
+    if (a->appendonly) {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((i < 0) || (i > a->used_buckets) || (n < 0)) {
+        errno = EFAULT;
+        perror(S_EFAULT);
+        return -1;
+    }
+    if (n > INT_MAX - a->used_buckets) {
+        return toolarge();
+    }
+    if (i < a->used_buckets) {
+        migrate(a, a->used_buckets);
+    }
+    if (a->blocks != NULL) {
+        if ((addblocks(a, a->used_buckets + n) != 0)
+            || (own(a, i, a->used_buckets + n) != 0)) {
+            return -1;
+        }
+        moverange(a, i + n, i, a->used_buckets - i);
+        A_COUNT(a, shifted, a->used_buckets - i);
+    } else if ((i < a->used_buckets - i) && (a->head >= n)) {
+        a->head -= n;
+        memmove(SLOT(a, 0), SLOT(a, n), a->elemsize*i);
+        A_COUNT(a, shifted, i);
+    } else {
+        if (check(a, n) != 0) {
+            return -1;
+        }
+        if (i < a->used_buckets) {
+            migrate(a, a->used_buckets);
+        }
+        memmove(SLOT(a, i+n), SLOT(a, i), a->elemsize*(a->used_buckets - i));
+        A_COUNT(a, shifted, a->used_buckets - i);
+    }
+    copyrange(a, i, (char *)src, n, 0);
+    a->used_buckets += n;
+    a->modcount++;
+    return n;
+}
+
+/*
+ * Removes the elements in [from, to) by moving whichever side of the
+ * range is shorter, so removing at the front is O(1). Returns the number
+ * of elements removed, or -1 if the range is invalid.
+ */
+static int removerange(struct _Array *a, int from, int to) {
+    if (a->appendonly) {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((from < 0) || (to > a->used_buckets) || (from > to)) {
+        errno = EFAULT;
+        perror(S_EFAULT);
+        return -1;
+    }
+    if (to < a->used_buckets) {
+        migrate(a, a->used_buckets);
+    }
+    if (a->blocks != NULL) {
+        if (own(a, from, a->used_buckets) != 0) {
+            return -1;
+        }
+        moverange(a, from, to, a->used_buckets - to);
+        A_COUNT(a, shifted, a->used_buckets - to);
+    } else if (from < a->used_buckets - to) {
+        memmove(SLOT(a, to - from), SLOT(a, 0), a->elemsize*from);
+        A_COUNT(a, shifted, from);
+        a->head += to - from;
+    } else {
+        memmove(SLOT(a, from), SLOT(a, to), a->elemsize*(a->used_buckets - to));
+        A_COUNT(a, shifted, a->used_buckets - to);
+    }
+    a->used_buckets -= to - from;
+    a->modcount++;
+    if (a->used_buckets == 0) {
+        a->head = 0;
+    }
+    if ((a->old != NULL) && (a->oldused > a->used_buckets)) {
+        a->oldused = a->used_buckets;
+        if (a->moved > a->oldused) {
+            a->moved = a->oldused;
+        }
+        migrate(a, 0);
+    }
+    return to - from;
+}
+
+static void *ALitnext(iterator *it) {
+    struct _Array *a;
+    void *elem = NULL;
+    
+    if (it->hasnext && ((a = acquireit(it)) != NULL)) {
+        updateit(it, a);
+        if (it->hasnext) {
+            elem = elemat(a, it->carriage);
+            it->carriage++;
+            A_COUNT(a, steps, 1);
+            updateit(it, a);
+        }
+        CTrelease(a);
+    }
+    return elem;
 }
 
 static void *ALitprev(iterator *it) {
+    struct _Array *a;
     void *elem = NULL;
-    if (it->hasprev) {
-        it->carriage--;
-        elem = controller.buckets[it->handler].buckets[it->carriage];
-        it->update(it);
+    
+    if (it->hasprev && ((a = acquireit(it)) != NULL)) {
+        updateit(it, a);
+        if (it->hasprev) {
+            it->carriage--;
+            elem = elemat(a, it->carriage);
+            A_COUNT(a, steps, 1);
+            updateit(it, a);
+        }
+        CTrelease(a);
     }
     return elem;
 }
 
 static void ALupdateit(iterator *it) {
-    it->total_elems = controller.buckets[it->handler].used_buckets;
-    it->hasnext = (it->carriage < it->total_elems)?1:0;
-    it->hasprev = (it->carriage > 0)?1:0;
+    struct _Array *a;
+    
+    if ((a = acquireit(it)) != NULL) {
+        updateit(it, a);
+        CTrelease(a);
+    }
     return;
 }
 
 static void ALresetit(iterator *it) {
-    it->carriage = 0;
-    it->update(it);
-}
\ No newline at end of file
+    struct _Array *a;
+    
+    if ((a = acquire(it->handler)) != NULL) {
+        it->carriage = 0;
+        it->modcount = a->modcount;
+        updateit(it, a);
+        CTrelease(a);
+    }
+}
+
+static void updateit(iterator *it, struct _Array *a) {
+    it->total_elems = a->used_buckets;
+    it->hasnext = (it->carriage < it->total_elems)?1:0;
+    it->hasprev = (it->carriage > 0)?1:0;
+}
+
+/*
+ * Locks the list behind an iterator. An iterator is only valid while no
+ * element has been inserted into or removed from the list since it was
+ * made or reset; concurrent appends do not count.
+ */
+static struct _Array *acquireit(iterator *it) {
+    struct _Array *a;
+    
+    if ((a = acquire(it->handler)) != NULL) {
+        if (it->modcount == a->modcount) {
+            return a;
+        }
+        CTrelease(a);
+    }
+    errno = EFAULT;
+    it->hasnext = 0;
+    it->hasprev = 0;
+    return NULL;
+}
+
+static int lowerbound(struct _Array *a, void *key, comparator cmp) {
+    int lo = 0, hi = a->used_buckets, mid = 0;
+    
+    while (lo < hi) {
+        mid = lo + ((hi - lo) >> 1);
+        if (cmp(elemat(a, mid), key) < 0) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static int compare(struct _Sorter *s, const char *x, const char *y) {
+    if (s->record) {
+        return s->cmp(x, y);
+    }
+    return s->cmp(*(void * const *)x, *(void * const *)y);
+}
+
+static void copyelem(struct _Sorter *s, char *dst, const char *src) {
+    if (s->es == sizeof(void *)) {
+        *(void **)dst = *(void * const *)src;
+    } else {
+        memcpy(dst, src, s->es);
+    }
+}
+
+static void swapelems(struct _Sorter *s, char *x, char *y) {
+    void *p = NULL;
+    char tmp[64];
+    size_t n = 0, left = s->es;
+    
+    if (s->es == sizeof(void *)) {
+        p = *(void **)x;
+        *(void **)x = *(void **)y;
+        *(void **)y = p;
+        return;
+    }
+    while (left > 0) {
+        n = (left < sizeof(tmp))?left:sizeof(tmp);
+        memcpy(tmp, x, n);
+        memcpy(x, y, n);
+        memcpy(y, tmp, n);
+        x += n;
+        y += n;
+        left -= n;
+    }
+}
+
+/*
+ * Sorts m->src. The result ends up in m->dst when m->intodst is set and
+ * in m->src otherwise; each level merges into the buffer its children
+ * left free. The list stays locked, so the groups are confined.
+ */
+static void msort(void *arg) {
+    struct _MergeSort *m = arg;
+    struct _MergeSort left, right;
+    struct _Merge mg;
+    taskgroup group = TP_CONFINED_INITIALIZER;
+    size_t es = m->s->es;
+    int half = m->n >> 1;
+    int depth = 0;
+    
+    if (m->n <= A_SORTCUTOFF) {
+        for (depth = 1; (1 << depth) < m->n; depth++);
+        introsort(m->s, m->src, m->n, 2*depth);
+        if (m->intodst) {
+            memcpy(m->dst, m->src, es*m->n);
+        }
+        return;
+    }
+    left.s = right.s = m->s;
+    left.src = m->src;
+    left.dst = m->dst;
+    left.n = half;
+    right.src = m->src + es*half;
+    right.dst = m->dst + es*half;
+    right.n = m->n - half;
+    left.intodst = right.intodst = !m->intodst;
+    TPspawn(&group, msort, &left);
+    msort(&right);
+    TPwait(&group);
+    
+    mg.s = m->s;
+    mg.a = m->intodst?m->src:m->dst;
+    mg.na = half;
+    mg.b = mg.a + es*half;
+    mg.nb = m->n - half;
+    mg.out = m->intodst?m->dst:m->src;
+    pmerge(&mg);
+}
+
+/*
+ * Splits the larger run at its middle, finds the matching split of the
+ * other run by binary search, and merges both halves in parallel. Equal
+ * elements of the first run always stay ahead of the second's.
+ */
+static void pmerge(void *arg) {
+    struct _Merge *m = arg;
+    struct _Merge left, right;
+    taskgroup group = TP_CONFINED_INITIALIZER;
+    size_t es = m->s->es;
+    int ma = 0, mb = 0, lo = 0, hi = 0, mid = 0;
+    
+    if (m->na + m->nb <= A_SORTCUTOFF) {
+        merge(m->s, m->a, m->na, m->b, m->nb, m->out);
+        return;
+    }
+    if (m->na >= m->nb) {
+        ma = m->na >> 1;
+        lo = 0;
+        hi = m->nb;
+        while (lo < hi) {
+            mid = lo + ((hi - lo) >> 1);
+            if (compare(m->s, m->b + es*mid, m->a + es*ma) < 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        mb = lo;
+    } else {
+        mb = m->nb >> 1;
+        lo = 0;
+        hi = m->na;
+        while (lo < hi) {
+            mid = lo + ((hi - lo) >> 1);
+            if (compare(m->s, m->a + es*mid, m->b + es*mb) <= 0) {
+                lo = mid + 1;
+            } else {
+                hi = mid;
+            }
+        }
+        ma = lo;
+    }
+    left.s = right.s = m->s;
+    left.a = m->a;
+    left.na = ma;
+    left.b = m->b;
+    left.nb = mb;
+    left.out = m->out;
+    right.a = m->a + es*ma;
+    right.na = m->na - ma;
+    right.b = m->b + es*mb;
+    right.nb = m->nb - mb;
+    right.out = m->out + es*(ma + mb);
+    TPspawn(&group, pmerge, &left);
+    pmerge(&right);
+    TPwait(&group);
+}
+
+static void merge(struct _Sorter *s, char *a, int na, char *b, int nb, char *out) {
+    while ((na > 0) && (nb > 0)) {
+        if (compare(s, b, a) < 0) {
+            copyelem(s, out, b);
+            b += s->es;
+            nb--;
+        } else {
+            copyelem(s, out, a);
+            a += s->es;
+            na--;
+        }
+        out += s->es;
+    }
+    memcpy(out, a, s->es*na);
+    memcpy(out + s->es*na, b, s->es*nb);
+}
+
+static void introsort(struct _Sorter *s, char *base, int n, int depth) {
+    int p = 0;
+    
+    while (n > A_INSERTIONSORT) {
+        if (depth-- == 0) {
+            heapsort(s, base, n);
+            return;
+        }
+        p = partition(s, base, n);
+        if (p < n - p - 1) {
+            introsort(s, base, p, depth);
+            base += s->es*(p + 1);
+            n -= p + 1;
+        } else {
+            introsort(s, base + s->es*(p + 1), n - p - 1, depth);
+            n = p;
+        }
+    }
+    insertionsort(s, base, n);
+}
+
+/*
+ * Median-of-three pivot parked at the front, then a Hoare partition whose
+ * scans both stop on keys equal to the pivot, which keeps runs of
+ * duplicates balanced. Returns the final index of the pivot.
+ */
+static int partition(struct _Sorter *s, char *base, int n) {
+    size_t es = s->es;
+    char *lo = base, *mid = base + es*(n >> 1), *hi = base + es*(n - 1);
+    int i = 0, j = n;
+    
+    if (compare(s, mid, lo) < 0)
+        swapelems(s, mid, lo);
+    if (compare(s, hi, mid) < 0) {
+        swapelems(s, hi, mid);
+        if (compare(s, mid, lo) < 0)
+            swapelems(s, mid, lo);
+    }
+    swapelems(s, base, mid);
+    for (;;) {
+        do {
+            i++;
+        } while ((i < n) && (compare(s, base + es*i, base) < 0));
+        do {
+            j--;
+        } while (compare(s, base + es*j, base) > 0);
+        if (i >= j) {
+            break;
+        }
+        swapelems(s, base + es*i, base + es*j);
+    }
+    swapelems(s, base, base + es*j);
+    return j;
+}
+
+static void heapsort(struct _Sorter *s, char *base, int n) {
+    int i = 0;
+    
+    for (i = (n >> 1) - 1; i >= 0; i--) {
+        siftdown(s, base, i, n);
+    }
+    for (i = n - 1; i > 0; i--) {
+        swapelems(s, base, base + s->es*i);
+        siftdown(s, base, 0, i);
+    }
+}
+
+static void siftdown(struct _Sorter *s, char *base, int i, int n) {
+    int child = 0;
+    
+    while ((child = 2*i + 1) < n) {
+        if ((child + 1 < n) && (compare(s, base + s->es*child, base + s->es*(child + 1)) < 0)) {
+            child++;
+        }
+        if (compare(s, base + s->es*i, base + s->es*child) >= 0) {
+            return;
+        }
+        swapelems(s, base + s->es*i, base + s->es*child);
+        i = child;
+    }
+}
+
+static void insertionsort(struct _Sorter *s, char *base, int n) {
+    int i = 0, j = 0;
+    
+    for (i = 1; i < n; i++) {
+        for (j = i; (j > 0) && (compare(s, base + s->es*(j - 1), base + s->es*j) > 0); j--) {
+            swapelems(s, base + s->es*(j - 1), base + s->es*j);
+        }
+    }
+}
+
+/*
+ * Runs short lists on the calling thread, and cuts longer ones into
+ * about A_PARCHUNKS chunks per thread, leaving the balancing to work
+ * stealing.
+ */
+static void traverse(struct _Traversal *t) {
+    int threads = 0;
+    
+    t->grain = t->to - t->from;
+    if (t->grain > A_PARCUTOFF) {
+        threads = TPthreads();
+        if (threads > 1) {
+            t->grain /= threads*A_PARCHUNKS;
+            if (t->grain < A_PARCUTOFF/A_PARCHUNKS) {
+                t->grain = A_PARCUTOFF/A_PARCHUNKS;
+            }
+        }
+    }
+    traversetask(t);
+}
+
+static void traversetask(void *arg) {
+    struct _Traversal *t = arg;
+    struct _Traversal left;
+    taskgroup group = TP_GROUP_INITIALIZER;
+    int i = 0;
+    
+    if (t->to - t->from <= t->grain) {
+        if (t->visit != NULL) {
+            for (i = t->from; i < t->to; i++) {
+                t->visit(traversed(t, i), t->ctx);
+            }
+        } else if (t->map != NULL) {
+            for (i = t->from; i < t->to; i++) {
+                t->out[i] = t->map(traversed(t, i), t->ctx);
+            }
+        } else {
+            for (i = t->from; i < t->to; i++) {
+                t->acc = t->fold(t->acc, traversed(t, i), t->ctx);
+            }
+        }
+        return;
+    }
+    left = *t;
+    left.to = t->from + ((t->to - t->from) >> 1);
+    t->from = left.to;
+    group.confined = (t->a != NULL);
+    TPspawn(&group, traversetask, &left);
+    traversetask(t);
+    TPwait(&group);
+    if (t->fold != NULL) {
+        t->acc = t->combine(left.acc, t->acc, t->ctx);
+    }
+}
+
+/*
+ * Called with the list acquired. Segmented lists are traversed through a
+ * private view, so the list is released right away and the callbacks may
+ * use it; other lists stay acquired until endtraversal, and their chunks
+ * wait on confined groups, so a thread holding the list never picks up
+ * another traversal's task that might need it. Returns -1 when no view
+ * can be allocated, with the list released.
+ */
+static int starttraversal(struct _Traversal *t, struct _Array *a) {
+    memset(t, 0, sizeof(struct _Traversal));
+    t->a = a;
+    t->to = a->used_buckets;
+    if (a->blocks != NULL) {
+        t->v = pin(a);
+        CTrelease(a);
+        if (t->v == NULL) {
+            errno = ENOMEM;
+            perror(S_NOMEM);
+            return -1;
+        }
+        t->a = NULL;
+    }
+    return 0;
+}
+
+static void endtraversal(struct _Traversal *t) {
+    if (t->v != NULL) {
+        freeview(t->v);
+    } else {
+        CTrelease(t->a);
+    }
+}
+
+static void *traversed(struct _Traversal *t, int i) {
+    return (t->v != NULL)?ALviewget(t->v, i):elemat(t->a, i);
+}
+
+/*
+ * Concurrent first calls may each run the detection; they all store the
+ * same answer.
+ */
+static const struct _Scanner *scanner(void) {
+    static const struct _Scanner scalarscanner = { firstscalar, lastscalar, countscalar };
+#if defined(A_SIMD)
+    static const struct _Scanner sse2scanner = { firstsse2, lastsse2, countsse2 };
+    static const struct _Scanner avx2scanner = { firstavx2, lastavx2, countavx2 };
+#endif
+    const struct _Scanner *s = NULL;
+    
+    s = A_LOAD(bestscanner);
+    if (s == NULL) {
+        s = &scalarscanner;
+#if defined(A_SIMD)
+        __builtin_cpu_init();
+        s = &sse2scanner;
+#if !defined(MOUSTASHED_NOAVX2)
+        if (__builtin_cpu_supports("avx2")) {
+            s = &avx2scanner;
+        }
+#endif
+#endif
+        A_STORE(bestscanner, s);
+    }
+    return s;
+}
+
+static int firstscalar(void **v, int n, void *key) {
+    int i = 0;
+    
+    for (i = 0; i < n; i++) {
+        if (v[i] == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int lastscalar(void **v, int n, void *key) {
+    int i = 0;
+    
+    for (i = n - 1; i >= 0; i--) {
+        if (v[i] == key) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+static int countscalar(void **v, int n, void *key) {
+    int i = 0, c = 0;
+    
+    for (i = 0; i < n; i++) {
+        c += (v[i] == key);
+    }
+    return c;
+}
+
+#if defined(A_SIMD)
+/*
+ * SSE2 has no 64-bit compare: a lane matches when both of its 32-bit
+ * halves do. The search kernels test eight pointers a round and locate
+ * the hit with a scalar pass.
+ */
+static __m128i eq64sse2(void **v, __m128i k) {
+    __m128i e = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *)v), k);
+    return _mm_and_si128(e, _mm_shuffle_epi32(e, 0xB1));
+}
+
+#define A_ANYEQ64(v, k) _mm_movemask_epi8(_mm_or_si128( \
+    _mm_or_si128(eq64sse2((v), (k)), eq64sse2((v) + 2, (k))), \
+    _mm_or_si128(eq64sse2((v) + 4, (k)), eq64sse2((v) + 6, (k)))))
+
+static int firstsse2(void **v, int n, void *key) {
+    __m128i k = _mm_set1_epi64x((long long)(size_t)key);
+    int i = 0, j = 0;
+    
+    for (i = 0; i + 8 <= n; i += 8) {
+        if (A_ANYEQ64(v + i, k) != 0) {
+            return i + firstscalar(v + i, 8, key);
+        }
+    }
+    j = firstscalar(v + i, n - i, key);
+    return (j < 0)?-1:i + j;
+}
+
+static int lastsse2(void **v, int n, void *key) {
+    __m128i k = _mm_set1_epi64x((long long)(size_t)key);
+    int i = n;
+    
+    for (i = n; i >= 8; i -= 8) {
+        if (A_ANYEQ64(v + i - 8, k) != 0) {
+            return i - 8 + lastscalar(v + i - 8, 8, key);
+        }
+    }
+    return lastscalar(v, i, key);
+}
+
+static int countsse2(void **v, int n, void *key) {
+    __m128i k = _mm_set1_epi64x((long long)(size_t)key);
+    __m128i c = _mm_setzero_si128();
+    long long lanes[2];
+    int i = 0;
+    
+    for (i = 0; i + 2 <= n; i += 2) {
+        c = _mm_sub_epi64(c, eq64sse2(v + i, k));
+    }
+    _mm_storeu_si128((__m128i *)lanes, c);
+    return (int)(lanes[0] + lanes[1]) + countscalar(v + i, n - i, key);
+}
+
+/*
+ * Eight pointers a round, two compares folded into one test.
+ */
+__attribute__((target("avx2")))
+static int firstavx2(void **v, int n, void *key) {
+    __m256i k = _mm256_set1_epi64x((long long)(size_t)key);
+    __m256i x, y;
+    int i = 0, m = 0;
+    
+    for (i = 0; i + 8 <= n; i += 8) {
+        x = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(v + i)), k);
+        y = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(v + i + 4)), k);
+        if (!_mm256_testz_si256(_mm256_or_si256(x, y), _mm256_or_si256(x, y))) {
+            m = _mm256_movemask_pd(_mm256_castsi256_pd(x))
+                | (_mm256_movemask_pd(_mm256_castsi256_pd(y)) << 4);
+            return i + __builtin_ctz(m);
+        }
+    }
+    m = firstscalar(v + i, n - i, key);
+    return (m < 0)?-1:i + m;
+}
+
+__attribute__((target("avx2")))
+static int lastavx2(void **v, int n, void *key) {
+    __m256i k = _mm256_set1_epi64x((long long)(size_t)key);
+    __m256i x, y;
+    int i = n, m = 0;
+    
+    for (i = n; i >= 8; i -= 8) {
+        x = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(v + i - 8)), k);
+        y = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(v + i - 4)), k);
+        if (!_mm256_testz_si256(_mm256_or_si256(x, y), _mm256_or_si256(x, y))) {
+            m = _mm256_movemask_pd(_mm256_castsi256_pd(x))
+                | (_mm256_movemask_pd(_mm256_castsi256_pd(y)) << 4);
+            return i - 8 + 31 - __builtin_clz(m);
+        }
+    }
+    return lastscalar(v, i, key);
+}
+
+__attribute__((target("avx2")))
+static int countavx2(void **v, int n, void *key) {
+    __m256i k = _mm256_set1_epi64x((long long)(size_t)key);
+    __m256i c = _mm256_setzero_si256();
+    long long lanes[4];
+    int i = 0;
+    
+    /* cmpeq yields -1 per match, so subtracting counts them per lane */
+    for (i = 0; i + 4 <= n; i += 4) {
+        c = _mm256_sub_epi64(c, _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(v + i)), k));
+    }
+    _mm256_storeu_si256((__m256i *)lanes, c);
+    return (int)(lanes[0] + lanes[1] + lanes[2] + lanes[3]) + countscalar(v + i, n - i, key);
+}
+#endif
+
+/*
+ * Scans the list a run at a time, with the pointer kernels on plain lists
+ * and keyscan on record lists. how is 0 for the first match, 1 for the
+ * last and 2 for the count.
+ */
+static int search(struct _Array *a, void *key, size_t offset, size_t width, char how) {
+    const struct _Scanner *sc = scanner();
+    char *p = NULL;
+    int n = a->used_buckets;
+    int i = 0, j = 0, len = 0, c = 0;
+    
+    migrate(a, n);
+    if (how == 1) {
+        for (i = n; i > 0; i -= len) {
+            len = runbefore(a, i, &p);
+            j = a->record?keyscan(p, len, a->elemsize, key, offset, width, 1)
+                :sc->last((void **)p, len, key);
+            if (j >= 0) {
+                return i - len + j;
+            }
+        }
+        return -1;
+    }
+    for (i = 0; i < n; i += len) {
+        len = runat(a, i, &p);
+        len = (len < n - i)?len:n - i;
+        if (how == 2) {
+            c += a->record?keyscan(p, len, a->elemsize, key, offset, width, 2)
+                :sc->count((void **)p, len, key);
+        } else {
+            j = a->record?keyscan(p, len, a->elemsize, key, offset, width, 0)
+                :sc->first((void **)p, len, key);
+            if (j >= 0) {
+                return i + j;
+            }
+        }
+    }
+    return (how == 2)?c:-1;
+}
+
+/*
+ * Scans n records of es bytes at base for the width bytes at offset.
+ * Common key widths compare with one load instead of a memcmp call.
+ */
+static int keyscan(char *base, int n, size_t es, void *key, size_t offset, size_t width, char how) {
+    char *p = NULL;
+    int i = 0, c = 0, hit = 0;
+    unsigned long long k = 0, x = 0;
+    
+    if ((width == 1) || (width == 2) || (width == 4) || (width == 8)) {
+        memcpy(&k, key, width);
+    }
+    for (i = 0; i < n; i++) {
+        p = base + es*((how == 1)?n - 1 - i:i) + offset;
+        switch (width) {
+            case 1: case 2: case 4: case 8:
+                x = 0;
+                memcpy(&x, p, width);
+                hit = (x == k);
+                break;
+            default:
+                hit = (memcmp(p, key, width) == 0);
+                break;
+        }
+        if (hit) {
+            if (how == 0) {
+                return i;
+            } else if (how == 1) {
+                return n - 1 - i;
+            }
+            c++;
+        }
+    }
+    return (how == 2)?c:-1;
+}
+
+/*
+ * Sorts a contiguous buffer, in parallel above A_SORTCUTOFF, with scratch
+ * space from the list's allocator. Returns 0, or -1 when it runs out.
+ */
+static int sortbuffer(struct _Array *a, struct _Sorter *s, char *buf, int n) {
+    struct _MergeSort m;
+    char *tmp = NULL;
+    int depth = 0;
+    
+    if (n <= A_SORTCUTOFF) {
+        for (depth = 1; (1 << depth) < n; depth++);
+        introsort(s, buf, n, 2*depth);
+        return 0;
+    }
+    if ((tmp = allocate(a, s->es*n)) == NULL) {
+        return nomem(a);
+    }
+    m.s = s;
+    m.src = buf;
+    m.dst = tmp;
+    m.n = n;
+    m.intodst = 0;
+    msort(&m);
+    release(a, tmp, s->es*n);
+    return 0;
+}
+
+static void dumpstats(int handler, void *entry, void *f) {
+    struct _Array *a = entry;
+#if defined(MOUSTASHED_STATS)
+    fprintf(f, "ArrayList %d: size %d, capacity %d, reallocs %lu, bytes %lu, peak %lu, shifted %lu, steps %lu\n",
+            handler, a->used_buckets, a->total_buckets, a->stats.reallocs,
+            (unsigned long)a->stats.bytes, (unsigned long)a->stats.peak,
+            a->stats.shifted, a->stats.steps);
+#else
+    fprintf(f, "ArrayList %d: size %d, capacity %d\n", handler, a->used_buckets, a->total_buckets);
+#endif
+}
+
+#if defined(MOUSTASHED_STATS)
+static void allocated(struct _Array *a, size_t from, size_t to) {
+    a->stats.bytes += to - from;
+    if (a->stats.bytes > a->stats.peak) {
+        a->stats.peak = a->stats.bytes;
+    }
+}
+#endif
+
+#if !defined(__GNUC__)
+static void *exchange(void **p, void *x) {
+    void *old = *p;
+    
+    *p = x;
+    return old;
+}
+#endif
@@ -31,31 +31,90 @@
 #ifndef moustached_arraylist_h
 #define moustached_arraylist_h
 
+#include <stddef.h>
+#include <stdio.h>
+
 #define A_EXPRATE 2
 #define A_LOADFACT 0.75
 
+#define A_GROWDEFAULT 0
+#define A_GROWFACTOR 1
+#define A_GROWADD 2
+#define A_GROWCALLBACK 3
+
 #if !defined(MOUSTASHED_ITERATOR)
 #define MOUSTASHED_ITERATOR
 struct _Iterator {
     int handler;
     int carriage;
     int total_elems;
+    unsigned int modcount;
     
     char hasnext;
     char hasprev;
     
+    void *cursor;
+    void *last;
+    int offset;
+    
     void (*update)(struct _Iterator*);
     void (*reset)(struct _Iterator*);
     void *(*next)(struct _Iterator*);
     void *(*prev)(struct _Iterator*);
+    void *(*remove)(struct _Iterator*);
+    void *(*insert)(struct _Iterator*, void*);
 };
 typedef struct _Iterator iterator;
 #endif
 
+#if !defined(MOUSTASHED_STATS_T)
+#define MOUSTASHED_STATS_T
+struct _Stats {
+    unsigned long reallocs;
+    size_t bytes;
+    size_t peak;
+    unsigned long shifted;
+    unsigned long walked;
+    unsigned long steps;
+};
+typedef struct _Stats stats;
+#endif
+
+#if !defined(MOUSTASHED_ALLOCATOR)
+#define MOUSTASHED_ALLOCATOR
+struct _Allocator {
+    void *(*alloc)(size_t, void*);
+    void *(*resize)(void*, size_t, size_t, void*);
+    void (*release)(void*, size_t, void*);
+    void *ctx;
+};
+typedef struct _Allocator allocator;
+#endif
+
+#if !defined(MOUSTASHED_COMPARATOR)
+#define MOUSTASHED_COMPARATOR
+typedef int (*comparator)(const void*, const void*);
+#endif
+
+#if !defined(MOUSTASHED_SERIALIZER)
+#define MOUSTASHED_SERIALIZER
+typedef int (*serializer)(void*, FILE*, void*);
+typedef int (*deserializer)(FILE*, void**, void*);
+#endif
+
 typedef int ArrayList;
+typedef struct _View view;
+typedef int (*growpolicy)(int, int, void*);
+typedef void (*visitor)(void*, void*);
+typedef void *(*mapper)(void*, void*);
+typedef void *(*reducer)(void*, void*, void*);
 
 
 ArrayList ALnew(int);
+ArrayList ALnewsized(int, size_t);
+ArrayList ALnewsegmented(int, size_t);
+ArrayList ALnewconcurrent(int, size_t);
+ArrayList ALnewwith(int, size_t, const allocator*);
 void ALpurge(ArrayList);
 void ALdispose(ArrayList);
 
@@ -64,8 +123,56 @@ void *ALget(ArrayList, int);
 void *ALset(ArrayList, int, void*);
 void *ALremove(ArrayList, int);
 
+void *ALpushfront(ArrayList, void*);
+void *ALpushback(ArrayList, void*);
+void *ALpopfront(ArrayList);
+void *ALpopback(ArrayList);
+
+int ALgrowbyfactor(ArrayList, double);
+int ALgrowbyamount(ArrayList, int);
+int ALgrowwith(ArrayList, growpolicy, void*);
+int ALgrowincrementally(ArrayList, int);
+int ALreserve(ArrayList, int);
+int ALshrinktofit(ArrayList);
+int ALcapacity(ArrayList);
+
+int ALaddall(ArrayList, void**, int);
+int ALinsertrange(ArrayList, int, void**, int);
+int ALremoverange(ArrayList, int, int);
+
 int ALsize(ArrayList);
 void** ALtoarray(ArrayList);
+
+void ALsort(ArrayList, comparator);
+int ALbsearch(ArrayList, void*, comparator);
+int ALlowerbound(ArrayList, void*, comparator);
+
+int ALindexof(ArrayList, void*);
+int ALlastindexof(ArrayList, void*);
+int ALcontains(ArrayList, void*);
+int ALcount(ArrayList, void*);
+int ALindexofkey(ArrayList, void*, size_t, size_t);
+int ALcountkey(ArrayList, void*, size_t, size_t);
+
+void ALforeach(ArrayList, visitor, void*);
+ArrayList ALmap(ArrayList, mapper, void*);
+void *ALreduce(ArrayList, reducer, reducer, void*, void*);
+
+int ALsave(ArrayList, const char*, serializer, void*);
+ArrayList ALload(const char*, deserializer, visitor, void*);
+ArrayList ALloadmapped(const char*);
+
+int ALstats(ArrayList, stats*);
+void ALdumpstats(FILE*);
+
 iterator ALiterator(ArrayList);
+int ALnextbatch(iterator*, void**, int);
+void *ALnextspan(iterator*, int*);
+
+int ALpublish(ArrayList);
+view *ALsnapshot(ArrayList);
+int ALviewsize(view*);
+void *ALviewget(view*, int);
+void ALviewrelease(view*);
 
 #endif
@@ -0,0 +1,337 @@
+/**
+ *  @file   controller.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Thread-safe handle table shared by the containers
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "controller.h"
+
+#ifndef MOUSTASHED_ERROR_STRINGS
+#define MOUSTASHED_ERROR_STRINGS
+#define S_NOMEM "Allocating memory"
+#define S_EFAULT "Invalid handler"
+#endif
+
+#if defined(__GNUC__)
+#define CT_LOADSEG(ct, k) __atomic_load_n(&(ct)->segments[k], __ATOMIC_ACQUIRE)
+#define CT_STORESEG(ct, k, s) __atomic_store_n(&(ct)->segments[k], (s), __ATOMIC_RELEASE)
+#define CT_LOAD(v) __atomic_load_n(&(v), __ATOMIC_ACQUIRE)
+#define CT_STORE(v, x) __atomic_store_n(&(v), (x), __ATOMIC_RELEASE)
+#else
+#define CT_LOADSEG(ct, k) ((ct)->segments[k])
+#define CT_STORESEG(ct, k, s) ((ct)->segments[k] = (s))
+#define CT_LOAD(v) (v)
+#define CT_STORE(v, x) ((v) = (x))
+#endif
+
+/**
+ * Static-scope functions declaration
+ *
+ */
+static int segmentof(int, int *);
+static struct _Slot *slotat(char *, struct _Controller *, int);
+static int newsegment(struct _Controller *);
+static void shrink(struct _Controller *);
+
+
+/**
+ * Functions definition
+ *
+ */
+
+/*
+ * Pops a slot from the free stack of the lowest segment that has one,
+ * so that trailing segments drain and can be released. The entry is
+ * zeroed and handed back locked, so the caller can initialise it before
+ * releasing. Returns -1 with *entry NULL when every handle is taken,
+ * errno set to EAGAIN, or a new segment cannot be allocated, ENOMEM.
+ */
+int CTclaim(struct _Controller *ct, void **entry) {
+    int k = 0;
+    int off = 0;
+    struct _Slot *slot = NULL;
+    
+    CT_LOCK(&ct->lock);
+    for (k = 0; k < ct->segments_used; k++) {
+        if (ct->freeslots[k] != 0) {
+            break;
+        }
+    }
+    if ((k == ct->segments_used) && (newsegment(ct) != 0)) {
+        CT_UNLOCK(&ct->lock);
+        *entry = NULL;
+        return -1;
+    }
+    off = ct->freeslots[k] - 1;
+    slot = slotat(ct->segments[k], ct, off);
+    ct->freeslots[k] = slot->nextfree;
+    ct->live[k]++;
+    ct->used_buckets++;
+    CT_UNLOCK(&ct->lock);
+    
+    CT_LOCK(&slot->lock);
+    CT_STORE(slot->used, 1);
+    *entry = (char *)slot + CT_HEADSIZE;
+    memset(*entry, 0, ct->slotsize - CT_HEADSIZE);
+    return (slot->generation << CT_INDEXBITS)
+        | ((CT_FIRSTSEGMENT << k) - CT_FIRSTSEGMENT + off);
+}
+
+/*
+ * Locks and returns the entry of a live handle, or returns NULL with
+ * errno set to EFAULT.
+ */
+void *CTacquire(struct _Controller *ct, int handler) {
+    int k = CT_MAXSEGMENTS;
+    int off = 0;
+    char *seg = NULL;
+    struct _Slot *slot = NULL;
+    
+    if (handler >= 0) {
+        k = segmentof(handler & CT_INDEXMASK, &off);
+    }
+    if (k < CT_MAXSEGMENTS) {
+        seg = CT_LOADSEG(ct, k);
+    }
+    if (seg == NULL) {
+        errno = EFAULT;
+        return NULL;
+    }
+    slot = slotat(seg, ct, off);
+    CT_LOCK(&slot->lock);
+    if (!slot->used || (slot->generation != (handler >> CT_INDEXBITS))) {
+        CT_UNLOCK(&slot->lock);
+        errno = EFAULT;
+        return NULL;
+    }
+    return (char *)slot + CT_HEADSIZE;
+}
+
+/*
+ * Returns the entry of a live handle without locking it, or NULL with
+ * errno set to EFAULT. The handle may be disposed right after, so only
+ * fields the container publishes atomically may be read from it.
+ */
+void *CTpeek(struct _Controller *ct, int handler) {
+    int k = CT_MAXSEGMENTS;
+    int off = 0;
+    char *seg = NULL;
+    struct _Slot *slot = NULL;
+    
+    if (handler >= 0) {
+        k = segmentof(handler & CT_INDEXMASK, &off);
+    }
+    if (k < CT_MAXSEGMENTS) {
+        seg = CT_LOADSEG(ct, k);
+    }
+    if (seg != NULL) {
+        slot = slotat(seg, ct, off);
+        if (CT_LOAD(slot->used) && (CT_LOAD(slot->generation) == (handler >> CT_INDEXBITS))) {
+            return (char *)slot + CT_HEADSIZE;
+        }
+    }
+    errno = EFAULT;
+    return NULL;
+}
+
+void CTrelease(void *entry) {
+    struct _Slot *slot = (struct _Slot *)((char *)entry - CT_HEADSIZE);
+    CT_UNLOCK(&slot->lock);
+}
+
+/*
+ * Frees the slot of an acquired entry and releases it. The generation is
+ * bumped before the slot goes back on its free stack.
+ */
+void CTdispose(struct _Controller *ct, void *entry) {
+    struct _Slot *slot = (struct _Slot *)((char *)entry - CT_HEADSIZE);
+    int k = 0;
+    int off = 0;
+    
+    CT_STORE(slot->used, 0);
+    CT_STORE(slot->generation, (slot->generation + 1) & CT_GENMASK);
+    CT_UNLOCK(&slot->lock);
+    
+    CT_LOCK(&ct->lock);
+    for (k = 0; k < ct->segments_used; k++) {
+        if (((char *)slot >= ct->segments[k])
+            && ((char *)slot < ct->segments[k] + ct->slotsize*(CT_FIRSTSEGMENT << k))) {
+            break;
+        }
+    }
+    off = (int)(((char *)slot - ct->segments[k]) / ct->slotsize);
+    slot->nextfree = ct->freeslots[k];
+    ct->freeslots[k] = off + 1;
+    ct->live[k]--;
+    ct->used_buckets--;
+    shrink(ct);
+    CT_UNLOCK(&ct->lock);
+}
+
+/*
+ * Calls visit on every live handle with its entry locked. The controller
+ * lock is only taken to pin the segments, so handles may come and go
+ * meanwhile and visit may use other controllers, but not this one.
+ */
+void CTforeach(struct _Controller *ct, void (*visit)(int, void *, void *), void *ctx) {
+    int segments = 0;
+    int k = 0;
+    int off = 0;
+    struct _Slot *slot = NULL;
+    
+    CT_LOCK(&ct->lock);
+    ct->walkers++;
+    segments = ct->segments_used;
+    CT_UNLOCK(&ct->lock);
+    
+    for (k = 0; k < segments; k++) {
+        for (off = 0; off < (CT_FIRSTSEGMENT << k); off++) {
+            slot = slotat(CT_LOADSEG(ct, k), ct, off);
+            CT_LOCK(&slot->lock);
+            if (slot->used) {
+                visit((slot->generation << CT_INDEXBITS)
+                      | ((CT_FIRSTSEGMENT << k) - CT_FIRSTSEGMENT + off),
+                      (char *)slot + CT_HEADSIZE, ctx);
+            }
+            CT_UNLOCK(&slot->lock);
+        }
+    }
+    
+    CT_LOCK(&ct->lock);
+    ct->walkers--;
+    shrink(ct);
+    CT_UNLOCK(&ct->lock);
+}
+
+
+/**
+ * Static-scope functions definition
+ *
+ */
+
+/*
+ * Segment k starts at index CT_FIRSTSEGMENT * (2^k - 1).
+ */
+static int segmentof(int index, int *off) {
+    unsigned int v = ((unsigned int)index >> CT_FIRSTSHIFT) + 1;
+    int k = 0;
+#if defined(__GNUC__)
+    k = (int)(sizeof(unsigned int)*8) - 1 - __builtin_clz(v);
+#else
+    while (v >>= 1) {
+        k++;
+    }
+#endif
+    *off = index - ((CT_FIRSTSEGMENT << k) - CT_FIRSTSEGMENT);
+    return k;
+}
+
+static struct _Slot *slotat(char *seg, struct _Controller *ct, int off) {
+    return (struct _Slot *)(seg + ct->slotsize*off);
+}
+
+/*
+ * Called with the controller lock held. Slots are cache-line aligned so
+ * that the locks of neighbouring handles never share a line. A segment
+ * that was released before starts its slots past every generation it
+ * handed out, so handles from its previous lives keep failing the
+ * generation check. Returns 0, or -1 with errno set to EAGAIN when the
+ * table is full and ENOMEM when the segment cannot be allocated.
+ */
+static int newsegment(struct _Controller *ct) {
+    char *seg = NULL;
+    struct _Slot *slot = NULL;
+    int k = ct->segments_used;
+    int i = 0;
+    
+    if (k == CT_MAXSEGMENTS) {
+        errno = EAGAIN;
+        return -1;
+    }
+    if (posix_memalign((void **)&seg, CT_CACHELINE, ct->slotsize*(CT_FIRSTSEGMENT << k)) != 0) {
+        errno = ENOMEM;
+        return -1;
+    }
+    for (i = (CT_FIRSTSEGMENT << k) - 1; i >= 0; i--) {
+        slot = slotat(seg, ct, i);
+#if !defined(MOUSTASHED_NOTHREADS)
+        pthread_mutex_init(&slot->lock, NULL);
+#endif
+        slot->used = 0;
+        slot->generation = ct->generations[k];
+        slot->nextfree = (i < (CT_FIRSTSEGMENT << k) - 1)?i + 2:0;
+    }
+    ct->freeslots[k] = 1;
+    ct->live[k] = 0;
+    ct->total_buckets += CT_FIRSTSEGMENT << k;
+    ct->segments_used++;
+    CT_STORESEG(ct, k, seg);
+    return 0;
+}
+
+/*
+ * Called with the controller lock held. Releases trailing segments that
+ * hold no live handle once the table is at most a quarter full and
+ * nobody is walking it. The first segment is always kept. Every slot
+ * generation is at most one past the last it handed out, so the
+ * furthest one ahead of the seed becomes the seed of the next life.
+ */
+static void shrink(struct _Controller *ct) {
+    char *seg = NULL;
+    int k = ct->segments_used - 1;
+    int i = 0;
+    int ahead = 0;
+    int most = 0;
+    
+    while ((k > 0) && (ct->walkers == 0) && (ct->live[k] == 0)
+           && (ct->used_buckets <= (ct->total_buckets >> 2))) {
+        seg = ct->segments[k];
+        CT_STORESEG(ct, k, NULL);
+        most = 0;
+        for (i = 0; i < (CT_FIRSTSEGMENT << k); i++) {
+            ahead = (slotat(seg, ct, i)->generation - ct->generations[k]) & CT_GENMASK;
+            most = (ahead > most)?ahead:most;
+#if !defined(MOUSTASHED_NOTHREADS)
+            pthread_mutex_destroy(&slotat(seg, ct, i)->lock);
+#endif
+        }
+        free(seg);
+        ct->freeslots[k] = 0;
+        ct->total_buckets -= CT_FIRSTSEGMENT << k;
+        ct->segments_used--;
+        ct->generations[k] = (ct->generations[k] + most) & CT_GENMASK;
+        k--;
+    }
+}
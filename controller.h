@@ -0,0 +1,118 @@
+/**
+ *  @file   controller.h
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Thread-safe handle table shared by the containers
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Every container keeps one static controller. Handles index into a
+ *  table of segments, segment k holding CT_FIRSTSEGMENT << k slots, so
+ *  growing the table never moves existing entries. Each slot carries its
+ *  own lock: creating or disposing a handle only takes the controller
+ *  lock and never blocks operations on other handles.
+ *
+ *  A handle packs the slot index in its low CT_INDEXBITS bits and the
+ *  slot generation above them. Disposing bumps the generation, so stale
+ *  handles are rejected until their slot has been disposed CT_GENMASK + 1
+ *  more times. Free slots are reused last in, first out, so the wide
+ *  generation is what keeps a slot cycled in a loop safe; it caps every
+ *  container at 65504 live handles, past which CTclaim fails with
+ *  EAGAIN and so does every constructor. Using a stale handle while the
+ *  controller is shrinking is undefined, as is any use after dispose.
+ *
+ *  Define MOUSTASHED_NOTHREADS to compile every lock out.
+ */
+#ifndef moustached_controller_h
+#define moustached_controller_h
+
+#include <stddef.h>
+#if !defined(MOUSTASHED_NOTHREADS)
+#include <pthread.h>
+#endif
+
+#define CT_FIRSTSHIFT 5
+#define CT_FIRSTSEGMENT (1 << CT_FIRSTSHIFT)
+#define CT_INDEXBITS 16
+#define CT_INDEXMASK ((1 << CT_INDEXBITS) - 1)
+#define CT_GENMASK ((1 << (31 - CT_INDEXBITS)) - 1)
+#define CT_MAXSEGMENTS (CT_INDEXBITS - CT_FIRSTSHIFT)
+#define CT_CACHELINE 64
+
+#if !defined(MOUSTASHED_NOTHREADS)
+#define CT_MUTEX pthread_mutex_t
+#define CT_MUTEX_INITIALIZER PTHREAD_MUTEX_INITIALIZER
+#define CT_LOCK(m) pthread_mutex_lock(m)
+#define CT_UNLOCK(m) pthread_mutex_unlock(m)
+#else
+#define CT_MUTEX char
+#define CT_MUTEX_INITIALIZER 0
+#define CT_LOCK(m) ((void)(m))
+#define CT_UNLOCK(m) ((void)(m))
+#endif
+
+/*
+ * used and generation are written under the slot lock and tell whether a
+ * handle is live, nextfree is guarded by the controller lock and links
+ * the slot into its segment's free stack. The two locks are never held
+ * together.
+ */
+struct _Slot {
+    CT_MUTEX lock;
+    int generation;
+    int nextfree;
+    char used;
+};
+
+#define CT_HEADSIZE ((sizeof(struct _Slot) + 15) & ~(size_t)15)
+#define CT_SLOTSIZE(type) ((CT_HEADSIZE + sizeof(type) + CT_CACHELINE - 1) & ~(size_t)(CT_CACHELINE - 1))
+
+/*
+ * Free stacks hold slot offsets plus one, zero meaning empty. Segments
+ * are not released while walkers is non-zero. generations outlives its
+ * segment and seeds the slots when it is created again.
+ */
+struct _Controller {
+    size_t slotsize;
+    CT_MUTEX lock;
+    int used_buckets;
+    int total_buckets;
+    int segments_used;
+    int walkers;
+    int freeslots[CT_MAXSEGMENTS];
+    int live[CT_MAXSEGMENTS];
+    int generations[CT_MAXSEGMENTS];
+    char *segments[CT_MAXSEGMENTS];
+};
+
+#define CT_INITIALIZER(type) { CT_SLOTSIZE(type), CT_MUTEX_INITIALIZER, 0, 0, 0, 0, {0}, {0}, {0}, {NULL} }
+
+int CTclaim(struct _Controller *, void **);
+void *CTacquire(struct _Controller *, int);
+void *CTpeek(struct _Controller *, int);
+void CTrelease(void *);
+void CTdispose(struct _Controller *, void *);
+void CTforeach(struct _Controller *, void (*)(int, void *, void *), void *);
+
+#endif
@@ -0,0 +1,241 @@
+/**
+ *  @file   deque.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Lock-free work-stealing deque
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+
+#include "deque.h"
+#include "controller.h"
+#include "epoch.h"
+
+#ifndef MOUSTASHED_ERROR_STRINGS
+#define MOUSTASHED_ERROR_STRINGS
+#define S_NOMEM "Allocating memory"
+#define S_EFAULT "Invalid handler"
+#endif
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Ring {
+    long mask;
+    void **slots;
+};
+
+/*
+ * Indices only grow and slots wrap around the ring. ring is only
+ * replaced by the owner.
+ */
+struct _Deque {
+    struct _Ring *ring;
+    char pad1[CT_CACHELINE];
+    long top;
+    char pad2[CT_CACHELINE - sizeof(long)];
+    long bottom;
+    char pad3[CT_CACHELINE - sizeof(long)];
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static struct _Controller controller = CT_INITIALIZER(struct _Deque);
+
+/**
+ * Static-scope functions declaration
+ *
+ */
+static struct _Ring *newring(long);
+static struct _Ring *grow(struct _Deque *, struct _Ring *, long, long);
+
+
+/**
+ * Functions definition
+ *
+ */
+Deque DQnew(int capacity) {
+    struct _Deque *d = NULL;
+    long size = DQ_MINCAPACITY;
+    int handler = -1;
+    
+    while (size < capacity) {
+        size <<= 1;
+    }
+    if ((handler = CTclaim(&controller, (void **)&d)) < 0) {
+        return -1;
+    }
+    d->ring = newring(size);
+    CTrelease(d);
+    return handler;
+}
+
+void DQdispose(Deque handler) {
+    struct _Deque *d;
+    
+    if ((d = CTacquire(&controller, handler)) != NULL) {
+        free(d->ring);
+        d->ring = NULL;
+        CTdispose(&controller, d);
+    }
+}
+
+/*
+ * Owner only. Returns 0, or -1 with errno set.
+ */
+int DQpush(Deque handler, void *elem) {
+    struct _Deque *d = CTpeek(&controller, handler);
+    struct _Ring *r = NULL;
+    long b = 0, t = 0;
+    
+    if (d == NULL) {
+        return -1;
+    }
+    if (elem == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+    t = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    r = __atomic_load_n(&d->ring, __ATOMIC_RELAXED);
+    if (b - t > r->mask) {
+        r = grow(d, r, t, b);
+    }
+    __atomic_store_n(&r->slots[b & r->mask], elem, __ATOMIC_RELAXED);
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+/*
+ * Owner only. The last element pushed, or NULL when empty.
+ */
+void *DQpop(Deque handler) {
+    struct _Deque *d = CTpeek(&controller, handler);
+    struct _Ring *r = NULL;
+    void *elem = NULL;
+    long b = 0, t = 0;
+    
+    if (d == NULL) {
+        return NULL;
+    }
+    r = __atomic_load_n(&d->ring, __ATOMIC_RELAXED);
+    b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+    __atomic_store_n(&d->bottom, b, __ATOMIC_SEQ_CST);
+    t = __atomic_load_n(&d->top, __ATOMIC_SEQ_CST);
+    if (t <= b) {
+        elem = __atomic_load_n(&r->slots[b & r->mask], __ATOMIC_RELAXED);
+        if (t == b) {
+            if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, 0,
+                                             __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                elem = NULL;
+            }
+            __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+        }
+    } else {
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return elem;
+}
+
+/*
+ * Any thread. The oldest element, or NULL when empty or when another
+ * thread took it first.
+ */
+void *DQsteal(Deque handler) {
+    struct _Deque *d = CTpeek(&controller, handler);
+    struct _Ring *r = NULL;
+    void *elem = NULL;
+    long b = 0, t = 0;
+    
+    if (d == NULL) {
+        return NULL;
+    }
+    EPenter();
+    t = __atomic_load_n(&d->top, __ATOMIC_SEQ_CST);
+    b = __atomic_load_n(&d->bottom, __ATOMIC_SEQ_CST);
+    if (t < b) {
+        r = __atomic_load_n(&d->ring, __ATOMIC_ACQUIRE);
+        elem = __atomic_load_n(&r->slots[t & r->mask], __ATOMIC_RELAXED);
+        if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, 0,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            elem = NULL;
+        }
+    }
+    EPexit();
+    return elem;
+}
+
+/*
+ * Only a hint while other threads use the deque.
+ */
+int DQsize(Deque handler) {
+    struct _Deque *d = CTpeek(&controller, handler);
+    long size = 0;
+    
+    if (d == NULL) {
+        return -1;
+    }
+    size = __atomic_load_n(&d->bottom, __ATOMIC_ACQUIRE) - __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    return (size > 0)?(int)size:0;
+}
+
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static struct _Ring *newring(long size) {
+    struct _Ring *r = malloc(sizeof(struct _Ring) + sizeof(void *)*size);
+    
+    if (r == NULL) {
+        perror(S_NOMEM);
+        exit(EXIT_FAILURE);
+    }
+    r->mask = size - 1;
+    r->slots = (void **)(r + 1);
+    return r;
+}
+
+/*
+ * Copies the live range [t, b) into a ring twice the size. Thieves that
+ * loaded the old ring still find their elements at the same indices.
+ */
+static struct _Ring *grow(struct _Deque *d, struct _Ring *r, long t, long b) {
+    struct _Ring *bigger = newring((r->mask + 1)*2);
+    long i = 0;
+    
+    for (i = t; i < b; i++) {
+        bigger->slots[i & bigger->mask] = __atomic_load_n(&r->slots[i & r->mask], __ATOMIC_RELAXED);
+    }
+    __atomic_store_n(&d->ring, bigger, __ATOMIC_RELEASE);
+    EPretire(r, free);
+    return bigger;
+}
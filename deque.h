@@ -0,0 +1,56 @@
+/**
+ *  @file   deque.h
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Lock-free work-stealing deque
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  A Chase-Lev deque. One thread, its owner, pushes and pops at the
+ *  bottom, last in first out, while any other thread steals from the
+ *  top, first in first out, without a lock. The ring doubles when the
+ *  owner pushes onto a full one; the old ring is left to the epoch
+ *  collector as thieves may still be reading it. NULL cannot be pushed,
+ *  it is what pop and steal return when there is nothing to take. A
+ *  steal that loses a race also returns NULL. Dispose a deque only once
+ *  no thread uses it anymore.
+ */
+#ifndef moustached_deque_h
+#define moustached_deque_h
+
+#define DQ_MINCAPACITY 16
+
+typedef int Deque;
+
+
+Deque DQnew(int);
+void DQdispose(Deque);
+
+int DQpush(Deque, void*);
+void *DQpop(Deque);
+void *DQsteal(Deque);
+
+int DQsize(Deque);
+
+#endif
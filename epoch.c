@@ -0,0 +1,283 @@
+/**
+ *  @file   epoch.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Epoch-based reclamation for lock-free readers
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#if !defined(MOUSTASHED_NOTHREADS)
+#include <pthread.h>
+#endif
+
+#include "epoch.h"
+
+#ifndef MOUSTASHED_ERROR_STRINGS
+#define MOUSTASHED_ERROR_STRINGS
+#define S_NOMEM "Allocating memory"
+#define S_EFAULT "Invalid handler"
+#endif
+
+#if !defined(MOUSTASHED_NOTHREADS)
+
+/**
+ * Struct and Type definitions
+ *
+ */
+/*
+ * One per registered thread, each on its own cache line. epoch is the
+ * global epoch the thread saw when it entered its current section. The
+ * shared record counts in active the threads inside a section, and its
+ * epoch is the one the first of them saw.
+ */
+struct _Record {
+    int used;
+    int active;
+    unsigned int epoch;
+    char pad[64 - 3*sizeof(int)];
+};
+
+struct _Retired {
+    void *p;
+    void (*destroy)(void *);
+    unsigned int epoch;
+    struct _Retired *next;
+};
+
+/*
+ * Memory retired in epoch e is freed once the global epoch reaches
+ * e + 2: by then every thread has left the sections that were open
+ * when it was retired.
+ */
+struct _Epochs {
+    unsigned int global;
+    pthread_mutex_t lock;
+    pthread_once_t once;
+    pthread_key_t key;
+    int pending;
+    struct _Retired *limbo;
+    struct _Record shared;
+    struct _Record records[EP_MAXTHREADS];
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static struct _Epochs epochs = {
+    0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_ONCE_INIT, 0, 0, NULL,
+    {1, 0, 0, {0}}, {{0, 0, 0, {0}}}
+};
+static __thread struct _Record *self = NULL;
+static __thread int nest = 0;
+
+/**
+ * Static-scope functions declaration
+ *
+ */
+static void makekey(void);
+static void unregister(void *);
+static struct _Record *record(void);
+static int lagging(struct _Record *, unsigned int);
+static void collect(void);
+
+
+/**
+ * Functions definition
+ *
+ */
+void EPenter(void) {
+    struct _Record *r = (self != NULL)?self:record();
+    
+    if (nest++ > 0) {
+        return;
+    }
+    if (r == &epochs.shared) {
+        pthread_mutex_lock(&epochs.lock);
+        if (r->active == 0) {
+            __atomic_store_n(&r->epoch, __atomic_load_n(&epochs.global, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+        }
+        __atomic_store_n(&r->active, r->active + 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&epochs.lock);
+        return;
+    }
+    __atomic_store_n(&r->epoch, __atomic_load_n(&epochs.global, __ATOMIC_SEQ_CST), __ATOMIC_SEQ_CST);
+    __atomic_store_n(&r->active, 1, __ATOMIC_SEQ_CST);
+}
+
+void EPexit(void) {
+    if (--nest > 0) {
+        return;
+    }
+    if (self == &epochs.shared) {
+        pthread_mutex_lock(&epochs.lock);
+        __atomic_store_n(&self->active, self->active - 1, __ATOMIC_SEQ_CST);
+        pthread_mutex_unlock(&epochs.lock);
+        return;
+    }
+    __atomic_store_n(&self->active, 0, __ATOMIC_SEQ_CST);
+}
+
+/*
+ * Queues p for destroy. Every EP_BATCH retirements the epoch is moved on
+ * if it can be and whatever has become safe is destroyed, by the calling
+ * thread.
+ */
+void EPretire(void *p, void (*destroy)(void *)) {
+    struct _Retired *r = malloc(sizeof(struct _Retired));
+    
+    if (r == NULL) {
+        perror(S_NOMEM);
+        exit(EXIT_FAILURE);
+    }
+    r->p = p;
+    r->destroy = destroy;
+    pthread_mutex_lock(&epochs.lock);
+    r->epoch = __atomic_load_n(&epochs.global, __ATOMIC_SEQ_CST);
+    r->next = epochs.limbo;
+    epochs.limbo = r;
+    if (++epochs.pending >= EP_BATCH) {
+        collect();
+    }
+    pthread_mutex_unlock(&epochs.lock);
+}
+
+/*
+ * Moves the epoch on as far as it can and destroys what has become safe,
+ * without waiting for a batch to fill up. When no thread is inside a
+ * section, everything retired so far is destroyed.
+ */
+void EPcollect(void) {
+    pthread_mutex_lock(&epochs.lock);
+    collect();
+    pthread_mutex_unlock(&epochs.lock);
+}
+
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void makekey(void) {
+    pthread_key_create(&epochs.key, unregister);
+}
+
+/*
+ * A thread leaving gives back its record and collects, as it may have
+ * been the one holding the epoch back.
+ */
+static void unregister(void *r) {
+    __atomic_store_n(&((struct _Record *)r)->used, 0, __ATOMIC_SEQ_CST);
+    self = NULL;
+    EPcollect();
+}
+
+/*
+ * Claims a free record for the calling thread, or the shared one for
+ * good when every record is taken. The shared record is never given
+ * back.
+ */
+static struct _Record *record(void) {
+    int i = 0;
+    int expected = 0;
+    
+    pthread_once(&epochs.once, makekey);
+    for (i = 0; i < EP_MAXTHREADS; i++) {
+        expected = 0;
+        if (__atomic_compare_exchange_n(&epochs.records[i].used, &expected, 1, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            self = &epochs.records[i];
+            pthread_setspecific(epochs.key, self);
+            return self;
+        }
+    }
+    self = &epochs.shared;
+    return self;
+}
+
+/*
+ * Whether r is inside a section opened before the global epoch.
+ */
+static int lagging(struct _Record *r, unsigned int global) {
+    return __atomic_load_n(&r->used, __ATOMIC_SEQ_CST)
+        && __atomic_load_n(&r->active, __ATOMIC_SEQ_CST)
+        && (__atomic_load_n(&r->epoch, __ATOMIC_SEQ_CST) != global);
+}
+
+/*
+ * Called with the lock held. The epoch only moves on once every thread
+ * inside a section has seen the current one. It is moved up to twice,
+ * the most anything in limbo can need.
+ */
+static void collect(void) {
+    struct _Retired **link = &epochs.limbo;
+    struct _Retired *r = NULL;
+    unsigned int global = __atomic_load_n(&epochs.global, __ATOMIC_SEQ_CST);
+    int steps = 0;
+    int i = 0;
+    
+    for (steps = 0; (steps < 2) && (epochs.limbo != NULL); steps++) {
+        for (i = 0; i < EP_MAXTHREADS; i++) {
+            if (lagging(&epochs.records[i], global)) {
+                break;
+            }
+        }
+        if ((i < EP_MAXTHREADS) || lagging(&epochs.shared, global)) {
+            break;
+        }
+        global++;
+        __atomic_store_n(&epochs.global, global, __ATOMIC_SEQ_CST);
+    }
+    while ((r = *link) != NULL) {
+        if (global - r->epoch >= 2) {
+            *link = r->next;
+            r->destroy(r->p);
+            free(r);
+            epochs.pending--;
+        } else {
+            link = &r->next;
+        }
+    }
+}
+
+#else
+
+void EPenter(void) {
+}
+
+void EPexit(void) {
+}
+
+void EPretire(void *p, void (*destroy)(void *)) {
+    destroy(p);
+}
+
+void EPcollect(void) {
+}
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ *  @file   epoch.h
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Epoch-based reclamation for lock-free readers
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Readers bracket every access to shared memory with EPenter and
+ *  EPexit. Writers that unlink memory readers may still be looking at
+ *  hand it to EPretire, which frees it once every thread that was inside
+ *  a section at the time has left it. Sections nest, must be short and
+ *  must not block. Each thread takes one of EP_MAXTHREADS slots on its
+ *  first section and gives it back when it exits. Threads that find
+ *  every slot taken share one more, entered and left under the lock;
+ *  memory retired while any of them is inside a section waits until
+ *  they have all left at once.
+ *
+ *  Builds with MOUSTASHED_NOTHREADS free retired memory at once.
+ */
+#ifndef moustached_epoch_h
+#define moustached_epoch_h
+
+#define EP_MAXTHREADS 256
+#define EP_BATCH 64
+
+
+void EPenter(void);
+void EPexit(void);
+void EPretire(void *, void (*)(void *));
+void EPcollect(void);
+
+#endif
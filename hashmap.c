@@ -0,0 +1,757 @@
+/**
+ *  @file   hashmap.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Open addressing hash map and set
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "hashmap.h"
+#include "controller.h"
+
+#if defined(__GNUC__) && defined(__x86_64__) && !defined(MOUSTASHED_NOSIMD)
+#define HM_SIMD
+#include <emmintrin.h>
+#endif
+
+#ifndef MOUSTASHED_ERROR_STRINGS
+    #define MOUSTASHED_ERROR_STRINGS
+    #define S_NOMEM "Allocating memory"
+    #define S_EFAULT "Invalid handler"
+#endif
+
+#define HM_EMPTY 0x80
+#define HM_DELETED 0xFE
+#define HM_MINCAPACITY HM_GROUP
+#define HM_MAXCAPACITY (1 << 30)
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Entry {
+    void *key;
+    void *value;
+};
+
+/*
+ * A full slot's control byte is the low 7 bits of its hash, a free one
+ * HM_EMPTY or HM_DELETED. Lookups probe whole groups and stop at the
+ * first group with an empty slot, so removing from a group that has one
+ * can empty the slot, and a tombstone is only left otherwise. growthleft
+ * is how many empty slots may still fill before the table is over 7/8
+ * full, tombstones included.
+ */
+struct _Table {
+    unsigned char *ctrl;
+    struct _Entry *slots;
+    int capacity;
+    int used;
+    int growthleft;
+};
+
+/*
+ * While old has a table, the groups of it before moved are already in
+ * table and the rest still hold their entries. A key is only ever in one
+ * of the two.
+ */
+struct _Map {
+    struct _Table table;
+    struct _Table old;
+    int moved;
+    int used_buckets;
+    unsigned int modcount;
+    hasher hash;
+    equality eq;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static struct _Controller controller = CT_INITIALIZER(struct _Map);
+
+/**
+ * Static-scope functions declaration
+ *
+ */
+static struct _Map *acquire(int);
+static size_t hashof(struct _Map *, void *);
+static int equal(struct _Map *, void *, void *);
+static unsigned int match(const unsigned char *, unsigned char);
+static unsigned int matchempty(const unsigned char *);
+static unsigned int matchfree(const unsigned char *);
+static int first(unsigned int);
+static void newtable(struct _Table *, int);
+static int find(struct _Map *, struct _Table *, void *, size_t);
+static void place(struct _Table *, size_t, void *, void *);
+static void erase(struct _Table *, int);
+static void *put(struct _Map *, void *, void *, int *);
+static int removekey(struct _Map *, void *, void **);
+static void grow(struct _Map *);
+static void migrate(struct _Map *, int);
+static void *HMitnext(iterator *);
+static void *HMitprev(iterator *);
+static void *HMitremove(iterator *);
+static void HMupdateit(iterator *);
+static void HMresetit(iterator *);
+static struct _Map *acquireit(iterator *);
+static void updateit(iterator *, struct _Map *);
+
+
+/**
+ * Functions definition
+ *
+ */
+
+/*
+ * A map sized for init_size keys before it first grows.
+ */
+int HMnew(int init_size, hasher hash, equality eq) {
+    struct _Map *m = NULL;
+    int capacity = HM_MINCAPACITY;
+    int handler = -1;
+    
+    if (init_size > HM_MAXCAPACITY/8*7) {
+        errno = EINVAL;
+        return -1;
+    }
+    while (capacity/8*7 < init_size) {
+        capacity <<= 1;
+    }
+    if ((handler = CTclaim(&controller, (void **)&m)) < 0) {
+        return -1;
+    }
+    newtable(&m->table, capacity);
+    m->hash = hash;
+    m->eq = eq;
+    CTrelease(m);
+    return handler;
+}
+
+void HMpurge(int handler) {
+    struct _Map *m;
+    
+    if ((m = acquire(handler)) != NULL) {
+        if (m->old.ctrl != NULL) {
+            free(m->old.slots);
+            m->old.ctrl = NULL;
+        }
+        memset(m->table.ctrl, HM_EMPTY, m->table.capacity);
+        m->table.used = 0;
+        m->table.growthleft = m->table.capacity/8*7;
+        m->used_buckets = 0;
+        m->modcount++;
+        CTrelease(m);
+    }
+}
+
+void HMdispose(int handler) {
+    struct _Map *m;
+    
+    if ((m = acquire(handler)) != NULL) {
+        if (m->old.ctrl != NULL) {
+            free(m->old.slots);
+        }
+        free(m->table.slots);
+        CTdispose(&controller, m);
+    }
+}
+
+/*
+ * Maps key to value. Returns the value key had, or NULL if it had none.
+ */
+void *HMput(int handler, void *key, void *value) {
+    struct _Map *m;
+    void *prev = NULL;
+    
+    if ((m = acquire(handler)) != NULL) {
+        prev = put(m, key, value, NULL);
+        CTrelease(m);
+    }
+    return prev;
+}
+
+/*
+ * The value of key, or NULL if there is none. HMcontains tells a missing
+ * key from a NULL value.
+ */
+void *HMget(int handler, void *key) {
+    struct _Map *m;
+    void *value = NULL;
+    size_t h = 0;
+    int i = -1;
+    
+    if ((m = acquire(handler)) != NULL) {
+        h = hashof(m, key);
+        if ((i = find(m, &m->table, key, h)) >= 0) {
+            value = m->table.slots[i].value;
+        } else if ((m->old.ctrl != NULL) && ((i = find(m, &m->old, key, h)) >= 0)) {
+            value = m->old.slots[i].value;
+        }
+        CTrelease(m);
+    }
+    return value;
+}
+
+/*
+ * Returns the value key had, or NULL if there was no key.
+ */
+void *HMremove(int handler, void *key) {
+    struct _Map *m;
+    void *value = NULL;
+    
+    if ((m = acquire(handler)) != NULL) {
+        removekey(m, key, &value);
+        CTrelease(m);
+    }
+    return value;
+}
+
+int HMcontains(int handler, void *key) {
+    struct _Map *m;
+    int found = 0;
+    size_t h = 0;
+    
+    if ((m = acquire(handler)) != NULL) {
+        h = hashof(m, key);
+        found = (find(m, &m->table, key, h) >= 0)
+            || ((m->old.ctrl != NULL) && (find(m, &m->old, key, h) >= 0));
+        CTrelease(m);
+    }
+    return found;
+}
+
+int HMsize(int handler) {
+    struct _Map *m;
+    int size = -1;
+    
+    if ((m = acquire(handler)) != NULL) {
+        size = m->used_buckets;
+        CTrelease(m);
+    }
+    return size;
+}
+
+int HMcapacity(int handler) {
+    struct _Map *m;
+    int capacity = -1;
+    
+    if ((m = acquire(handler)) != NULL) {
+        capacity = m->table.capacity;
+        CTrelease(m);
+    }
+    return capacity;
+}
+
+iterator HMiterator(int handler) {
+    struct _Map *m;
+    iterator it;
+    
+    memset(&it, 0, sizeof(it));
+    it.handler = -1;
+    if ((m = acquire(handler)) != NULL) {
+        it.handler = handler;
+        it.next = HMitnext;
+        it.prev = HMitprev;
+        it.remove = HMitremove;
+        it.insert = NULL;
+        it.update = HMupdateit;
+        it.reset = HMresetit;
+        CTrelease(m);
+        it.reset(&it);
+    }
+    return it;
+}
+
+HashSet HSnew(int init_size, hasher hash, equality eq) {
+    return HMnew(init_size, hash, eq);
+}
+
+void HSpurge(HashSet handler) {
+    HMpurge(handler);
+}
+
+void HSdispose(HashSet handler) {
+    HMdispose(handler);
+}
+
+/*
+ * Returns 1 if key was added, 0 if it was already there, -1 on an
+ * invalid handler.
+ */
+int HSadd(HashSet handler, void *key) {
+    struct _Map *m;
+    int found = -1;
+    
+    if ((m = acquire(handler)) != NULL) {
+        put(m, key, key, &found);
+        CTrelease(m);
+        return !found;
+    }
+    return found;
+}
+
+/*
+ * Returns 1 if key was removed, 0 if it was not there.
+ */
+int HSremove(HashSet handler, void *key) {
+    struct _Map *m;
+    int removed = -1;
+    
+    if ((m = acquire(handler)) != NULL) {
+        removed = removekey(m, key, NULL);
+        CTrelease(m);
+    }
+    return removed;
+}
+
+int HScontains(HashSet handler, void *key) {
+    return HMcontains(handler, key);
+}
+
+int HSsize(HashSet handler) {
+    return HMsize(handler);
+}
+
+iterator HSiterator(HashSet handler) {
+    return HMiterator(handler);
+}
+
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static struct _Map *acquire(int handler) {
+    struct _Map *m = CTacquire(&controller, handler);
+    if (m == NULL) {
+        perror(S_EFAULT);
+    }
+    return m;
+}
+
+/*
+ * Every hash goes through a multiplicative mix, so addresses and other
+ * weak hashes still spread over the high bits picking the group.
+ */
+static size_t hashof(struct _Map *m, void *key) {
+    unsigned long long h = (m->hash != NULL)?(unsigned long long)m->hash(key):(unsigned long long)(size_t)key;
+    
+    h *= 0x9E3779B97F4A7C15ULL;
+    return (size_t)(h ^ (h >> 32));
+}
+
+static int equal(struct _Map *m, void *x, void *y) {
+    return (m->eq != NULL)?m->eq(x, y):(x == y);
+}
+
+/*
+ * Bit i of the result is set when byte i of the group is c.
+ */
+static unsigned int match(const unsigned char *g, unsigned char c) {
+#if defined(HM_SIMD)
+    __m128i v = _mm_loadu_si128((const __m128i *)g);
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8((char)c)));
+#else
+    unsigned int bits = 0;
+    int i = 0;
+    
+    for (i = 0; i < HM_GROUP; i++) {
+        bits |= (unsigned int)(g[i] == c) << i;
+    }
+    return bits;
+#endif
+}
+
+static unsigned int matchempty(const unsigned char *g) {
+    return match(g, HM_EMPTY);
+}
+
+/*
+ * Empty and deleted slots are the ones with the top bit set.
+ */
+static unsigned int matchfree(const unsigned char *g) {
+#if defined(HM_SIMD)
+    return (unsigned int)_mm_movemask_epi8(_mm_loadu_si128((const __m128i *)g));
+#else
+    unsigned int bits = 0;
+    int i = 0;
+    
+    for (i = 0; i < HM_GROUP; i++) {
+        bits |= (unsigned int)(g[i] >> 7) << i;
+    }
+    return bits;
+#endif
+}
+
+static int first(unsigned int bits) {
+#if defined(__GNUC__)
+    return __builtin_ctz(bits);
+#else
+    int i = 0;
+    
+    while (!(bits & 1)) {
+        bits >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+/*
+ * Control bytes and slots share one allocation.
+ */
+static void newtable(struct _Table *t, int capacity) {
+    t->slots = malloc((sizeof(struct _Entry) + 1)*(size_t)capacity);
+    if (t->slots == NULL) {
+        perror(S_NOMEM);
+        exit(EXIT_FAILURE);
+    }
+    t->ctrl = (unsigned char *)(t->slots + capacity);
+    memset(t->ctrl, HM_EMPTY, capacity);
+    t->capacity = capacity;
+    t->used = 0;
+    t->growthleft = capacity/8*7;
+}
+
+/*
+ * Groups are probed triangularly, which visits every one of them as
+ * their number is a power of two.
+ */
+static int find(struct _Map *m, struct _Table *t, void *key, size_t h) {
+    int mask = t->capacity/HM_GROUP - 1;
+    int g = (int)(h >> 7) & mask;
+    int step = 0;
+    unsigned int bits = 0;
+    int i = 0;
+    
+    for (;;) {
+        bits = match(t->ctrl + g*HM_GROUP, (unsigned char)(h & 0x7F));
+        while (bits != 0) {
+            i = g*HM_GROUP + first(bits);
+            if (equal(m, t->slots[i].key, key)) {
+                return i;
+            }
+            bits &= bits - 1;
+        }
+        if (matchempty(t->ctrl + g*HM_GROUP) != 0) {
+            return -1;
+        }
+        g = (g + ++step) & mask;
+    }
+}
+
+/*
+ * Stores a key known not to be in the table in the first free slot of
+ * its probe sequence.
+ */
+static void place(struct _Table *t, size_t h, void *key, void *value) {
+    int mask = t->capacity/HM_GROUP - 1;
+    int g = (int)(h >> 7) & mask;
+    int step = 0;
+    unsigned int bits = 0;
+    int i = 0;
+    
+    while ((bits = matchfree(t->ctrl + g*HM_GROUP)) == 0) {
+        g = (g + ++step) & mask;
+    }
+    i = g*HM_GROUP + first(bits);
+    if (t->ctrl[i] == HM_EMPTY) {
+        t->growthleft--;
+    }
+    t->ctrl[i] = (unsigned char)(h & 0x7F);
+    t->slots[i].key = key;
+    t->slots[i].value = value;
+    t->used++;
+}
+
+static void erase(struct _Table *t, int i) {
+    if (matchempty(t->ctrl + (i & ~(HM_GROUP - 1))) != 0) {
+        t->ctrl[i] = HM_EMPTY;
+        t->growthleft++;
+    } else {
+        t->ctrl[i] = HM_DELETED;
+    }
+    t->used--;
+}
+
+/*
+ * Sets *found when key was already there, in either table. A key found
+ * in the old table moves to the new one.
+ */
+static void *put(struct _Map *m, void *key, void *value, int *found) {
+    size_t h = hashof(m, key);
+    void *prev = NULL;
+    int i = -1;
+    
+    if (found != NULL) {
+        *found = 0;
+    }
+    if (m->old.ctrl != NULL) {
+        migrate(m, HM_STEP);
+    }
+    if ((i = find(m, &m->table, key, h)) >= 0) {
+        prev = m->table.slots[i].value;
+        m->table.slots[i].value = value;
+        if (found != NULL) {
+            *found = 1;
+        }
+        return prev;
+    }
+    if ((m->old.ctrl != NULL) && ((i = find(m, &m->old, key, h)) >= 0)) {
+        prev = m->old.slots[i].value;
+        erase(&m->old, i);
+        m->used_buckets--;
+        if (found != NULL) {
+            *found = 1;
+        }
+    }
+    if (m->table.growthleft == 0) {
+        grow(m);
+    }
+    place(&m->table, h, key, value);
+    m->used_buckets++;
+    m->modcount++;
+    return prev;
+}
+
+/*
+ * Returns 1 and the value in *value if key was there, 0 otherwise.
+ */
+static int removekey(struct _Map *m, void *key, void **value) {
+    size_t h = hashof(m, key);
+    struct _Table *t = &m->table;
+    int i = -1;
+    
+    if (m->old.ctrl != NULL) {
+        migrate(m, HM_STEP);
+    }
+    if (((i = find(m, t, key, h)) < 0) && (m->old.ctrl != NULL)) {
+        t = &m->old;
+        i = find(m, t, key, h);
+    }
+    if (i < 0) {
+        return 0;
+    }
+    if (value != NULL) {
+        *value = t->slots[i].value;
+    }
+    erase(t, i);
+    m->used_buckets--;
+    m->modcount++;
+    return 1;
+}
+
+/*
+ * Starts moving to a table twice the size, or to one of the same size
+ * when tombstones rather than keys filled this one. A move still going
+ * on is finished first.
+ */
+static void grow(struct _Map *m) {
+    int capacity = m->table.capacity;
+    
+    if (m->old.ctrl != NULL) {
+        migrate(m, m->old.capacity/HM_GROUP);
+        if (m->table.growthleft > 0) {
+            return;
+        }
+    }
+    if ((m->table.used > capacity/16*7) && (capacity < HM_MAXCAPACITY)) {
+        capacity <<= 1;
+    }
+    m->old = m->table;
+    m->moved = 0;
+    newtable(&m->table, capacity);
+}
+
+/*
+ * Moves up to n more groups of the old table into the new one and frees
+ * the old one once they are all moved. Moved slots become tombstones, so
+ * probes still pass through their group.
+ */
+static void migrate(struct _Map *m, int n) {
+    int groups = m->old.capacity/HM_GROUP;
+    int i = 0, end = 0;
+    
+    while ((n-- > 0) && (m->moved < groups)) {
+        end = (m->moved + 1)*HM_GROUP;
+        for (i = m->moved*HM_GROUP; i < end; i++) {
+            if (!(m->old.ctrl[i] & 0x80)) {
+                place(&m->table, hashof(m, m->old.slots[i].key),
+                      m->old.slots[i].key, m->old.slots[i].value);
+                m->old.ctrl[i] = HM_DELETED;
+            }
+        }
+        m->moved++;
+    }
+    if (m->moved == groups) {
+        free(m->old.slots);
+        m->old.ctrl = NULL;
+        m->old.slots = NULL;
+    }
+}
+
+/*
+ * Walks the slots of the table; carriage is the slot next looks at
+ * first, and last the slot prev looks at first plus one.
+ */
+static void *HMitnext(iterator *it) {
+    struct _Map *m = NULL;
+    void *key = NULL;
+    int i = 0;
+    
+    if (it->hasnext && ((m = acquireit(it)) != NULL)) {
+        for (i = it->carriage; i < m->table.capacity; i++) {
+            if (!(m->table.ctrl[i] & 0x80)) {
+                key = m->table.slots[i].key;
+                it->cursor = m->table.slots[i].value;
+                it->last = &m->table.slots[i];
+                it->carriage = i + 1;
+                it->offset++;
+                break;
+            }
+        }
+        updateit(it, m);
+        CTrelease(m);
+    }
+    return key;
+}
+
+static void *HMitprev(iterator *it) {
+    struct _Map *m = NULL;
+    void *key = NULL;
+    int i = 0;
+    
+    if (it->hasprev && ((m = acquireit(it)) != NULL)) {
+        for (i = it->carriage - 1; i >= 0; i--) {
+            if (!(m->table.ctrl[i] & 0x80)) {
+                key = m->table.slots[i].key;
+                it->cursor = m->table.slots[i].value;
+                it->last = &m->table.slots[i];
+                it->carriage = i;
+                it->offset--;
+                break;
+            }
+        }
+        updateit(it, m);
+        CTrelease(m);
+    }
+    return key;
+}
+
+/*
+ * Removes the key returned by the last call to next or prev and returns
+ * its value.
+ */
+static void *HMitremove(iterator *it) {
+    struct _Map *m = NULL;
+    void *value = NULL;
+    int i = 0;
+    
+    if ((m = acquireit(it)) != NULL) {
+        if (it->last != NULL) {
+            i = (int)((struct _Entry *)it->last - m->table.slots);
+            value = m->table.slots[i].value;
+            erase(&m->table, i);
+            m->used_buckets--;
+            m->modcount++;
+            if (i < it->carriage) {
+                it->offset--;
+            }
+            it->last = NULL;
+            it->modcount = m->modcount;
+            updateit(it, m);
+        } else {
+            errno = EINVAL;
+        }
+        CTrelease(m);
+    }
+    return value;
+}
+
+static void HMupdateit(iterator *it) {
+    struct _Map *m = NULL;
+    
+    if ((m = acquireit(it)) != NULL) {
+        updateit(it, m);
+        CTrelease(m);
+    }
+}
+
+/*
+ * Finishes any move to a larger table, so that every key is in the one
+ * being walked.
+ */
+static void HMresetit(iterator *it) {
+    struct _Map *m = NULL;
+    
+    if ((m = acquire(it->handler)) != NULL) {
+        if (m->old.ctrl != NULL) {
+            migrate(m, m->old.capacity/HM_GROUP);
+            m->modcount++;
+        }
+        it->carriage = 0;
+        it->offset = 0;
+        it->cursor = NULL;
+        it->last = NULL;
+        it->modcount = m->modcount;
+        updateit(it, m);
+        CTrelease(m);
+    }
+}
+
+/*
+ * Locks the map behind an iterator, failing with EFAULT once the map has
+ * been changed other than through the iterator.
+ */
+static struct _Map *acquireit(iterator *it) {
+    struct _Map *m = NULL;
+    
+    if ((m = CTacquire(&controller, it->handler)) != NULL) {
+        if (it->modcount == m->modcount) {
+            return m;
+        }
+        CTrelease(m);
+    }
+    errno = EFAULT;
+    it->hasnext = 0;
+    it->hasprev = 0;
+    return NULL;
+}
+
+/*
+ * offset counts the keys before carriage.
+ */
+static void updateit(iterator *it, struct _Map *m) {
+    it->total_elems = m->used_buckets;
+    it->hasnext = (it->offset < it->total_elems)?1:0;
+    it->hasprev = (it->offset > 0)?1:0;
+}
@@ -0,0 +1,106 @@
+/**
+ *  @file   hashmap.h
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Open addressing hash map and set
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Keys hash into groups of HM_GROUP slots, each slot with a control
+ *  byte holding 7 bits of its key's hash, so a lookup compares a whole
+ *  group of control bytes at once and only calls eq on the slots whose
+ *  bits match. A NULL hash or eq compares keys by address.
+ *
+ *  A full table moves to a larger one a few groups per put or remove
+ *  rather than all at once. Iterators finish any such move first; next
+ *  returns keys and leaves the value of the last one in cursor. Changing
+ *  the map other than through the iterator invalidates it.
+ *
+ *  A HashSet is a HashMap whose values are its keys.
+ */
+#ifndef moustached_hashmap_h
+#define moustached_hashmap_h
+
+#include <stddef.h>
+
+#define HM_GROUP 16
+#define HM_STEP 2
+
+#if !defined(MOUSTASHED_ITERATOR)
+#define MOUSTASHED_ITERATOR
+struct _Iterator {
+    int handler;
+    int carriage;
+    int total_elems;
+    unsigned int modcount;
+    
+    char hasnext;
+    char hasprev;
+    
+    void *cursor;
+    void *last;
+    int offset;
+    
+    void (*update)(struct _Iterator*);
+    void (*reset)(struct _Iterator*);
+    void *(*next)(struct _Iterator*);
+    void *(*prev)(struct _Iterator*);
+    void *(*remove)(struct _Iterator*);
+    void *(*insert)(struct _Iterator*, void*);
+};
+typedef struct _Iterator iterator;
+#endif
+
+typedef int HashMap;
+typedef int HashSet;
+typedef size_t (*hasher)(const void*);
+typedef int (*equality)(const void*, const void*);
+
+
+HashMap HMnew(int, hasher, equality);
+void HMpurge(HashMap);
+void HMdispose(HashMap);
+
+void *HMput(HashMap, void*, void*);
+void *HMget(HashMap, void*);
+void *HMremove(HashMap, void*);
+int HMcontains(HashMap, void*);
+
+int HMsize(HashMap);
+int HMcapacity(HashMap);
+
+iterator HMiterator(HashMap);
+
+HashSet HSnew(int, hasher, equality);
+void HSpurge(HashSet);
+void HSdispose(HashSet);
+
+int HSadd(HashSet, void*);
+int HSremove(HashSet, void*);
+int HScontains(HashSet, void*);
+int HSsize(HashSet);
+
+iterator HSiterator(HashSet);
+
+#endif
@@ -30,14 +30,25 @@
  */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <errno.h>
 
 #include "linkedlist.h"
+#include "controller.h"
+#include "snapshot.h"
 
 
-#define LL_EXPRATE 2
-#define LL_LOADFACT 0.75
-#define LL_INITCAPACITY 30
+#define LL_CACHELINE 64
+#define LL_MINSLAB 512
+#define LL_MAXSLAB 16384
+#define LL_MAXLEVEL 16
+#define LL_TOWERSIZE(h) (sizeof(struct _Tower) + sizeof(struct _Link)*((h) - 1))
+
+#if defined(MOUSTASHED_STATS)
+#define LL_COUNT(a, counter, n) ((a)->stats.counter += (n))
+#else
+#define LL_COUNT(a, counter, n) ((void)0)
+#endif
 
 #ifndef MOUSTASHED_ERROR_STRINGS
 #define MOUSTASHED_ERROR_STRINGS
@@ -49,24 +60,60 @@
  * Struct and Type definitions
  *
  */
-struct _Controller {
-    int total_buckets;
-    int used_buckets;
-    struct _LinkedList *buckets;
-};
-
 struct _Node {
-    char enabled;
+    struct _Tower *tower;
     struct _Node *next;
     struct _Node *prev;
     
     void *data;
 };
 
+/*
+ * Express links of an indexed list. links[k] jumps to the next node with
+ * a tower on level k + 1, width being how many positions it moves ahead;
+ * the last link of a level reaches one past the end of the list. Level
+ * 0 is the plain next chain and a quarter of the nodes get a tower.
+ */
+struct _Link {
+    struct _Node *next;
+    int width;
+};
+
+struct _Tower {
+    struct _Node *node;
+    int height;
+    struct _Link links[1];
+};
+
+/*
+ * Nodes are carved out of cache-line aligned slabs owned by the list.
+ * The slab header takes the first line, nodes fill the rest. Slabs come
+ * from the list's allocator when it has one, the heap otherwise.
+ */
+struct _Slab {
+    struct _Slab *next;
+    void *raw;
+    size_t size;
+};
+
 struct _LinkedList {
     int used_buckets;
+    unsigned int modcount;
     struct _Node *head;
     struct _Node *tail;
+    
+    struct _Slab *slabs;
+    struct _Node *freenodes;
+    struct _Node *bump;
+    int bumpleft;
+    allocator alloc;
+    
+    struct _Tower *index;
+    unsigned int seed;
+    
+#if defined(MOUSTASHED_STATS)
+    stats stats;
+#endif
 };
 
 
@@ -74,65 +121,95 @@ struct _LinkedList {
  * Static-scope variables declaration
  *
  */
-static struct _Controller controller;
+static struct _Controller controller = CT_INITIALIZER(struct _LinkedList);
 
 /**
  * Static-scope functions declaration
  *
  */
-static int getfreelist();
-static char validhandler(int);
+static struct _Node *nodeat(struct _LinkedList *, int);
+static struct _Node *allocnode(struct _LinkedList *);
+static void freenode(struct _LinkedList *, struct _Node *);
+static void freeslabs(struct _LinkedList *);
+static struct _Node *linkbefore(struct _LinkedList *, struct _Node *, int, void *);
+static void unlinknode(struct _LinkedList *, struct _Node *, int);
+static struct _Node *seek(struct _LinkedList *, int, struct _Tower **, int *);
+static struct _Tower *newtower(struct _LinkedList *, int);
+static void freetower(struct _LinkedList *, struct _Tower *);
+static void dropindex(struct _LinkedList *);
+static int towerheight(struct _LinkedList *);
+static struct _LinkedList *acquireit(iterator *);
 static void *LLitnext(iterator *);
 static void *LLitprev(iterator *);
+static void *LLitremove(iterator *);
+static void *LLitinsert(iterator *, void *);
 static void LLupdateit(iterator *);
 static void LLresetit(iterator *);
+static void updateit(iterator *, struct _LinkedList *);
+static void dumpstats(int, void *, void *);
 
 
 LinkedList LLnew(void) {
+    return LLnewwith(NULL);
+}
+
+/*
+ * A list whose nodes all come from alloc, or from the heap when it is
+ * NULL. Adding to a list with an allocator that has run out fails with
+ * ENOMEM where heap lists exit.
+ */
+LinkedList LLnewwith(const allocator *alloc) {
     int handler = -1;
-    struct _LinkedList *tmp = NULL;
+    struct _LinkedList *a = NULL;
     
-    if (controller.buckets == NULL) {
-        controller.buckets = malloc((LL_INITCAPACITY)*(sizeof(void **)));
-        if (controller.buckets == NULL) {
-            perror(S_NOMEM);
-            exit(EXIT_FAILURE);
-        }
-        controller.total_buckets = LL_INITCAPACITY;
+    if ((alloc != NULL) && ((alloc->alloc == NULL) || (alloc->release == NULL))) {
+        errno = EINVAL;
+        return -1;
     }
-    if (controller.used_buckets > controller.total_buckets*LL_LOADFACT) {
-        tmp = realloc(controller.buckets, sizeof(struct _LinkedList) * controller.used_buckets*LL_EXPRATE);
-        if (tmp == NULL) {
-            perror(S_NOMEM); 
-            exit(EXIT_FAILURE);
-        }
-        controller.buckets = tmp;
-        controller.total_buckets *= LL_EXPRATE;
+    if ((handler = CTclaim(&controller, (void **)&a)) < 0) {
+        return -1;
+    }
+    a->used_buckets = 0;
+    a->head = NULL;
+    a->tail = NULL;
+    a->slabs = NULL;
+    a->freenodes = NULL;
+    a->bump = NULL;
+    a->bumpleft = 0;
+    if (alloc != NULL) {
+        a->alloc = *alloc;
     }
-    handler = getfreelist();
-    controller.used_buckets++;
-    controller.buckets[handler].used_buckets = 0;
+    CTrelease(a);
     return handler;
 }
 
 void LLpurge(int handler) {
-    if (validhandler(handler)) {
-        while (controller.buckets[handler].used_buckets > 0) {
-            LLremove(handler, 0);
-        }
-        controller.buckets[handler].used_buckets = 0;
-        controller.buckets[handler].head = NULL;
-        controller.buckets[handler].tail = NULL;
+    struct _LinkedList *a = NULL;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        dropindex(a);
+        freeslabs(a);
+        a->used_buckets = 0;
+        a->modcount++;
+        a->head = NULL;
+        a->tail = NULL;
+        CTrelease(a);
     }
     return;
 }
 
 void LLdispose(int handler) {
-    if (validhandler(handler)) {
-        LLpurge(handler);
-        controller.buckets[handler].head = NULL;
-        controller.buckets[handler].tail = NULL;
-        controller.buckets[handler].used_buckets = 0;
+    struct _LinkedList *a = NULL;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        dropindex(a);
+        if (a->index != NULL) {
+            freetower(a, a->index);
+            a->index = NULL;
+        }
+        freeslabs(a);
+        a->head = NULL;
+        a->tail = NULL;
+        a->used_buckets = 0;
+        CTdispose(&controller, a);
     }
     return;
 }
@@ -140,85 +217,38 @@ void LLdispose(int handler) {
 
 
 void *LLadd(int handler, void *elem) {
-    struct _Node *n = NULL;
-    struct _Node *prev = NULL;
-    
-    if (validhandler(handler)) {
-        n = controller.buckets[handler].head;
-        if (n == NULL) {
-            n = malloc(sizeof(struct _Node));
-            n->prev = NULL;
-            n->next = NULL;
-            controller.buckets[handler].head = n;
-        } else {
-            
-            while (n != NULL) {
-                prev = n;
-                n = n->next;
-            }
-            n = malloc(sizeof(struct _Node));
-            if (n == NULL) {
-                perror(S_NOMEM);
-                exit(EXIT_FAILURE);
-            }
-            n->prev = prev;
-            n->next = NULL;
-            prev->next = n;
+    struct _LinkedList *a = NULL;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        if (linkbefore(a, NULL, a->used_buckets, elem) == NULL) {
+            elem = NULL;
         }
-        n->data = elem;
-        controller.buckets[handler].used_buckets++;
+        CTrelease(a);
     }
     return elem;
 }
 
 void *LLget(int handler, int i) {
     void *elem = NULL;
-    struct _Node *n = NULL;
-    int c = 0;
-    if (validhandler(handler)) {
-        if (controller.buckets[handler].used_buckets > i) {
-            n = controller.buckets[handler].head;
-            for (c = 0; c < i; c++) {
-                n = n->next;
-            }
-            elem = n->data;
+    struct _LinkedList *a = NULL;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        if ((i >= 0) && (i < a->used_buckets)) {
+            elem = nodeat(a, i)->data;
+        } else {
+            errno = EINVAL;
         }
+        CTrelease(a);
     }
     return elem;
 }
 
 void *LLset(LinkedList handler, int i, void *elem) {
     struct _LinkedList *a = NULL;
-    struct _Node *n = NULL;
-    struct _Node *newnode = NULL;
-    int c = 0;
-    if (validhandler(handler) && (i >= 0) && (i < controller.buckets[handler].used_buckets)) {
-        a = &controller.buckets[handler];
-        n = a->head;
-        
-        for (c = 0; c<i; c++) {
-            n = n->next;
-        }
-        newnode = malloc(sizeof(struct _Node));
-        if (newnode == NULL) {
-            perror(S_NOMEM); 
-            exit(EXIT_FAILURE);
-        }
-        
-        if (n->prev != NULL) {
-            n->prev->next = newnode;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        if ((i >= 0) && (i < a->used_buckets)
+            && (linkbefore(a, nodeat(a, i), i, elem) == NULL)) {
+            elem = NULL;
         }
-        newnode->prev = n->prev;
-        
-        if (n == controller.buckets[handler].head) {
-            controller.buckets[handler].head = newnode;
-        }
-        
-        n->prev = newnode;
-        newnode->next = n;
-        
-        newnode->data = elem;
-        a->used_buckets++;
+        CTrelease(a);
     }
     return elem;
 }
@@ -227,141 +257,684 @@ void *LLremove(int handler, int i) {
     struct _LinkedList *a = NULL;
     struct _Node *n = NULL;
     void *elem = NULL;
-    int c = 0;
-    if (validhandler(handler)) {
-        a = &controller.buckets[handler];
-        n = a->head;
-        if (n) {
-            if (i > 0) {
-                while (n && (c < i)) {
-                    n = n->next;
-                }
-                if (n->next) {
-                    n->next->prev = n->prev;
-                }
-                if (n->prev) {
-                    n->prev->next = n->next;
-                }
-                
-            } else if (i == 0){
-                if (a->head->next != NULL) {
-                    a->head->next->prev = NULL;
-                }
-                a->head = a->head->next;
-            }
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        if ((i >= 0) && (i < a->used_buckets)) {
+            n = nodeat(a, i);
             elem = n->data;
-            free(n);
-            n = NULL;
-            a->used_buckets--;
+            unlinknode(a, n, i);
         } else {
             errno = EINVAL;
         }
+        CTrelease(a);
     }
     return elem;
 }
 
+/*
+ * Turns the skip-list index of the list on or off. Indexed lists find
+ * positions, and insert or remove at them, in expected O(log n) at the
+ * cost of the towers; iterating them still walks the next chain. Returns
+ * 0, or -1 with errno set when the index could not be allocated.
+ */
+int LLsetindexed(int handler, int on) {
+    struct _LinkedList *a = NULL;
+    struct _Tower *last[LL_MAXLEVEL];
+    int lastpos[LL_MAXLEVEL];
+    struct _Node *n = NULL;
+    int pos = 0;
+    int h = 0;
+    int l = 0;
+    if ((a = CTacquire(&controller, handler)) == NULL) {
+        return -1;
+    }
+    if (!on && (a->index != NULL)) {
+        dropindex(a);
+        freetower(a, a->index);
+        a->index = NULL;
+    } else if (on && (a->index == NULL)) {
+        if ((a->index = newtower(a, LL_MAXLEVEL)) == NULL) {
+            CTrelease(a);
+            return -1;
+        }
+        a->seed = ((unsigned int)(size_t)a >> 4) | 1;
+        for (l = 0; l < LL_MAXLEVEL; l++) {
+            last[l] = a->index;
+            lastpos[l] = -1;
+        }
+        for (n = a->head, pos = 0; n != NULL; n = n->next, pos++) {
+            if (((h = towerheight(a)) > 0) && ((n->tower = newtower(a, h)) != NULL)) {
+                n->tower->node = n;
+                for (l = 0; l < h; l++) {
+                    last[l]->links[l].next = n;
+                    last[l]->links[l].width = pos - lastpos[l];
+                    last[l] = n->tower;
+                    lastpos[l] = pos;
+                }
+            }
+        }
+        for (l = 0; l < LL_MAXLEVEL; l++) {
+            last[l]->links[l].next = NULL;
+            last[l]->links[l].width = a->used_buckets - lastpos[l];
+        }
+    }
+    CTrelease(a);
+    return 0;
+}
 
 int LLsize(int handler) {
     int size = -1;
-    if (validhandler(handler)) {
-        size = controller.buckets[handler].used_buckets;
+    struct _LinkedList *a = NULL;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        size = a->used_buckets;
+        CTrelease(a);
     }
     return size;
 }
 
 void** LLtoarray(int handler) {
     void **array = NULL;
-    if (validhandler(handler)) {
-        array = malloc(sizeof(void *)*controller.buckets[handler].used_buckets);
+    struct _LinkedList *a = NULL;
+    struct _Node *n = NULL;
+    int i = 0;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        array = malloc(sizeof(void *)*a->used_buckets);
         if (array == NULL) {
             perror(S_NOMEM); 
             exit(EXIT_FAILURE);
         }
-        iterator it = LLiterator(handler);
-        while (it.hasnext) {
-            array[it.carriage-1] = it.next(&it);
+        for (n = a->head; n != NULL; n = n->next) {
+            array[i++] = n->data;
         }
+        CTrelease(a);
     }
     return array;
 }
 
+/*
+ * Writes every element through save, head first. The file can be read
+ * back by LLload or ALload. Returns 0, or -1 with errno set.
+ */
+int LLsave(int handler, const char *path, serializer save, void *ctx) {
+    struct _LinkedList *a = NULL;
+    struct _Node *n = NULL;
+    FILE *f = NULL;
+    int status = -1;
+    if ((a = CTacquire(&controller, handler)) == NULL) {
+        return -1;
+    }
+    if (save == NULL) {
+        errno = EINVAL;
+    } else if ((f = fopen(path, "wb")) != NULL) {
+        status = SNwriteheader(f, SN_SERIALIZED, 0, a->used_buckets);
+        for (n = a->head; (status == 0) && (n != NULL); n = n->next) {
+            if (save(n->data, f, ctx) != 0) {
+                status = -1;
+            }
+        }
+        if ((fclose(f) != 0) && (status == 0)) {
+            status = -1;
+        }
+    }
+    CTrelease(a);
+    return status;
+}
+
+/*
+ * Reads serialized elements written by LLsave or ALsave through load.
+ * When load fails, the elements it already produced are passed to
+ * release, if given, before the list is disposed.
+ * Returns the new handle, or -1 with errno set.
+ */
+LinkedList LLload(const char *path, deserializer load, visitor release, void *ctx) {
+    struct _LinkedList *a = NULL;
+    struct _Node *n = NULL;
+    FILE *f = NULL;
+    void *elem = NULL;
+    size_t es = 0;
+    size_t count = 0;
+    int handler = -1;
+    int kind = 0;
+    if ((f = fopen(path, "rb")) == NULL) {
+        return -1;
+    }
+    if (SNreadheader(f, &kind, &es, &count) == 0) {
+        if ((kind != SN_SERIALIZED) || (load == NULL)) {
+            errno = EINVAL;
+        } else if ((handler = LLnew()) >= 0) {
+            a = CTacquire(&controller, handler);
+            while ((a->used_buckets < (int)count) && (load(f, &elem, ctx) == 0)) {
+                linkbefore(a, NULL, a->used_buckets, elem);
+            }
+            count -= a->used_buckets;
+            for (n = a->head; (count > 0) && (release != NULL) && (n != NULL); n = n->next) {
+                release(n->data, ctx);
+            }
+            CTrelease(a);
+            if (count > 0) {
+                LLdispose(handler);
+                handler = -1;
+            }
+        }
+    }
+    fclose(f);
+    return handler;
+}
+
+/*
+ * Copies the counters of the list into st. Fails with ENOTSUP unless the
+ * library was built with MOUSTASHED_STATS.
+ */
+int LLstats(int handler, stats *st) {
+    struct _LinkedList *a = NULL;
+    if ((a = CTacquire(&controller, handler)) == NULL) {
+        return -1;
+    }
+#if defined(MOUSTASHED_STATS)
+    *st = a->stats;
+    CTrelease(a);
+    return 0;
+#else
+    memset(st, 0, sizeof(*st));
+    CTrelease(a);
+    errno = ENOTSUP;
+    return -1;
+#endif
+}
+
+void LLdumpstats(FILE *f) {
+    CTforeach(&controller, dumpstats, f);
+}
+
 iterator LLiterator(int handler) {
     iterator it;
-    if (validhandler(handler)) {
+    struct _LinkedList *a = NULL;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
         it.handler = handler;
-        it.carriage = 0;
         it.next = LLitnext;
         it.prev = LLitprev;
+        it.remove = LLitremove;
+        it.insert = LLitinsert;
         it.update = LLupdateit;
         it.reset = LLresetit;
-        it.update(&it);
+        CTrelease(a);
+        it.reset(&it);
     }
     return it;
 }
 
+/*
+ * Writes up to n elements from the iterator's position to out, as next
+ * would return them one by one, and moves past them. Returns how many
+ * were written, 0 at the end, or -1 if the iterator is no longer valid.
+ */
+int LLnextbatch(iterator *it, void **out, int n) {
+    struct _LinkedList *a = NULL;
+    struct _Node *node = NULL;
+    int count = -1;
+    if ((a = acquireit(it)) != NULL) {
+        for (count = 0, node = it->cursor; (count < n) && (node != NULL); count++) {
+            out[count] = node->data;
+            it->last = node;
+            node = node->next;
+        }
+        it->cursor = node;
+        it->carriage += count;
+        LL_COUNT(a, walked, count);
+        LL_COUNT(a, steps, count);
+        updateit(it, a);
+        CTrelease(a);
+    }
+    return count;
+}
+
 
 /**
  * Static-scope functions definition
  *
  */
-static int getfreelist() {
-    int handler = 0;
-    while ((handler < controller.used_buckets) 
-           && (controller.buckets[handler].head != NULL))
-        handler++;
+/*
+ * Walks from whichever end of the list is closer to the index, or down
+ * the index when the list has one. The caller must ensure
+ * 0 <= i < used_buckets.
+ */
+static struct _Node *nodeat(struct _LinkedList *a, int i) {
+    struct _Node *n = NULL;
+    int c = 0;
+    if (a->index != NULL) {
+        return seek(a, i, NULL, NULL);
+    }
+    if (i < (a->used_buckets >> 1)) {
+        n = a->head;
+        for (c = 0; c < i; c++) {
+            n = n->next;
+        }
+        LL_COUNT(a, walked, i);
+    } else {
+        n = a->tail;
+        for (c = a->used_buckets-1; c > i; c--) {
+            n = n->prev;
+        }
+        LL_COUNT(a, walked, a->used_buckets - 1 - i);
+    }
+    return n;
+}
+
+/*
+ * Takes a node from the free list, then from the current slab, and only
+ * then allocates a new slab. Slabs double in size up to LL_MAXSLAB so
+ * short lists stay small. Returns NULL if the list's allocator refuses
+ * a slab.
+ */
+static struct _Node *allocnode(struct _LinkedList *a) {
+    struct _Node *n = NULL;
+    struct _Slab *slab = NULL;
+    void *raw = NULL;
+    size_t size = LL_MINSLAB;
     
-    return handler;
+    if (a->freenodes != NULL) {
+        n = a->freenodes;
+        a->freenodes = n->next;
+        return n;
+    }
+    if (a->bumpleft == 0) {
+        if (a->slabs != NULL) {
+            size = a->slabs->size << 1;
+            if (size > LL_MAXSLAB) {
+                size = LL_MAXSLAB;
+            }
+        }
+        if (a->alloc.alloc != NULL) {
+            if ((raw = a->alloc.alloc(size + LL_CACHELINE - 1, a->alloc.ctx)) == NULL) {
+                errno = ENOMEM;
+                return NULL;
+            }
+        } else if ((raw = malloc(size + LL_CACHELINE - 1)) == NULL) {
+            perror(S_NOMEM);
+            exit(EXIT_FAILURE);
+        }
+        slab = (struct _Slab *)(((size_t)raw + LL_CACHELINE - 1) & ~((size_t)LL_CACHELINE - 1));
+        slab->raw = raw;
+        slab->size = size;
+        slab->next = a->slabs;
+        a->slabs = slab;
+        a->bump = (struct _Node *)((char *)slab + LL_CACHELINE);
+        a->bumpleft = (int)((size - LL_CACHELINE) / sizeof(struct _Node));
+#if defined(MOUSTASHED_STATS)
+        a->stats.bytes += size;
+        if (a->stats.bytes > a->stats.peak) {
+            a->stats.peak = a->stats.bytes;
+        }
+#endif
+    }
+    n = a->bump;
+    a->bump++;
+    a->bumpleft--;
+    return n;
+}
+
+static void freenode(struct _LinkedList *a, struct _Node *n) {
+    n->next = a->freenodes;
+    a->freenodes = n;
+}
+
+static void freeslabs(struct _LinkedList *a) {
+    struct _Slab *slab = a->slabs;
+    struct _Slab *next = NULL;
+    while (slab != NULL) {
+        next = slab->next;
+#if defined(MOUSTASHED_STATS)
+        a->stats.bytes -= slab->size;
+#endif
+        if (a->alloc.alloc != NULL) {
+            a->alloc.release(slab->raw, slab->size + LL_CACHELINE - 1, a->alloc.ctx);
+        } else {
+            free(slab->raw);
+        }
+        slab = next;
+    }
+    a->slabs = NULL;
+    a->freenodes = NULL;
+    a->bump = NULL;
+    a->bumpleft = 0;
+}
+
+/*
+ * Links a new node holding elem before the given node, or at the tail
+ * when the node is NULL, i being the position it takes. Returns NULL
+ * when no node could be allocated. A tower that cannot be allocated is
+ * left out, which costs the index some balance but nothing else.
+ */
+static struct _Node *linkbefore(struct _LinkedList *a, struct _Node *n, int i, void *elem) {
+    struct _Node *newnode = NULL;
+    struct _Tower *pred[LL_MAXLEVEL];
+    int ppos[LL_MAXLEVEL];
+    struct _Tower *t = NULL;
+    int h = 0;
+    int l = 0;
+    if ((newnode = allocnode(a)) == NULL) {
+        return NULL;
+    }
+    newnode->tower = NULL;
+    if (a->index != NULL) {
+        seek(a, i, pred, ppos);
+        if (((h = towerheight(a)) > 0) && ((t = newtower(a, h)) != NULL)) {
+            t->node = newnode;
+            newnode->tower = t;
+        } else {
+            h = 0;
+        }
+        for (l = 0; l < LL_MAXLEVEL; l++) {
+            if (l < h) {
+                t->links[l].next = pred[l]->links[l].next;
+                t->links[l].width = ppos[l] + pred[l]->links[l].width + 1 - i;
+                pred[l]->links[l].next = newnode;
+                pred[l]->links[l].width = i - ppos[l];
+            } else {
+                pred[l]->links[l].width++;
+            }
+        }
+    }
+    newnode->data = elem;
+    newnode->next = n;
+    newnode->prev = (n != NULL)?n->prev:a->tail;
+    
+    if (newnode->prev != NULL) {
+        newnode->prev->next = newnode;
+    } else {
+        a->head = newnode;
+    }
+    if (n != NULL) {
+        n->prev = newnode;
+    } else {
+        a->tail = newnode;
+    }
+    a->used_buckets++;
+    a->modcount++;
+    return newnode;
 }
 
-static char validhandler(int handler) {
-    if (handler < controller.used_buckets) {
-        return 1;
+static void unlinknode(struct _LinkedList *a, struct _Node *n, int i) {
+    struct _Tower *pred[LL_MAXLEVEL];
+    int ppos[LL_MAXLEVEL];
+    int l = 0;
+    if (a->index != NULL) {
+        seek(a, i, pred, ppos);
+        for (l = 0; l < LL_MAXLEVEL; l++) {
+            if (pred[l]->links[l].next == n) {
+                pred[l]->links[l].width += n->tower->links[l].width - 1;
+                pred[l]->links[l].next = n->tower->links[l].next;
+            } else {
+                pred[l]->links[l].width--;
+            }
+        }
+        if (n->tower != NULL) {
+            freetower(a, n->tower);
+            n->tower = NULL;
+        }
+    }
+    if (n->next) {
+        n->next->prev = n->prev;
     } else {
-        errno = EFAULT;
+        a->tail = n->prev;
     }
-    return 0;
+    if (n->prev) {
+        n->prev->next = n->next;
+    } else {
+        a->head = n->next;
+    }
+    freenode(a, n);
+    a->used_buckets--;
+    a->modcount++;
+}
+
+/*
+ * Goes down the index to position i, leaving in pred and ppos, when
+ * given, the last tower before i on every level and its position, the
+ * list head standing at -1. Returns the node at i, or NULL at the end.
+ */
+static struct _Node *seek(struct _LinkedList *a, int i, struct _Tower **pred, int *ppos) {
+    struct _Tower *t = a->index;
+    struct _Node *n = NULL;
+    int pos = -1;
+    int l = 0;
+    for (l = LL_MAXLEVEL - 1; l >= 0; l--) {
+        while ((t->links[l].next != NULL) && (pos + t->links[l].width < i)) {
+            pos += t->links[l].width;
+            t = t->links[l].next->tower;
+            LL_COUNT(a, walked, 1);
+        }
+        if (pred != NULL) {
+            pred[l] = t;
+            ppos[l] = pos;
+        }
+    }
+    n = (t->node != NULL)?t->node->next:a->head;
+    for (pos++; pos < i; pos++) {
+        n = n->next;
+        LL_COUNT(a, walked, 1);
+    }
+    return n;
+}
+
+/*
+ * Towers come from the list's allocator like its slabs. An allocator
+ * running out gets NULL back with ENOMEM, the heap exits.
+ */
+static struct _Tower *newtower(struct _LinkedList *a, int height) {
+    struct _Tower *t = NULL;
+    int l = 0;
+    if (a->alloc.alloc != NULL) {
+        if ((t = a->alloc.alloc(LL_TOWERSIZE(height), a->alloc.ctx)) == NULL) {
+            errno = ENOMEM;
+            return NULL;
+        }
+    } else if ((t = malloc(LL_TOWERSIZE(height))) == NULL) {
+        perror(S_NOMEM);
+        exit(EXIT_FAILURE);
+    }
+    t->node = NULL;
+    t->height = height;
+    for (l = 0; l < height; l++) {
+        t->links[l].next = NULL;
+        t->links[l].width = a->used_buckets + 1;
+    }
+#if defined(MOUSTASHED_STATS)
+    a->stats.bytes += LL_TOWERSIZE(height);
+    if (a->stats.bytes > a->stats.peak) {
+        a->stats.peak = a->stats.bytes;
+    }
+#endif
+    return t;
+}
+
+static void freetower(struct _LinkedList *a, struct _Tower *t) {
+#if defined(MOUSTASHED_STATS)
+    a->stats.bytes -= LL_TOWERSIZE(t->height);
+#endif
+    if (a->alloc.alloc != NULL) {
+        a->alloc.release(t, LL_TOWERSIZE(t->height), a->alloc.ctx);
+    } else {
+        free(t);
+    }
+}
+
+/*
+ * Frees the towers of every node and empties the index, keeping its
+ * head tower.
+ */
+static void dropindex(struct _LinkedList *a) {
+    struct _Node *n = NULL;
+    int l = 0;
+    if (a->index == NULL) {
+        return;
+    }
+    for (n = a->head; n != NULL; n = n->next) {
+        if (n->tower != NULL) {
+            freetower(a, n->tower);
+            n->tower = NULL;
+        }
+    }
+    for (l = 0; l < LL_MAXLEVEL; l++) {
+        a->index->links[l].next = NULL;
+        a->index->links[l].width = 1;
+    }
+}
+
+/*
+ * Geometric with p = 1/4, two bits of an xorshift draw per level.
+ */
+static int towerheight(struct _LinkedList *a) {
+    unsigned int r = a->seed;
+    int h = 0;
+    r ^= r << 13;
+    r ^= r >> 17;
+    r ^= r << 5;
+    a->seed = r;
+    while (((r & 3) == 0) && (h < LL_MAXLEVEL)) {
+        h++;
+        r >>= 2;
+    }
+    return h;
+}
+
+/*
+ * Locks the list behind an iterator. An iterator is only valid while the
+ * list has not been modified through any other path than the iterator
+ * itself.
+ */
+static struct _LinkedList *acquireit(iterator *it) {
+    struct _LinkedList *a = NULL;
+    if ((a = CTacquire(&controller, it->handler)) != NULL) {
+        if (it->modcount == a->modcount) {
+            return a;
+        }
+        CTrelease(a);
+    }
+    errno = EFAULT;
+    it->hasnext = 0;
+    it->hasprev = 0;
+    return NULL;
 }
 
 static void *LLitnext(iterator *it) {
     void *elem = NULL;
+    struct _LinkedList *a = NULL;
     struct _Node *n = NULL;
-    int i = 0;
-    if (it->hasnext) {
-        n = controller.buckets[it->handler].head;
-        for (i = 0; i < it->carriage; i++) {
-            n = n->next;
-        }
+    if (it->hasnext && ((a = acquireit(it)) != NULL)) {
+        n = it->cursor;
         elem = n->data;
+        it->last = n;
+        it->cursor = n->next;
         it->carriage++;
-        it->update(it);
+        LL_COUNT(a, walked, 1);
+        LL_COUNT(a, steps, 1);
+        updateit(it, a);
+        CTrelease(a);
     }
     return elem;
 }
 
 static void *LLitprev(iterator *it) {
     void *elem = NULL;
+    struct _LinkedList *a = NULL;
     struct _Node *n = NULL;
-    int i = 0;
-    if (it->hasprev) {
+    if (it->hasprev && ((a = acquireit(it)) != NULL)) {
+        n = it->cursor;
+        n = (n != NULL)?n->prev:a->tail;
+        elem = n->data;
+        it->last = n;
+        it->cursor = n;
         it->carriage--;
-        n = controller.buckets[it->handler].head;
-        for (i = 1; i < it->carriage; i++) {
-            n = n->next;
+        LL_COUNT(a, walked, 1);
+        LL_COUNT(a, steps, 1);
+        updateit(it, a);
+        CTrelease(a);
+    }
+    return elem;
+}
+
+/*
+ * Removes the element returned by the last call to next or prev.
+ */
+static void *LLitremove(iterator *it) {
+    void *elem = NULL;
+    struct _LinkedList *a = NULL;
+    struct _Node *n = NULL;
+    if ((a = acquireit(it)) != NULL) {
+        n = it->last;
+        if (n != NULL) {
+            if (n == it->cursor) {
+                it->cursor = n->next;
+            } else {
+                it->carriage--;
+            }
+            elem = n->data;
+            unlinknode(a, n, it->carriage);
+            it->last = NULL;
+            it->modcount = a->modcount;
+            updateit(it, a);
+        } else {
+            errno = EINVAL;
         }
-        elem = n->data;
-        it->update(it);
+        CTrelease(a);
+    }
+    return elem;
+}
+
+/*
+ * Inserts elem before the element that would be returned by next.
+ */
+static void *LLitinsert(iterator *it, void *elem) {
+    struct _LinkedList *a = NULL;
+    if ((a = acquireit(it)) != NULL) {
+        if (linkbefore(a, it->cursor, it->carriage, elem) == NULL) {
+            CTrelease(a);
+            return NULL;
+        }
+        it->carriage++;
+        it->last = NULL;
+        it->modcount = a->modcount;
+        updateit(it, a);
+        CTrelease(a);
     }
     return elem;
 }
 
 static void LLupdateit(iterator *it) {
-    it->total_elems = controller.buckets[it->handler].used_buckets;
-    it->hasnext = (it->carriage < it->total_elems)?1:0;
-    it->hasprev = (it->carriage > 0)?1:0;
+    struct _LinkedList *a = NULL;
+    if ((a = acquireit(it)) != NULL) {
+        updateit(it, a);
+        CTrelease(a);
+    }
     return;
 }
 
 static void LLresetit(iterator *it) {
-    it->carriage = 0;
-    it->update(it);
+    struct _LinkedList *a = NULL;
+    if ((a = CTacquire(&controller, it->handler)) != NULL) {
+        it->carriage = 0;
+        it->cursor = a->head;
+        it->last = NULL;
+        it->offset = 0;
+        it->modcount = a->modcount;
+        updateit(it, a);
+        CTrelease(a);
+    }
+}
+
+static void updateit(iterator *it, struct _LinkedList *a) {
+    it->total_elems = a->used_buckets;
+    it->hasnext = (it->cursor != NULL)?1:0;
+    it->hasprev = (it->carriage > 0)?1:0;
+}
+
+static void dumpstats(int handler, void *entry, void *f) {
+    struct _LinkedList *a = entry;
+#if defined(MOUSTASHED_STATS)
+    fprintf(f, "LinkedList %d: size %d, bytes %lu, peak %lu, walked %lu, steps %lu\n",
+            handler, a->used_buckets, (unsigned long)a->stats.bytes,
+            (unsigned long)a->stats.peak, a->stats.walked, a->stats.steps);
+#else
+    fprintf(f, "LinkedList %d: size %d\n", handler, a->used_buckets);
+#endif
 }
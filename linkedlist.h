@@ -31,27 +31,66 @@
 #ifndef moustached_linkedlist_h
 #define moustached_linkedlist_h
 
+#include <stddef.h>
+#include <stdio.h>
+
 #if !defined(MOUSTASHED_ITERATOR)
 #define MOUSTASHED_ITERATOR
 struct _Iterator {
     int handler;
     int carriage;
     int total_elems;
+    unsigned int modcount;
     
     char hasnext;
     char hasprev;
     
+    void *cursor;
+    void *last;
+    int offset;
+    
     void (*update)(struct _Iterator*);
     void (*reset)(struct _Iterator*);
     void *(*next)(struct _Iterator*);
     void *(*prev)(struct _Iterator*);
+    void *(*remove)(struct _Iterator*);
+    void *(*insert)(struct _Iterator*, void*);
 };
 typedef struct _Iterator iterator;
 #endif
+#if !defined(MOUSTASHED_STATS_T)
+#define MOUSTASHED_STATS_T
+struct _Stats {
+    unsigned long reallocs;
+    size_t bytes;
+    size_t peak;
+    unsigned long shifted;
+    unsigned long walked;
+    unsigned long steps;
+};
+typedef struct _Stats stats;
+#endif
+#if !defined(MOUSTASHED_ALLOCATOR)
+#define MOUSTASHED_ALLOCATOR
+struct _Allocator {
+    void *(*alloc)(size_t, void*);
+    void *(*resize)(void*, size_t, size_t, void*);
+    void (*release)(void*, size_t, void*);
+    void *ctx;
+};
+typedef struct _Allocator allocator;
+#endif
+#if !defined(MOUSTASHED_SERIALIZER)
+#define MOUSTASHED_SERIALIZER
+typedef int (*serializer)(void*, FILE*, void*);
+typedef int (*deserializer)(FILE*, void**, void*);
+typedef void (*visitor)(void*, void*);
+#endif
 typedef int LinkedList;
 
 
 LinkedList LLnew(void);
+LinkedList LLnewwith(const allocator*);
 void LLpurge(LinkedList);
 void LLdispose(LinkedList);
 
@@ -59,9 +98,18 @@ void *LLadd(LinkedList, void*);
 void *LLget(LinkedList, int);
 void *LLset(LinkedList, int, void*);
 void *LLremove(LinkedList, int);
+int LLsetindexed(LinkedList, int);
 
 int LLsize(LinkedList);
 void **LLtoarray(LinkedList);
+
+int LLsave(LinkedList, const char*, serializer, void*);
+LinkedList LLload(const char*, deserializer, visitor, void*);
+
+int LLstats(LinkedList, stats*);
+void LLdumpstats(FILE*);
+
 iterator LLiterator(LinkedList);
+int LLnextbatch(iterator*, void**, int);
 
 #endif
@@ -0,0 +1,304 @@
+/**
+ *  @file   queue.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Bounded lock-free multi-producer multi-consumer queue
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#if !defined(MOUSTASHED_NOTHREADS)
+#include <sched.h>
+#endif
+
+#include "queue.h"
+#include "controller.h"
+
+#ifndef MOUSTASHED_ERROR_STRINGS
+#define MOUSTASHED_ERROR_STRINGS
+#define S_NOMEM "Allocating memory"
+#define S_EFAULT "Invalid handler"
+#endif
+
+/**
+ * Struct and Type definitions
+ *
+ */
+/*
+ * Cell i is free for the producer at position p when its seq is p, and
+ * full for the consumer at position p when it is p + 1. Taking the
+ * element hands the cell to the producer one lap ahead.
+ */
+struct _Cell {
+    long seq;
+    void *elem;
+};
+
+/*
+ * tail is where producers claim cells, head where consumers do, each on
+ * its own cache line.
+ */
+struct _Queue {
+    struct _Cell *cells;
+    long mask;
+    char pad1[CT_CACHELINE];
+    long head;
+    char pad2[CT_CACHELINE - sizeof(long)];
+    long tail;
+    char pad3[CT_CACHELINE - sizeof(long)];
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static struct _Controller controller = CT_INITIALIZER(struct _Queue);
+
+/**
+ * Static-scope functions declaration
+ *
+ */
+static int enqueue(struct _Queue *, void *);
+static void *dequeue(struct _Queue *);
+static int backoff(int *);
+
+
+/**
+ * Functions definition
+ *
+ */
+Queue QUnew(int capacity) {
+    struct _Queue *q = NULL;
+    struct _Cell *cells = NULL;
+    long size = 2;
+    long i = 0;
+    int handler = -1;
+    
+    if ((capacity <= 0) || (capacity > QU_MAXCAPACITY)) {
+        errno = EINVAL;
+        return -1;
+    }
+    while (size < capacity) {
+        size <<= 1;
+    }
+    if (posix_memalign((void **)&cells, CT_CACHELINE, sizeof(struct _Cell)*size) != 0) {
+        perror(S_NOMEM);
+        exit(EXIT_FAILURE);
+    }
+    for (i = 0; i < size; i++) {
+        cells[i].seq = i;
+        cells[i].elem = NULL;
+    }
+    if ((handler = CTclaim(&controller, (void **)&q)) < 0) {
+        free(cells);
+        return -1;
+    }
+    q->cells = cells;
+    q->mask = size - 1;
+    CTrelease(q);
+    return handler;
+}
+
+void QUdispose(Queue handler) {
+    struct _Queue *q;
+    
+    if ((q = CTacquire(&controller, handler)) != NULL) {
+        free(q->cells);
+        q->cells = NULL;
+        CTdispose(&controller, q);
+    }
+}
+
+/*
+ * Waits while the queue is full. Returns 0, or -1 with errno set.
+ */
+int QUpush(Queue handler, void *elem) {
+    struct _Queue *q = CTpeek(&controller, handler);
+    int spins = 0;
+    
+    if (q == NULL) {
+        return -1;
+    }
+    if (elem == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    while (enqueue(q, elem) != 0) {
+        if (backoff(&spins) != 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/*
+ * Fails with EAGAIN when the queue is full.
+ */
+int QUtrypush(Queue handler, void *elem) {
+    struct _Queue *q = CTpeek(&controller, handler);
+    
+    if (q == NULL) {
+        return -1;
+    }
+    if (elem == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if (enqueue(q, elem) != 0) {
+        errno = EAGAIN;
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Waits while the queue is empty.
+ */
+void *QUpop(Queue handler) {
+    struct _Queue *q = CTpeek(&controller, handler);
+    void *elem = NULL;
+    int spins = 0;
+    
+    if (q == NULL) {
+        return NULL;
+    }
+    while ((elem = dequeue(q)) == NULL) {
+        if (backoff(&spins) != 0) {
+            break;
+        }
+    }
+    return elem;
+}
+
+void *QUtrypop(Queue handler) {
+    struct _Queue *q = CTpeek(&controller, handler);
+    
+    if (q == NULL) {
+        return NULL;
+    }
+    return dequeue(q);
+}
+
+/*
+ * Only a hint while other threads use the queue.
+ */
+int QUsize(Queue handler) {
+    struct _Queue *q = CTpeek(&controller, handler);
+    long size = 0;
+    
+    if (q == NULL) {
+        return -1;
+    }
+    size = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE) - __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    if (size < 0) {
+        size = 0;
+    }
+    return (size > q->mask + 1)?(int)(q->mask + 1):(int)size;
+}
+
+int QUcapacity(Queue handler) {
+    struct _Queue *q = CTpeek(&controller, handler);
+    
+    if (q == NULL) {
+        return -1;
+    }
+    return (int)(q->mask + 1);
+}
+
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static int enqueue(struct _Queue *q, void *elem) {
+    long pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+    struct _Cell *c = NULL;
+    long diff = 0;
+    
+    for (;;) {
+        c = &q->cells[pos & q->mask];
+        diff = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE) - pos;
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&q->tail, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return -1;
+        } else {
+            pos = __atomic_load_n(&q->tail, __ATOMIC_RELAXED);
+        }
+    }
+    c->elem = elem;
+    __atomic_store_n(&c->seq, pos + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+static void *dequeue(struct _Queue *q) {
+    long pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+    struct _Cell *c = NULL;
+    void *elem = NULL;
+    long diff = 0;
+    
+    for (;;) {
+        c = &q->cells[pos & q->mask];
+        diff = __atomic_load_n(&c->seq, __ATOMIC_ACQUIRE) - (pos + 1);
+        if (diff == 0) {
+            if (__atomic_compare_exchange_n(&q->head, &pos, pos + 1, 1,
+                                            __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return NULL;
+        } else {
+            pos = __atomic_load_n(&q->head, __ATOMIC_RELAXED);
+        }
+    }
+    elem = c->elem;
+    __atomic_store_n(&c->seq, pos + q->mask + 1, __ATOMIC_RELEASE);
+    return elem;
+}
+
+/*
+ * Spins QU_SPINS times, then yields. Without threads nobody else can
+ * change the queue, so waiting fails at once with EAGAIN.
+ */
+static int backoff(int *spins) {
+#if !defined(MOUSTASHED_NOTHREADS)
+    if (++*spins > QU_SPINS) {
+        sched_yield();
+    }
+    return 0;
+#else
+    (void)spins;
+    errno = EAGAIN;
+    return -1;
+#endif
+}
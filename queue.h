@@ -0,0 +1,57 @@
+/**
+ *  @file   queue.h
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Bounded lock-free multi-producer multi-consumer queue
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  A ring of cells, each carrying a sequence number that tells producers
+ *  and consumers whose turn it is, so any number of threads can push and
+ *  pop at once without a lock. The capacity is rounded up to a power of
+ *  two and fixed. NULL cannot be queued, it is what the try functions
+ *  return when there is nothing to take. Dispose a queue only once no
+ *  thread uses it anymore.
+ */
+#ifndef moustached_queue_h
+#define moustached_queue_h
+
+#define QU_MAXCAPACITY (1 << 30)
+#define QU_SPINS 64
+
+typedef int Queue;
+
+
+Queue QUnew(int);
+void QUdispose(Queue);
+
+int QUpush(Queue, void*);
+int QUtrypush(Queue, void*);
+void *QUpop(Queue);
+void *QUtrypop(Queue);
+
+int QUsize(Queue);
+int QUcapacity(Queue);
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ *  @file   snapshot.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Versioned file header shared by the list snapshots
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#include "snapshot.h"
+
+#define SN_MAGIC "MOUSTASH"
+#define SN_BYTEORDER 0x01020304u
+
+/**
+ * Struct and Type definitions
+ *
+ */
+/*
+ * Fixed-width fields only, so the layout is the same for every build of
+ * the same byte order.
+ */
+struct _Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteorder;
+    uint32_t kind;
+    uint32_t reserved;
+    uint64_t elemsize;
+    uint64_t count;
+    char pad[SN_HEADERSIZE - 40];
+};
+
+
+/**
+ * Functions definition
+ *
+ */
+int SNwriteheader(FILE *f, int kind, size_t elemsize, size_t count) {
+    struct _Header h;
+    
+    memset(&h, 0, sizeof(h));
+    memcpy(h.magic, SN_MAGIC, sizeof(h.magic));
+    h.version = SN_VERSION;
+    h.byteorder = SN_BYTEORDER;
+    h.kind = (uint32_t)kind;
+    h.elemsize = elemsize;
+    h.count = count;
+    if (fwrite(&h, sizeof(h), 1, f) != 1) {
+        return -1;
+    }
+    return 0;
+}
+
+/*
+ * Fails with EINVAL on anything but a snapshot of this version written
+ * with the same byte order.
+ */
+int SNreadheader(FILE *f, int *kind, size_t *elemsize, size_t *count) {
+    struct _Header h;
+    
+    if (fread(&h, sizeof(h), 1, f) != 1) {
+        if (!ferror(f)) {
+            errno = EINVAL;
+        }
+        return -1;
+    }
+    if ((memcmp(h.magic, SN_MAGIC, sizeof(h.magic)) != 0)
+        || (h.version != SN_VERSION) || (h.byteorder != SN_BYTEORDER)
+        || ((h.kind != SN_RECORDS) && (h.kind != SN_SERIALIZED))
+        || (h.count > (uint64_t)INT32_MAX)) {
+        errno = EINVAL;
+        return -1;
+    }
+    *kind = (int)h.kind;
+    *elemsize = (size_t)h.elemsize;
+    *count = (size_t)h.count;
+    return 0;
+}
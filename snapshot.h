@@ -0,0 +1,51 @@
+/**
+ *  @file   snapshot.h
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Versioned file header shared by the list snapshots
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  A snapshot is a 64-byte header followed by a contiguous payload. The
+ *  header carries a magic, the format version, a byte-order mark, the
+ *  payload kind, the element size and the element count. Record payloads
+ *  are the raw records, element after element, so they can be mapped in
+ *  place; serialized payloads are whatever the user serializer wrote for
+ *  each element in turn.
+ */
+#ifndef moustached_snapshot_h
+#define moustached_snapshot_h
+
+#include <stdio.h>
+
+#define SN_VERSION 1
+#define SN_HEADERSIZE 64
+
+#define SN_RECORDS 1
+#define SN_SERIALIZED 2
+
+int SNwriteheader(FILE *, int, size_t, size_t);
+int SNreadheader(FILE *, int *, size_t *, size_t *);
+
+#endif
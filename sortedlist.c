@@ -0,0 +1,916 @@
+/**
+ *  @file   sortedlist.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Ordered list kept in a B+-tree
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "sortedlist.h"
+#include "controller.h"
+
+#ifndef MOUSTASHED_ERROR_STRINGS
+    #define MOUSTASHED_ERROR_STRINGS
+    #define S_NOMEM "Allocating memory"
+    #define S_EFAULT "Invalid handler"
+#endif
+
+#define SL_LEAFCAP ((int)((SL_NODEBYTES - 4*sizeof(void *))/sizeof(void *)))
+#define SL_INNERCAP ((int)((SL_NODEBYTES - 2*sizeof(void *) - sizeof(int))/(2*sizeof(void *) + sizeof(int))))
+#define SL_LEAFMIN (SL_LEAFCAP/2)
+#define SL_INNERMIN ((SL_INNERCAP + 1)/2)
+
+/**
+ * Struct and Type definitions
+ *
+ */
+/*
+ * Nodes have room for one entry more than they may keep, so inserting
+ * can overflow a node before it is split. The capacities leave room for
+ * that entry within SL_NODEBYTES.
+ */
+struct _Leaf {
+    int n;
+    struct _Leaf *prev;
+    struct _Leaf *next;
+    void *elems[SL_LEAFCAP + 1];
+};
+
+/*
+ * keys[i] is the first element under children[i + 1], so every element
+ * under children[i] is at most keys[i] and the list only ever routes on
+ * elements it still holds. counts[i] is the number of elements under
+ * children[i].
+ */
+struct _Inner {
+    int n;
+    void *keys[SL_INNERCAP];
+    void *children[SL_INNERCAP + 1];
+    int counts[SL_INNERCAP + 1];
+};
+
+typedef char SL_LEAFFITS[(sizeof(struct _Leaf) <= SL_NODEBYTES)?1:-1];
+typedef char SL_INNERFITS[(sizeof(struct _Inner) <= SL_NODEBYTES)?1:-1];
+
+/*
+ * height is 0 while the root is a leaf. head is the leftmost leaf.
+ */
+struct _SortedList {
+    void *root;
+    int height;
+    int used_buckets;
+    unsigned int modcount;
+    comparator cmp;
+    struct _Leaf *head;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static struct _Controller controller = CT_INITIALIZER(struct _SortedList);
+
+/**
+ * Static-scope functions declaration
+ *
+ */
+static struct _SortedList *acquire(int);
+static void *newnode(size_t);
+static void freenodes(void *, int);
+static int countof(void *, int);
+static int search(struct _SortedList *, void **, int, void *, char);
+static int bound(struct _SortedList *, void *, char);
+static struct _Leaf *locate(struct _SortedList *, int, int *);
+static void *insert(struct _SortedList *, void *, int, void *, void **);
+static void *removeat(struct _SortedList *, void *, int, int);
+static void *first(void *, int);
+static int width(void *);
+static int underflows(void *, int);
+static void fix(struct _Inner *, int, int);
+static void borrowleft(struct _Inner *, int, int);
+static void borrowright(struct _Inner *, int, int);
+static void merge(struct _Inner *, int, int);
+static void *removerank(struct _SortedList *, int);
+static int verify(struct _SortedList *, void *, int, struct _Leaf **, void **);
+static void *SLitnext(iterator *);
+static void *SLitprev(iterator *);
+static void *SLitremove(iterator *);
+static void SLupdateit(iterator *);
+static void SLresetit(iterator *);
+static struct _SortedList *acquireit(iterator *);
+static void updateit(iterator *);
+
+
+/**
+ * Functions definition
+ *
+ */
+int SLnew(comparator cmp) {
+    struct _SortedList *l = NULL;
+    int handler = -1;
+    
+    if (cmp == NULL) {
+        errno = EINVAL;
+        return -1;
+    }
+    if ((handler = CTclaim(&controller, (void **)&l)) < 0) {
+        return -1;
+    }
+    l->cmp = cmp;
+    l->head = newnode(sizeof(struct _Leaf));
+    l->root = l->head;
+    CTrelease(l);
+    return handler;
+}
+
+void SLpurge(int handler) {
+    struct _SortedList *l;
+    
+    if ((l = acquire(handler)) != NULL) {
+        freenodes(l->root, l->height);
+        l->head = newnode(sizeof(struct _Leaf));
+        l->root = l->head;
+        l->height = 0;
+        l->used_buckets = 0;
+        l->modcount++;
+        CTrelease(l);
+    }
+}
+
+void SLdispose(int handler) {
+    struct _SortedList *l;
+    
+    if ((l = acquire(handler)) != NULL) {
+        freenodes(l->root, l->height);
+        l->root = NULL;
+        l->head = NULL;
+        CTdispose(&controller, l);
+    }
+}
+
+/*
+ * Adds elem after every element equal to it and returns it.
+ */
+void *SLinsert(int handler, void *elem) {
+    struct _SortedList *l;
+    struct _Inner *root = NULL;
+    void *right = NULL;
+    void *sep = NULL;
+    
+    if ((l = acquire(handler)) != NULL) {
+        if ((right = insert(l, l->root, l->height, elem, &sep)) != NULL) {
+            root = newnode(sizeof(struct _Inner));
+            root->n = 2;
+            root->keys[0] = sep;
+            root->children[0] = l->root;
+            root->children[1] = right;
+            root->counts[0] = countof(l->root, l->height);
+            root->counts[1] = countof(right, l->height);
+            l->root = root;
+            l->height++;
+        }
+        l->used_buckets++;
+        l->modcount++;
+        CTrelease(l);
+    }
+    return elem;
+}
+
+/*
+ * Removes the first element equal to key and returns it, or NULL if
+ * there is none.
+ */
+void *SLremove(int handler, void *key) {
+    struct _SortedList *l;
+    struct _Leaf *leaf = NULL;
+    void *elem = NULL;
+    int i = 0;
+    int off = 0;
+    
+    if ((l = acquire(handler)) != NULL) {
+        i = bound(l, key, 0);
+        if (i < l->used_buckets) {
+            leaf = locate(l, i, &off);
+            if (l->cmp(leaf->elems[off], key) == 0) {
+                elem = removerank(l, i);
+            }
+        }
+        CTrelease(l);
+    }
+    return elem;
+}
+
+void *SLremoveat(int handler, int i) {
+    struct _SortedList *l;
+    void *elem = NULL;
+    
+    if ((l = acquire(handler)) != NULL) {
+        if ((i >= 0) && (i < l->used_buckets)) {
+            elem = removerank(l, i);
+        } else {
+            errno = EFAULT;
+        }
+        CTrelease(l);
+    }
+    return elem;
+}
+
+/*
+ * The first element equal to key, or NULL.
+ */
+void *SLfind(int handler, void *key) {
+    struct _SortedList *l;
+    struct _Leaf *leaf = NULL;
+    void *elem = NULL;
+    int off = 0;
+    
+    if ((l = acquire(handler)) != NULL) {
+        leaf = locate(l, bound(l, key, 0), &off);
+        if (off == leaf->n) {
+            leaf = leaf->next;
+            off = 0;
+        }
+        if ((leaf != NULL) && (off < leaf->n) && (l->cmp(leaf->elems[off], key) == 0)) {
+            elem = leaf->elems[off];
+        }
+        CTrelease(l);
+    }
+    return elem;
+}
+
+/*
+ * The element at position i, in O(log n).
+ */
+void *SLget(int handler, int i) {
+    struct _SortedList *l;
+    struct _Leaf *leaf = NULL;
+    void *elem = NULL;
+    int off = 0;
+    
+    if ((l = acquire(handler)) != NULL) {
+        if ((i >= 0) && (i < l->used_buckets)) {
+            leaf = locate(l, i, &off);
+            elem = leaf->elems[off];
+        }
+        CTrelease(l);
+    }
+    return elem;
+}
+
+/*
+ * Position of the first element equal to key, or -1.
+ */
+int SLindexof(int handler, void *key) {
+    struct _SortedList *l;
+    struct _Leaf *leaf = NULL;
+    int i = -1;
+    int off = 0;
+    
+    if ((l = acquire(handler)) != NULL) {
+        i = bound(l, key, 0);
+        if (i < l->used_buckets) {
+            leaf = locate(l, i, &off);
+            if (l->cmp(leaf->elems[off], key) != 0) {
+                i = -1;
+            }
+        } else {
+            i = -1;
+        }
+        CTrelease(l);
+    }
+    return i;
+}
+
+/*
+ * Position of the first element not less than key, or the size of the
+ * list.
+ */
+int SLlowerbound(int handler, void *key) {
+    struct _SortedList *l;
+    int i = -1;
+    
+    if ((l = acquire(handler)) != NULL) {
+        i = bound(l, key, 0);
+        CTrelease(l);
+    }
+    return i;
+}
+
+/*
+ * Position of the first element greater than key, or the size of the
+ * list.
+ */
+int SLupperbound(int handler, void *key) {
+    struct _SortedList *l;
+    int i = -1;
+    
+    if ((l = acquire(handler)) != NULL) {
+        i = bound(l, key, 1);
+        CTrelease(l);
+    }
+    return i;
+}
+
+int SLsize(int handler) {
+    struct _SortedList *l;
+    int size = -1;
+    
+    if ((l = acquire(handler)) != NULL) {
+        size = l->used_buckets;
+        CTrelease(l);
+    }
+    return size;
+}
+
+/*
+ * Walks the whole tree, in O(n), checking that elements are in order,
+ * that every node but the root is at least half full, that counts and
+ * the leaf links match the nodes and that keys[i] is the first element
+ * under children[i + 1]. Returns 0, or -1 with errno set to EINVAL at
+ * the first thing that does not hold.
+ */
+int SLverify(int handler) {
+    struct _SortedList *l;
+    struct _Leaf *leaf = NULL;
+    void *prev = NULL;
+    int status = -1;
+    
+    if ((l = acquire(handler)) != NULL) {
+        leaf = l->head;
+        if ((l->head->prev == NULL)
+            && (verify(l, l->root, l->height, &leaf, &prev) == l->used_buckets)
+            && (leaf == NULL)) {
+            status = 0;
+        } else {
+            errno = EINVAL;
+        }
+        CTrelease(l);
+    }
+    return status;
+}
+
+iterator SLiterator(int handler) {
+    return SLrange(handler, NULL, NULL);
+}
+
+/*
+ * Moving back with prev or reset may go before from.
+ */
+iterator SLrange(int handler, void *from, void *to) {
+    struct _SortedList *l;
+    iterator it;
+    
+    memset(&it, 0, sizeof(it));
+    it.handler = -1;
+    if ((l = acquire(handler)) != NULL) {
+        it.handler = handler;
+        it.carriage = (from != NULL)?bound(l, from, 0):0;
+        it.total_elems = (to != NULL)?bound(l, to, 0):l->used_buckets;
+        if (it.total_elems < it.carriage) {
+            it.total_elems = it.carriage;
+        }
+        it.cursor = locate(l, it.carriage, &it.offset);
+        it.last = NULL;
+        it.modcount = l->modcount;
+        it.next = SLitnext;
+        it.prev = SLitprev;
+        it.remove = SLitremove;
+        it.insert = NULL;
+        it.update = SLupdateit;
+        it.reset = SLresetit;
+        updateit(&it);
+        CTrelease(l);
+    }
+    return it;
+}
+
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static struct _SortedList *acquire(int handler) {
+    struct _SortedList *l = CTacquire(&controller, handler);
+    if (l == NULL) {
+        perror(S_EFAULT);
+    }
+    return l;
+}
+
+/*
+ * Nodes start on a cache line, so a node spans as few of them as it can.
+ */
+static void *newnode(size_t size) {
+    void *node = NULL;
+    
+    if (posix_memalign(&node, CT_CACHELINE, size) != 0) {
+        perror(S_NOMEM);
+        exit(EXIT_FAILURE);
+    }
+    memset(node, 0, size);
+    return node;
+}
+
+static void freenodes(void *node, int height) {
+    struct _Inner *in = node;
+    int i = 0;
+    
+    if (height > 0) {
+        for (i = 0; i < in->n; i++) {
+            freenodes(in->children[i], height - 1);
+        }
+    }
+    free(node);
+}
+
+static int countof(void *node, int height) {
+    struct _Inner *in = node;
+    int count = 0;
+    int i = 0;
+    
+    if (height == 0) {
+        return ((struct _Leaf *)node)->n;
+    }
+    for (i = 0; i < in->n; i++) {
+        count += in->counts[i];
+    }
+    return count;
+}
+
+/*
+ * Index of the first of the n sorted entries not less than key, or
+ * greater than key when upper is set.
+ */
+static int search(struct _SortedList *l, void **v, int n, void *key, char upper) {
+    int lo = 0, hi = n, mid = 0;
+    
+    while (lo < hi) {
+        mid = lo + ((hi - lo) >> 1);
+        if ((upper && (l->cmp(v[mid], key) <= 0)) || (!upper && (l->cmp(v[mid], key) < 0))) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/*
+ * The child picked by the separators holds the bound or ends right
+ * before it, so the counts of the children left of it give its rank.
+ */
+static int bound(struct _SortedList *l, void *key, char upper) {
+    struct _Inner *in = NULL;
+    void *node = l->root;
+    int rank = 0;
+    int h = 0, c = 0, i = 0;
+    
+    for (h = l->height; h > 0; h--) {
+        in = node;
+        c = search(l, in->keys, in->n - 1, key, upper);
+        for (i = 0; i < c; i++) {
+            rank += in->counts[i];
+        }
+        node = in->children[c];
+    }
+    return rank + search(l, ((struct _Leaf *)node)->elems, ((struct _Leaf *)node)->n, key, upper);
+}
+
+/*
+ * The leaf holding position i and its offset there. Position size gives
+ * the end of the last leaf.
+ */
+static struct _Leaf *locate(struct _SortedList *l, int i, int *off) {
+    struct _Inner *in = NULL;
+    void *node = l->root;
+    int h = 0, c = 0;
+    
+    for (h = l->height; h > 0; h--) {
+        in = node;
+        for (c = 0; (c < in->n - 1) && (i >= in->counts[c]); c++) {
+            i -= in->counts[c];
+        }
+        node = in->children[c];
+    }
+    *off = i;
+    return node;
+}
+
+/*
+ * Adds elem under node. Returns the new right sibling when node had to
+ * split, with the separator between the two in *sep.
+ */
+static void *insert(struct _SortedList *l, void *node, int height, void *elem, void **sep) {
+    struct _Leaf *leaf = node, *rleaf = NULL;
+    struct _Inner *in = node, *rin = NULL;
+    void *right = NULL;
+    void *s = NULL;
+    int k = 0, half = 0;
+    
+    if (height == 0) {
+        k = search(l, leaf->elems, leaf->n, elem, 1);
+        memmove(&leaf->elems[k + 1], &leaf->elems[k], sizeof(void *)*(leaf->n - k));
+        leaf->elems[k] = elem;
+        if (++leaf->n <= SL_LEAFCAP) {
+            return NULL;
+        }
+        rleaf = newnode(sizeof(struct _Leaf));
+        half = leaf->n/2;
+        rleaf->n = leaf->n - half;
+        memcpy(rleaf->elems, &leaf->elems[half], sizeof(void *)*rleaf->n);
+        leaf->n = half;
+        rleaf->prev = leaf;
+        rleaf->next = leaf->next;
+        if (leaf->next != NULL) {
+            leaf->next->prev = rleaf;
+        }
+        leaf->next = rleaf;
+        *sep = rleaf->elems[0];
+        return rleaf;
+    }
+    
+    k = search(l, in->keys, in->n - 1, elem, 1);
+    in->counts[k]++;
+    if ((right = insert(l, in->children[k], height - 1, elem, &s)) == NULL) {
+        return NULL;
+    }
+    memmove(&in->keys[k + 1], &in->keys[k], sizeof(void *)*(in->n - 1 - k));
+    memmove(&in->children[k + 2], &in->children[k + 1], sizeof(void *)*(in->n - 1 - k));
+    memmove(&in->counts[k + 2], &in->counts[k + 1], sizeof(int)*(in->n - 1 - k));
+    in->keys[k] = s;
+    in->children[k + 1] = right;
+    in->counts[k + 1] = countof(right, height - 1);
+    in->counts[k] -= in->counts[k + 1];
+    if (++in->n <= SL_INNERCAP) {
+        return NULL;
+    }
+    rin = newnode(sizeof(struct _Inner));
+    half = in->n/2;
+    rin->n = in->n - half;
+    memcpy(rin->children, &in->children[half], sizeof(void *)*rin->n);
+    memcpy(rin->counts, &in->counts[half], sizeof(int)*rin->n);
+    memcpy(rin->keys, &in->keys[half], sizeof(void *)*(rin->n - 1));
+    *sep = in->keys[half - 1];
+    in->n = half;
+    return rin;
+}
+
+/*
+ * Removing the first element of a child other than the first leaves its
+ * separator pointing at an element the list no longer holds, so it is
+ * replaced with the new first one before the child is refilled.
+ */
+static void *removeat(struct _SortedList *l, void *node, int height, int i) {
+    struct _Leaf *leaf = node;
+    struct _Inner *in = node;
+    void *elem = NULL;
+    int c = 0;
+    
+    if (height == 0) {
+        elem = leaf->elems[i];
+        memmove(&leaf->elems[i], &leaf->elems[i + 1], sizeof(void *)*(leaf->n - i - 1));
+        leaf->n--;
+        return elem;
+    }
+    for (c = 0; i >= in->counts[c]; c++) {
+        i -= in->counts[c];
+    }
+    elem = removeat(l, in->children[c], height - 1, i);
+    in->counts[c]--;
+    if ((i == 0) && (c > 0)) {
+        in->keys[c - 1] = first(in->children[c], height - 1);
+    }
+    if (underflows(in->children[c], height - 1)) {
+        fix(in, c, height - 1);
+    }
+    return elem;
+}
+
+/*
+ * Number of elements under node, or -1 if it breaks an invariant.
+ * *leaf is the leaf the walk should reach next and *prev the last
+ * element it saw.
+ */
+static int verify(struct _SortedList *l, void *node, int height, struct _Leaf **leaf, void **prev) {
+    struct _Inner *in = node;
+    struct _Leaf *lf = node;
+    int root = (node == l->root);
+    int count = 0, c = 0, i = 0;
+    
+    if (height == 0) {
+        if ((lf != *leaf) || (lf->n > SL_LEAFCAP) || (!root && (lf->n < SL_LEAFMIN))
+            || ((lf->next != NULL) && (lf->next->prev != lf))) {
+            return -1;
+        }
+        for (i = 0; i < lf->n; i++) {
+            if ((*prev != NULL) && (l->cmp(*prev, lf->elems[i]) > 0)) {
+                return -1;
+            }
+            *prev = lf->elems[i];
+        }
+        *leaf = lf->next;
+        return lf->n;
+    }
+    if ((in->n > SL_INNERCAP) || (in->n < (root?2:SL_INNERMIN))) {
+        return -1;
+    }
+    for (i = 0; i < in->n; i++) {
+        if ((i > 0) && (in->keys[i - 1] != first(in->children[i], height - 1))) {
+            return -1;
+        }
+        if (((c = verify(l, in->children[i], height - 1, leaf, prev)) < 0)
+            || (c != in->counts[i])) {
+            return -1;
+        }
+        count += c;
+    }
+    return count;
+}
+
+static void *first(void *node, int height) {
+    for (; height > 0; height--) {
+        node = ((struct _Inner *)node)->children[0];
+    }
+    return ((struct _Leaf *)node)->elems[0];
+}
+
+/*
+ * Both kinds of node start with their number of entries.
+ */
+static int width(void *node) {
+    return ((struct _Leaf *)node)->n;
+}
+
+static int underflows(void *node, int height) {
+    return width(node) < ((height == 0)?SL_LEAFMIN:SL_INNERMIN);
+}
+
+/*
+ * Refills child c of p, at the given height, from a sibling that can
+ * spare an entry, or merges it with one.
+ */
+static void fix(struct _Inner *p, int c, int height) {
+    int min = (height == 0)?SL_LEAFMIN:SL_INNERMIN;
+    
+    if ((c > 0) && (width(p->children[c - 1]) > min)) {
+        borrowleft(p, c, height);
+    } else if ((c < p->n - 1) && (width(p->children[c + 1]) > min)) {
+        borrowright(p, c, height);
+    } else if (c > 0) {
+        merge(p, c - 1, height);
+    } else if (p->n > 1) {
+        merge(p, c, height);
+    }
+}
+
+static void borrowleft(struct _Inner *p, int c, int height) {
+    struct _Leaf *lc = p->children[c], *ll = p->children[c - 1];
+    struct _Inner *ic = p->children[c], *il = p->children[c - 1];
+    int moved = 1;
+    
+    if (height == 0) {
+        memmove(&lc->elems[1], &lc->elems[0], sizeof(void *)*lc->n);
+        lc->elems[0] = ll->elems[--ll->n];
+        lc->n++;
+        p->keys[c - 1] = lc->elems[0];
+    } else {
+        memmove(&ic->keys[1], &ic->keys[0], sizeof(void *)*(ic->n - 1));
+        memmove(&ic->children[1], &ic->children[0], sizeof(void *)*ic->n);
+        memmove(&ic->counts[1], &ic->counts[0], sizeof(int)*ic->n);
+        ic->keys[0] = p->keys[c - 1];
+        ic->children[0] = il->children[il->n - 1];
+        ic->counts[0] = il->counts[il->n - 1];
+        p->keys[c - 1] = il->keys[il->n - 2];
+        moved = ic->counts[0];
+        il->n--;
+        ic->n++;
+    }
+    p->counts[c - 1] -= moved;
+    p->counts[c] += moved;
+}
+
+static void borrowright(struct _Inner *p, int c, int height) {
+    struct _Leaf *lc = p->children[c], *lr = p->children[c + 1];
+    struct _Inner *ic = p->children[c], *ir = p->children[c + 1];
+    int moved = 1;
+    
+    if (height == 0) {
+        lc->elems[lc->n++] = lr->elems[0];
+        memmove(&lr->elems[0], &lr->elems[1], sizeof(void *)*(--lr->n));
+        p->keys[c] = lr->elems[0];
+    } else {
+        ic->keys[ic->n - 1] = p->keys[c];
+        ic->children[ic->n] = ir->children[0];
+        ic->counts[ic->n] = ir->counts[0];
+        moved = ir->counts[0];
+        ic->n++;
+        p->keys[c] = ir->keys[0];
+        memmove(&ir->keys[0], &ir->keys[1], sizeof(void *)*(ir->n - 2));
+        memmove(&ir->children[0], &ir->children[1], sizeof(void *)*(ir->n - 1));
+        memmove(&ir->counts[0], &ir->counts[1], sizeof(int)*(ir->n - 1));
+        ir->n--;
+    }
+    p->counts[c] += moved;
+    p->counts[c + 1] -= moved;
+}
+
+/*
+ * Folds child j + 1 of p into child j.
+ */
+static void merge(struct _Inner *p, int j, int height) {
+    struct _Leaf *lx = p->children[j], *ly = p->children[j + 1];
+    struct _Inner *ix = p->children[j], *iy = p->children[j + 1];
+    
+    if (height == 0) {
+        memcpy(&lx->elems[lx->n], ly->elems, sizeof(void *)*ly->n);
+        lx->n += ly->n;
+        lx->next = ly->next;
+        if (ly->next != NULL) {
+            ly->next->prev = lx;
+        }
+    } else {
+        ix->keys[ix->n - 1] = p->keys[j];
+        memcpy(&ix->keys[ix->n], iy->keys, sizeof(void *)*(iy->n - 1));
+        memcpy(&ix->children[ix->n], iy->children, sizeof(void *)*iy->n);
+        memcpy(&ix->counts[ix->n], iy->counts, sizeof(int)*iy->n);
+        ix->n += iy->n;
+    }
+    free(p->children[j + 1]);
+    p->counts[j] += p->counts[j + 1];
+    memmove(&p->keys[j], &p->keys[j + 1], sizeof(void *)*(p->n - 2 - j));
+    memmove(&p->children[j + 1], &p->children[j + 2], sizeof(void *)*(p->n - 2 - j));
+    memmove(&p->counts[j + 1], &p->counts[j + 2], sizeof(int)*(p->n - 2 - j));
+    p->n--;
+}
+
+/*
+ * Removes position i and drops the root while it has a single child.
+ */
+static void *removerank(struct _SortedList *l, int i) {
+    struct _Inner *root = NULL;
+    void *elem = removeat(l, l->root, l->height, i);
+    
+    while ((l->height > 0) && (((struct _Inner *)l->root)->n == 1)) {
+        root = l->root;
+        l->root = root->children[0];
+        l->height--;
+        free(root);
+    }
+    l->used_buckets--;
+    l->modcount++;
+    return elem;
+}
+
+/*
+ * cursor is the leaf of the next element and offset its index there;
+ * last points at the slot of the element returned last.
+ */
+static void *SLitnext(iterator *it) {
+    struct _SortedList *l = NULL;
+    struct _Leaf *leaf = NULL;
+    void *elem = NULL;
+    
+    if (it->hasnext && ((l = acquireit(it)) != NULL)) {
+        leaf = it->cursor;
+        if (it->offset == leaf->n) {
+            leaf = leaf->next;
+            it->offset = 0;
+        }
+        elem = leaf->elems[it->offset];
+        it->last = &leaf->elems[it->offset];
+        it->cursor = leaf;
+        it->offset++;
+        it->carriage++;
+        updateit(it);
+        CTrelease(l);
+    }
+    return elem;
+}
+
+static void *SLitprev(iterator *it) {
+    struct _SortedList *l = NULL;
+    struct _Leaf *leaf = NULL;
+    void *elem = NULL;
+    
+    if (it->hasprev && ((l = acquireit(it)) != NULL)) {
+        leaf = it->cursor;
+        if (it->offset == 0) {
+            leaf = leaf->prev;
+            it->offset = leaf->n;
+        }
+        it->offset--;
+        elem = leaf->elems[it->offset];
+        it->last = &leaf->elems[it->offset];
+        it->cursor = leaf;
+        it->carriage--;
+        updateit(it);
+        CTrelease(l);
+    }
+    return elem;
+}
+
+/*
+ * Removes the element returned by the last call to next or prev. The
+ * tree may have been rebalanced, so the cursor is looked up again.
+ */
+static void *SLitremove(iterator *it) {
+    struct _SortedList *l = NULL;
+    void *elem = NULL;
+    
+    if ((l = acquireit(it)) != NULL) {
+        if (it->last != NULL) {
+            if (it->last != &((struct _Leaf *)it->cursor)->elems[it->offset]) {
+                it->carriage--;
+            }
+            elem = removerank(l, it->carriage);
+            it->total_elems--;
+            it->cursor = locate(l, it->carriage, &it->offset);
+            it->last = NULL;
+            it->modcount = l->modcount;
+            updateit(it);
+        } else {
+            errno = EINVAL;
+        }
+        CTrelease(l);
+    }
+    return elem;
+}
+
+static void SLupdateit(iterator *it) {
+    struct _SortedList *l = NULL;
+    
+    if ((l = acquireit(it)) != NULL) {
+        updateit(it);
+        CTrelease(l);
+    }
+}
+
+static void SLresetit(iterator *it) {
+    struct _SortedList *l = NULL;
+    
+    if ((l = acquireit(it)) != NULL) {
+        it->carriage = 0;
+        it->cursor = l->head;
+        it->offset = 0;
+        it->last = NULL;
+        updateit(it);
+        CTrelease(l);
+    }
+}
+
+/*
+ * Locks the list behind an iterator, failing with EFAULT once the list
+ * has been changed other than through the iterator.
+ */
+static struct _SortedList *acquireit(iterator *it) {
+    struct _SortedList *l = NULL;
+    
+    if ((l = CTacquire(&controller, it->handler)) != NULL) {
+        if (it->modcount == l->modcount) {
+            return l;
+        }
+        CTrelease(l);
+    }
+    errno = EFAULT;
+    it->hasnext = 0;
+    it->hasprev = 0;
+    return NULL;
+}
+
+/*
+ * total_elems is where the range ends.
+ */
+static void updateit(iterator *it) {
+    it->hasnext = (it->carriage < it->total_elems)?1:0;
+    it->hasprev = (it->carriage > 0)?1:0;
+}
@@ -0,0 +1,101 @@
+/**
+ *  @file   sortedlist.h
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Ordered list kept in a B+-tree
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Elements are kept in the order of the list's comparator, equal ones
+ *  in the order they were added, in the leaves of a B+-tree whose nodes
+ *  span SL_NODEBYTES. Leaves are linked both ways, so iterators walk them
+ *  without going back up the tree, and inner nodes count the elements
+ *  under each child, so an element's position and the element at a
+ *  position are both found in O(log n). Keys passed to the search
+ *  functions are handed to the comparator as if they were elements.
+ *
+ *  SLrange iterates from the first element not less than from up to the
+ *  first one not less than to, NULL meaning either end of the list.
+ *  Changing the list other than through the iterator invalidates it.
+ */
+#ifndef moustached_sortedlist_h
+#define moustached_sortedlist_h
+
+#include <stddef.h>
+
+#define SL_NODEBYTES 512
+
+#if !defined(MOUSTASHED_ITERATOR)
+#define MOUSTASHED_ITERATOR
+struct _Iterator {
+    int handler;
+    int carriage;
+    int total_elems;
+    unsigned int modcount;
+    
+    char hasnext;
+    char hasprev;
+    
+    void *cursor;
+    void *last;
+    int offset;
+    
+    void (*update)(struct _Iterator*);
+    void (*reset)(struct _Iterator*);
+    void *(*next)(struct _Iterator*);
+    void *(*prev)(struct _Iterator*);
+    void *(*remove)(struct _Iterator*);
+    void *(*insert)(struct _Iterator*, void*);
+};
+typedef struct _Iterator iterator;
+#endif
+
+#if !defined(MOUSTASHED_COMPARATOR)
+#define MOUSTASHED_COMPARATOR
+typedef int (*comparator)(const void*, const void*);
+#endif
+
+typedef int SortedList;
+
+
+SortedList SLnew(comparator);
+void SLpurge(SortedList);
+void SLdispose(SortedList);
+
+void *SLinsert(SortedList, void*);
+void *SLremove(SortedList, void*);
+void *SLremoveat(SortedList, int);
+
+void *SLfind(SortedList, void*);
+void *SLget(SortedList, int);
+int SLindexof(SortedList, void*);
+int SLlowerbound(SortedList, void*);
+int SLupperbound(SortedList, void*);
+int SLsize(SortedList);
+int SLverify(SortedList);
+
+iterator SLiterator(SortedList);
+iterator SLrange(SortedList, void*, void*);
+
+#endif
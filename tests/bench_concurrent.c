@@ -0,0 +1,130 @@
+/**
+ *  @file   bench_slab.c
+ *  @link   https://github.com/joaolpinho
+ *  @brief  Append throughput of concurrent ArrayLists from 1 to 64 producers
+ *  @brief  LinkedList node slabs against one malloc per node
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Producers split a fixed number of appends between them, on a list
+ *  made by ALnewconcurrent and on a locked segmented and a locked plain
+ *  list for comparison. The sum of the elements checks nothing was lost.
+ */
+#include "harness.h"
+#include <pthread.h>
+#include "arraylist.h"
+
+#define MAXPRODUCERS 64
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Kind {
+    const char *name;
+    ArrayList (*create)(void);
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static ArrayList list = -1;
+static long total = 0;
+static int producers = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static ArrayList newconcurrent(void) {
+    return ALnewconcurrent(0, 0);
+}
+
+static ArrayList newsegmented(void) {
+    return ALnewsegmented(0, 0);
+}
+
+static ArrayList newplain(void) {
+    return ALnew(0);
+}
+
+static void *produce(void *arg) {
+    long id = (long)(size_t)arg;
+    long i = 0;
+    
+    for (i = id; i < total; i += producers) {
+        ALadd(list, (void *)(i + 1));
+    }
+    return NULL;
+}
+
+static double run(const struct _Kind *kind, int nproducers) {
+    pthread_t threads[MAXPRODUCERS];
+    iterator it;
+    unsigned long sum = 0;
+    double t = 0;
+    long i = 0;
+    
+    list = kind->create();
+    CHECK(list >= 0);
+    producers = nproducers;
+    t = seconds();
+    for (i = 0; i < nproducers; i++) {
+        CHECK(pthread_create(&threads[i], NULL, produce, (void *)(size_t)i) == 0);
+    }
+    for (i = 0; i < nproducers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    t = seconds() - t;
+    CHECK(ALsize(list) == total);
+    it = ALiterator(list);
+    while (it.hasnext) {
+        sum += (unsigned long)it.next(&it);
+    }
+    CHECK(sum == (unsigned long)total*(total + 1)/2);
+    ALdispose(list);
+    return t;
+}
+
+
+int main(int argc, char **argv) {
+    static const struct _Kind kinds[] = {
+        { "concurrent", newconcurrent },
+        { "segmented", newsegmented },
+        { "plain", newplain }
+    };
+    double t = 0;
+    int n = 0, k = 0;
+    
+    total = sizearg(argc, argv, 2000000);
+    printf("%10s %12s %12s %12s\n", "producers", "list", "Mappends/s", "ns/append");
+    for (n = 1; n <= MAXPRODUCERS; n *= 2) {
+        for (k = 0; k < 3; k++) {
+            t = run(&kinds[k], n);
+            printf("%10d %12s %12.2f %12.1f\n", n, kinds[k].name, total/t*1e-6, t*1e9/total);
+        }
+    }
+    return 0;
+}
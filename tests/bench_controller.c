@@ -0,0 +1,108 @@
+/**
+ *  @file   bench_slab.c
+ *  @link   https://github.com/joaolpinho
+ *  @brief  Handle controller throughput from one thread to every core
+ *  @brief  LinkedList node slabs against one malloc per node
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Every thread repeatedly claims a list, appends to and reads from it
+ *  and disposes it, then reads and writes a list of its own that lives
+ *  for the whole run. The first part goes through the controller lock,
+ *  the second only through handle lookups. Doubling the threads up to
+ *  the number of online cores shows how both scale.
+ */
+#include "harness.h"
+#include <pthread.h>
+#include <unistd.h>
+#include "arraylist.h"
+
+#define MAXTHREADS 256
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static long rounds = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *churn(void *arg) {
+    ArrayList own = ALnew(0);
+    ArrayList list = -1;
+    long i = 0;
+    
+    (void)arg;
+    for (i = 0; i < rounds; i++) {
+        list = ALnew(4);
+        ALadd(list, (void *)(i + 1));
+        CHECK(ALget(list, 0) == (void *)(i + 1));
+        ALdispose(list);
+        ALadd(own, (void *)(i + 1));
+        CHECK(ALget(own, (int)(i/2)) == (void *)(i/2 + 1));
+    }
+    ALdispose(own);
+    return NULL;
+}
+
+static double run(int nthreads) {
+    pthread_t threads[MAXTHREADS];
+    double t = 0;
+    int i = 0;
+    
+    t = seconds();
+    for (i = 0; i < nthreads; i++) {
+        CHECK(pthread_create(&threads[i], NULL, churn, NULL) == 0);
+    }
+    for (i = 0; i < nthreads; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    return seconds() - t;
+}
+
+
+int main(int argc, char **argv) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    double t = 0, base = 0;
+    int n = 0;
+    
+    rounds = sizearg(argc, argv, 200000);
+    if (cores < 1) {
+        cores = 1;
+    }
+    if (cores > MAXTHREADS) {
+        cores = MAXTHREADS;
+    }
+    printf("%8s %12s %12s %10s\n", "threads", "Mrounds/s", "ns/round", "speedup");
+    for (n = 1; n <= cores; n = (n*2 > cores && n < cores)?(int)cores:n*2) {
+        t = run(n);
+        if (n == 1) {
+            base = rounds/t;
+        }
+        printf("%8d %12.2f %12.1f %10.2f\n", n, n*rounds/t*1e-6, t*1e9/rounds, n*rounds/t/base);
+    }
+    return 0;
+}
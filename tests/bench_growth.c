@@ -0,0 +1,161 @@
+/**
+ *  @file   bench_slab.c
+ *  @link   https://github.com/joaolpinho
+ *  @brief  Append throughput and memory overhead of each growth policy
+ *  @brief  LinkedList node slabs against one malloc per node
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Appends n elements to an empty list under each growth policy, then
+ *  reports the time per append, the reallocations counted through an
+ *  allocator handed to ALnewwith, and the capacity over n before and
+ *  after ALshrinktofit. A list reserved up front is the baseline.
+ */
+#include "harness.h"
+#include "arraylist.h"
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Policy {
+    const char *name;
+    void (*apply)(ArrayList, long);
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static unsigned long resizes = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *countalloc(size_t size, void *ctx) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void *countresize(void *p, size_t old, size_t size, void *ctx) {
+    (void)old;
+    (void)ctx;
+    resizes++;
+    return realloc(p, size);
+}
+
+static void countrelease(void *p, size_t size, void *ctx) {
+    (void)size;
+    (void)ctx;
+    free(p);
+}
+
+/*
+ * The next power of two, as a policy given through ALgrowwith.
+ */
+static int powerof2(int total, int needed, void *ctx) {
+    (void)ctx;
+    if (total < 1) {
+        total = 1;
+    }
+    while (total < needed) {
+        total *= 2;
+    }
+    return total;
+}
+
+static void bydefault(ArrayList list, long n) {
+    (void)list;
+    (void)n;
+}
+
+static void byhalf(ArrayList list, long n) {
+    (void)n;
+    CHECK(ALgrowbyfactor(list, 1.5) == 0);
+}
+
+static void bydouble(ArrayList list, long n) {
+    (void)n;
+    CHECK(ALgrowbyfactor(list, 2.0) == 0);
+}
+
+static void byamount(ArrayList list, long n) {
+    (void)n;
+    CHECK(ALgrowbyamount(list, 65536) == 0);
+}
+
+static void bycallback(ArrayList list, long n) {
+    (void)n;
+    CHECK(ALgrowwith(list, powerof2, NULL) == 0);
+}
+
+static void reserved(ArrayList list, long n) {
+    CHECK(ALreserve(list, (int)n) >= n);
+}
+
+static void run(const struct _Policy *p, long n) {
+    allocator counting = { countalloc, countresize, countrelease, NULL };
+    ArrayList list = ALnewwith(0, 0, &counting);
+    double t = 0, grown = 0;
+    long i = 0;
+    
+    CHECK(list >= 0);
+    resizes = 0;
+    t = seconds();
+    p->apply(list, n);
+    for (i = 0; i < n; i++) {
+        ALadd(list, (void *)(i + 1));
+    }
+    t = seconds() - t;
+    CHECK(ALsize(list) == n);
+    grown = (double)ALcapacity(list)/n;
+    CHECK(ALshrinktofit(list) >= n);
+    printf("%10ld %10s %10.2f %10lu %10.3f %10.3f\n", n, p->name, t*1e9/n,
+           resizes, grown, (double)ALcapacity(list)/n);
+    ALdispose(list);
+}
+
+
+int main(int argc, char **argv) {
+    static const struct _Policy policies[] = {
+        { "default", bydefault },
+        { "x1.5", byhalf },
+        { "x2", bydouble },
+        { "+65536", byamount },
+        { "pow2", bycallback },
+        { "reserved", reserved }
+    };
+    long max = sizearg(argc, argv, 10000000);
+    long n = 0;
+    int k = 0;
+    
+    printf("%10s %10s %10s %10s %10s %10s\n", "n", "policy", "ns/append", "reallocs", "cap/n", "fit cap/n");
+    for (n = 10000; n <= max; n *= 10) {
+        for (k = 0; k < (int)(sizeof(policies)/sizeof(policies[0])); k++) {
+            run(&policies[k], n);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+/**
+ *  @file   bench_slab.c
+ *  @link   https://github.com/joaolpinho
+ *  @brief  HashMap lookups against a linear scan of an ArrayList
+ *  @brief  LinkedList node slabs against one malloc per node
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Stores n keys, compared by address, in a HashMap, and the same keys
+ *  in one ArrayList with their values in another, looked up with
+ *  ALindexof as a map would have been before. Times the inserts, random
+ *  hits and misses of both. A scan costs O(n), so the lists are only
+ *  probed SCANWORK/n times, and only that many of the last keys are
+ *  inserted checking they are not there yet.
+ */
+#include "harness.h"
+#include "arraylist.h"
+#include "hashmap.h"
+
+#define LOOKUPS 1000000
+#define SCANWORK 100000000L
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *value(long key) {
+    return (void *)(key*2);
+}
+
+static void runmap(long n, double *ns) {
+    unsigned long state = 0x9E3779B97F4A7C15UL;
+    HashMap map = HMnew(0, NULL, NULL);
+    double t = 0;
+    long i = 0, k = 0;
+    
+    CHECK(map >= 0);
+    t = seconds();
+    for (i = 1; i <= n; i++) {
+        HMput(map, (void *)i, value(i));
+    }
+    ns[0] = (seconds() - t)*1e9/n;
+    CHECK(HMsize(map) == n);
+    
+    t = seconds();
+    for (i = 0; i < LOOKUPS; i++) {
+        k = 1 + (long)(nextrand(&state) % (unsigned long)n);
+        CHECK(HMget(map, (void *)k) == value(k));
+    }
+    ns[1] = (seconds() - t)*1e9/LOOKUPS;
+    
+    t = seconds();
+    for (i = 0; i < LOOKUPS; i++) {
+        k = n + 1 + (long)(nextrand(&state) % (unsigned long)n);
+        CHECK(HMget(map, (void *)k) == NULL);
+    }
+    ns[2] = (seconds() - t)*1e9/LOOKUPS;
+    HMdispose(map);
+}
+
+static void runscan(long n, double *ns) {
+    unsigned long state = 0x9E3779B97F4A7C15UL;
+    ArrayList keys = ALnew(0), values = ALnew(0);
+    long probes = (SCANWORK/n > LOOKUPS)?LOOKUPS:SCANWORK/n;
+    double t = 0;
+    long i = 0, k = 0;
+    int at = 0;
+    
+    if (probes < 16) {
+        probes = 16;
+    }
+    if (probes > n) {
+        probes = n;
+    }
+    for (i = 1; i <= n - probes; i++) {
+        ALadd(keys, (void *)i);
+        ALadd(values, value(i));
+    }
+    t = seconds();
+    for (; i <= n; i++) {
+        if (ALindexof(keys, (void *)i) < 0) {
+            ALadd(keys, (void *)i);
+            ALadd(values, value(i));
+        }
+    }
+    ns[0] = (seconds() - t)*1e9/probes;
+    
+    t = seconds();
+    for (i = 0; i < probes; i++) {
+        k = 1 + (long)(nextrand(&state) % (unsigned long)n);
+        CHECK((at = ALindexof(keys, (void *)k)) >= 0);
+        CHECK(ALget(values, at) == value(k));
+    }
+    ns[1] = (seconds() - t)*1e9/probes;
+    
+    t = seconds();
+    for (i = 0; i < probes; i++) {
+        k = n + 1 + (long)(nextrand(&state) % (unsigned long)n);
+        CHECK(ALindexof(keys, (void *)k) < 0);
+    }
+    ns[2] = (seconds() - t)*1e9/probes;
+    ALdispose(keys);
+    ALdispose(values);
+}
+
+
+int main(int argc, char **argv) {
+    long max = sizearg(argc, argv, 10000000);
+    double map[3], scan[3];
+    long n = 0;
+    
+    printf("%10s %12s %14s %12s %12s\n", "keys", "container", "insert ns/key", "hit ns", "miss ns");
+    for (n = 1000; n <= max; n *= 10) {
+        runmap(n, map);
+        runscan(n, scan);
+        printf("%10ld %12s %14.1f %12.1f %12.1f\n", n, "HashMap", map[0], map[1], map[2]);
+        printf("%10ld %12s %14.1f %12.1f %12.1f\n", n, "scan", scan[0], scan[1], scan[2]);
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+/**
+ *  @file   bench_slab.c
+ *  @link   https://github.com/joaolpinho
+ *  @brief  Append tail latency with and without incremental growth
+ *  @brief  LinkedList node slabs against one malloc per node
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Times every single append to an empty list, once growing in one go
+ *  and once with ALgrowincrementally, and buckets the latencies by powers
+ *  of two. Prints the percentiles and the worst append of each mode,
+ *  then the histogram side by side. Scheduling and page faults cause
+ *  spikes of their own, so the worst append that changed the capacity
+ *  is reported apart. Large buffers grown in one go are often remapped
+ *  by realloc rather than copied, which hides most of that cost here.
+ */
+#include "harness.h"
+#include "arraylist.h"
+
+#define BUCKETS 40
+#define STEP 16
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static int bucket(double ns) {
+    int b = 0;
+    
+    while ((b < BUCKETS - 1) && ((double)(1L << (b + 1)) <= ns)) {
+        b++;
+    }
+    return b;
+}
+
+/*
+ * The upper bound, in ns, of the bucket holding fraction q of appends.
+ */
+static long percentile(const long *hist, long n, double q) {
+    long seen = 0;
+    int b = 0;
+    
+    for (b = 0; b < BUCKETS; b++) {
+        seen += hist[b];
+        if (seen >= q*n) {
+            break;
+        }
+    }
+    return 1L << (b + 1);
+}
+
+static void run(long n, int step, long *hist, double *worst) {
+    ArrayList list = ALnew(0);
+    double t = 0, ns = 0;
+    long i = 0;
+    int capacity = ALcapacity(list);
+    
+    if (step > 0) {
+        CHECK(ALgrowincrementally(list, step) == 0);
+    }
+    for (i = 0; i < n; i++) {
+        t = seconds();
+        ALadd(list, (void *)(i + 1));
+        ns = (seconds() - t)*1e9;
+        hist[bucket(ns)]++;
+        if (ns > worst[0]) {
+            worst[0] = ns;
+        }
+        if ((ALcapacity(list) != capacity) && (ns > worst[1])) {
+            worst[1] = ns;
+        }
+        capacity = ALcapacity(list);
+    }
+    CHECK(ALsize(list) == n);
+    CHECK(ALget(list, (int)(n/2)) == (void *)(n/2 + 1));
+    ALdispose(list);
+}
+
+
+int main(int argc, char **argv) {
+    static long whole[BUCKETS], incremental[BUCKETS];
+    long n = sizearg(argc, argv, 10000000);
+    double worst[2][2] = { { 0, 0 }, { 0, 0 } };
+    int b = 0;
+    
+    run(n, 0, whole, worst[0]);
+    run(n, STEP, incremental, worst[1]);
+    
+    printf("%12s %10s %10s %10s %10s %12s %12s\n", "mode", "p50 ns", "p99 ns", "p99.9 ns", "p99.99 ns",
+           "max ns", "growth ns");
+    printf("%12s %10ld %10ld %10ld %10ld %12.0f %12.0f\n", "whole", percentile(whole, n, 0.5),
+           percentile(whole, n, 0.99), percentile(whole, n, 0.999), percentile(whole, n, 0.9999),
+           worst[0][0], worst[0][1]);
+    printf("%12s %10ld %10ld %10ld %10ld %12.0f %12.0f\n", "incremental", percentile(incremental, n, 0.5),
+           percentile(incremental, n, 0.99), percentile(incremental, n, 0.999),
+           percentile(incremental, n, 0.9999), worst[1][0], worst[1][1]);
+    
+    printf("\n%14s %12s %12s\n", "below ns", "whole", "incremental");
+    for (b = 0; b < BUCKETS; b++) {
+        if (whole[b] + incremental[b] > 0) {
+            printf("%14ld %12ld %12ld\n", 1L << (b + 1), whole[b], incremental[b]);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,74 @@
+/**
+ *  @file   bench_linkedlist.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  LinkedList append and indexed access as the list grows
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Appending and reading within 16 of either end should cost the same at every
+ *  size, while random positions grow linearly with n, since a walk starts
+ *  from whichever end is closer.
+ */
+#include "harness.h"
+#include "linkedlist.h"
+
+#define PROBES 1000
+
+
+int main(int argc, char **argv) {
+    long max = sizearg(argc, argv, 1000000);
+    unsigned long state = 88172645463325252UL;
+    LinkedList list = -1;
+    double t = 0, append = 0, ends = 0, middle = 0;
+    long n = 0, i = 0, k = 0;
+    
+    printf("%10s %14s %14s %14s\n", "n", "append ns/op", "ends ns/get", "random ns/get");
+    for (n = 10000; n <= max; n *= 10) {
+        list = LLnew();
+        t = seconds();
+        for (i = 0; i < n; i++) {
+            LLadd(list, (void *)(i + 1));
+        }
+        append = (seconds() - t)*1e9/n;
+        
+        t = seconds();
+        for (i = 0; i < PROBES; i++) {
+            k = (i & 1)?(i % 16):(n - 1 - i % 16);
+            CHECK(LLget(list, (int)k) == (void *)(k + 1));
+        }
+        ends = (seconds() - t)*1e9/PROBES;
+        
+        t = seconds();
+        for (i = 0; i < PROBES; i++) {
+            k = (long)(nextrand(&state) % (unsigned long)n);
+            CHECK(LLget(list, (int)k) == (void *)(k + 1));
+        }
+        middle = (seconds() - t)*1e9/PROBES;
+        
+        printf("%10ld %14.1f %14.1f %14.1f\n", n, append, ends, middle);
+        LLdispose(list);
+    }
+    return 0;
+}
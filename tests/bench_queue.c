@@ -0,0 +1,230 @@
+/**
+ *  @file   bench_slab.c
+ *  @link   https://github.com/joaolpinho
+ *  @brief  Lock-free Queue and Deque against a mutex-wrapped LinkedList
+ *  @brief  LinkedList node slabs against one malloc per node
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Queue: as many producers as consumers pass ITEMS elements through a
+ *  Queue, then through a LinkedList appended to at the tail and removed
+ *  from at the head under one mutex. Deque: one owner pushes every
+ *  element and pops back every other one, while thieves steal from the
+ *  other end, again against a LinkedList under a mutex. Threads double
+ *  up to twice the number of online cores. Sums check every element is
+ *  taken exactly once.
+ */
+#include "harness.h"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "linkedlist.h"
+#include "queue.h"
+#include "deque.h"
+
+#define MAXTHREADS 128
+#define CAPACITY 1024
+
+/**
+ * Struct and Type definitions
+ *
+ */
+/*
+ * Either a lock-free container or a LinkedList behind lock, so every
+ * thread function serves both.
+ */
+struct _Shared {
+    char lockfree;
+    int handle;
+    pthread_mutex_t lock;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static struct _Shared shared = { 0, -1, PTHREAD_MUTEX_INITIALIZER };
+static long items = 0;
+static int nthreads = 0;
+static long taken = 0;
+static unsigned long sum = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void consumed(void *elem) {
+    __atomic_add_fetch(&sum, (unsigned long)elem, __ATOMIC_RELAXED);
+    __atomic_add_fetch(&taken, 1, __ATOMIC_RELEASE);
+}
+
+/*
+ * Takes from the head, or from the tail for a deque owner. NULL when
+ * there is nothing to take.
+ */
+static void *take(int fromtail) {
+    void *elem = NULL;
+    int size = 0;
+    
+    if (shared.lockfree) {
+        if (fromtail) {
+            return DQpop(shared.handle);
+        }
+        return QUtrypop(shared.handle);
+    }
+    pthread_mutex_lock(&shared.lock);
+    if ((size = LLsize(shared.handle)) > 0) {
+        elem = LLremove(shared.handle, fromtail?(size - 1):0);
+    }
+    pthread_mutex_unlock(&shared.lock);
+    return elem;
+}
+
+static void put(void *elem) {
+    pthread_mutex_lock(&shared.lock);
+    LLadd(shared.handle, elem);
+    pthread_mutex_unlock(&shared.lock);
+}
+
+static void *producer(void *arg) {
+    long i = 0;
+    
+    for (i = (long)(size_t)arg; i < items; i += nthreads) {
+        if (shared.lockfree) {
+            CHECK(QUpush(shared.handle, (void *)(i + 1)) == 0);
+        } else {
+            put((void *)(i + 1));
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    long n = items/nthreads + (((long)(size_t)arg < items%nthreads)?1:0);
+    void *elem = NULL;
+    
+    while (n > 0) {
+        if ((elem = take(0)) != NULL) {
+            consumed(elem);
+            n--;
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+static void *owner(void *arg) {
+    void *elem = NULL;
+    long i = 0;
+    
+    (void)arg;
+    for (i = 0; i < items; i++) {
+        if (shared.lockfree) {
+            CHECK(DQpush(shared.handle, (void *)(i + 1)) == 0);
+        } else {
+            put((void *)(i + 1));
+        }
+        if ((i % 2 == 1) && ((elem = take(1)) != NULL)) {
+            consumed(elem);
+        }
+    }
+    while ((elem = take(1)) != NULL) {
+        consumed(elem);
+    }
+    return NULL;
+}
+
+static void *thief(void *arg) {
+    void *elem = NULL;
+    
+    (void)arg;
+    while (__atomic_load_n(&taken, __ATOMIC_ACQUIRE) < items) {
+        elem = shared.lockfree?DQsteal(shared.handle):take(0);
+        if (elem != NULL) {
+            consumed(elem);
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Runs n threads of first alongside m threads of second.
+ */
+static double run(void *(*first)(void *), int n, void *(*second)(void *), int m) {
+    pthread_t threads[2*MAXTHREADS];
+    double t = 0;
+    int i = 0;
+    
+    taken = 0;
+    sum = 0;
+    t = seconds();
+    for (i = 0; i < n + m; i++) {
+        CHECK(pthread_create(&threads[i], NULL, (i < n)?first:second, (void *)(size_t)((i < n)?i:i - n)) == 0);
+    }
+    for (i = 0; i < n + m; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    t = seconds() - t;
+    CHECK(taken == items);
+    CHECK(sum == (unsigned long)items*(items + 1)/2);
+    return t;
+}
+
+static void bench(const char *name, char lockfree, int n) {
+    double t = 0;
+    
+    shared.lockfree = lockfree;
+    nthreads = n;
+    shared.handle = lockfree?QUnew(CAPACITY):LLnew();
+    CHECK(shared.handle >= 0);
+    t = run(producer, n, consumer, n);
+    printf("%8d %8s %12s %12.1f\n", n, "queue", name, t*1e9/items);
+    lockfree?QUdispose(shared.handle):LLdispose(shared.handle);
+    
+    shared.handle = lockfree?DQnew(CAPACITY):LLnew();
+    CHECK(shared.handle >= 0);
+    t = run(owner, 1, thief, n);
+    printf("%8d %8s %12s %12.1f\n", n, "deque", name, t*1e9/items);
+    lockfree?DQdispose(shared.handle):LLdispose(shared.handle);
+}
+
+
+int main(int argc, char **argv) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    int n = 0;
+    
+    items = sizearg(argc, argv, 1000000);
+    if ((cores < 1) || (cores > MAXTHREADS/2)) {
+        cores = (cores < 1)?1:MAXTHREADS/2;
+    }
+    printf("%8s %8s %12s %12s\n", "threads", "shape", "container", "ns/elem");
+    for (n = 1; n <= 2*cores; n *= 2) {
+        bench("lock-free", 1, n);
+        bench("mutex+LL", 0, n);
+    }
+    return 0;
+}
@@ -0,0 +1,107 @@
+/**
+ *  @file   bench_slab.c
+ *  @link   https://github.com/joaolpinho
+ *  @brief  Ranged inserts and removals in the middle of large ArrayLists
+ *  @brief  LinkedList node slabs against one malloc per node
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Inserts a batch in the middle of the list and removes it again, with
+ *  ALinsertrange and ALremoverange, for growing batch sizes. The same
+ *  work done one element at a time with ALset and ALremove shifts the
+ *  tail once per element, so it is only timed over ONEBYONE elements
+ *  and reported per element.
+ */
+#include "harness.h"
+#include "arraylist.h"
+
+#define ROUNDS 16
+#define ONEBYONE 64
+#define MAXBATCH 65536
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static void *batch[MAXBATCH];
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static double ranged(ArrayList list, int n, int size) {
+    double t = 0;
+    int i = 0;
+    
+    t = seconds();
+    for (i = 0; i < ROUNDS; i++) {
+        CHECK(ALinsertrange(list, n/2, batch, size) == size);
+        CHECK(ALremoverange(list, n/2, n/2 + size) == size);
+    }
+    t = seconds() - t;
+    CHECK(ALget(list, n/2) == (void *)(long)(n/2 + 1));
+    return t*1e9/((double)ROUNDS*size);
+}
+
+static double onebyone(ArrayList list, int n) {
+    double t = 0;
+    int i = 0;
+    
+    t = seconds();
+    for (i = 0; i < ONEBYONE; i++) {
+        ALset(list, n/2 + i, batch[i]);
+    }
+    for (i = 0; i < ONEBYONE; i++) {
+        CHECK(ALremove(list, n/2) == batch[i]);
+    }
+    t = seconds() - t;
+    CHECK(ALget(list, n/2) == (void *)(long)(n/2 + 1));
+    return t*1e9/ONEBYONE;
+}
+
+
+int main(int argc, char **argv) {
+    long max = sizearg(argc, argv, 10000000);
+    ArrayList list = -1;
+    double single = 0;
+    long n = 0, i = 0;
+    int size = 0;
+    
+    for (i = 0; i < MAXBATCH; i++) {
+        batch[i] = (void *)-(i + 1);
+    }
+    printf("%10s %8s %16s %16s\n", "n", "batch", "ranged ns/el", "one-by-one ns/el");
+    for (n = 100000; n <= max; n *= 10) {
+        list = ALnew((int)n + MAXBATCH);
+        for (i = 0; i < n; i++) {
+            ALadd(list, (void *)(i + 1));
+        }
+        single = onebyone(list, (int)n);
+        for (size = 16; size <= MAXBATCH; size *= 16) {
+            printf("%10ld %8d %16.2f %16.1f\n", n, size, ranged(list, (int)n, size), single);
+        }
+        ALdispose(list);
+    }
+    return 0;
+}
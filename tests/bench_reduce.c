@@ -0,0 +1,103 @@
+/**
+ *  @file   bench_slab.c
+ *  @link   https://github.com/joaolpinho
+ *  @brief  Parallel ALreduce of a compute-bound fold from one thread to every core
+ *  @brief  LinkedList node slabs against one malloc per node
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Folds every element through a few dozen rounds of integer mixing and
+ *  sums the results, first in a plain loop, then with ALreduce on the
+ *  pool resized by TPsetthreads, doubling the threads up to the number
+ *  of online cores. Sums wrap, so every run must match the loop.
+ */
+#include "harness.h"
+#include <unistd.h>
+#include "arraylist.h"
+#include "threadpool.h"
+
+#define MIXROUNDS 48
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static unsigned long mix(unsigned long x) {
+    int i = 0;
+    
+    for (i = 0; i < MIXROUNDS; i++) {
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCDUL;
+    }
+    return x;
+}
+
+static void *fold(void *acc, void *elem, void *ctx) {
+    (void)ctx;
+    return (void *)((unsigned long)acc + mix((unsigned long)elem));
+}
+
+static void *combine(void *left, void *right, void *ctx) {
+    (void)ctx;
+    return (void *)((unsigned long)left + (unsigned long)right);
+}
+
+
+int main(int argc, char **argv) {
+    long n = sizearg(argc, argv, 4000000);
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    ArrayList list = ALnew((int)n);
+    unsigned long expected = 0;
+    double t = 0, base = 0;
+    long i = 0;
+    int k = 0;
+    
+    if (cores < 1) {
+        cores = 1;
+    }
+    if (cores > TP_MAXTHREADS) {
+        cores = TP_MAXTHREADS;
+    }
+    for (i = 0; i < n; i++) {
+        ALadd(list, (void *)(i + 1));
+    }
+    
+    t = seconds();
+    for (i = 0; i < n; i++) {
+        expected += mix((unsigned long)(i + 1));
+    }
+    base = seconds() - t;
+    printf("%8s %12s %10s\n", "threads", "ns/el", "speedup");
+    printf("%8s %12.2f %10.2f\n", "loop", base*1e9/n, 1.0);
+    
+    for (k = 1; k <= cores; k = (k*2 > cores && k < cores)?(int)cores:k*2) {
+        TPsetthreads(k);
+        t = seconds();
+        CHECK((unsigned long)ALreduce(list, fold, combine, NULL, NULL) == expected);
+        t = seconds() - t;
+        printf("%8d %12.2f %10.2f\n", k, t*1e9/n, base/t);
+    }
+    ALdispose(list);
+    return 0;
+}
@@ -0,0 +1,158 @@
+/**
+ *  @file   bench_slab.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  LinkedList node slabs against one malloc per node
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  A queue-like churn keeps a fixed number of live nodes while appending
+ *  at the tail and removing at the head. The malloc path is a bare list
+ *  laid out as LinkedList was before slabs. Allocations are counted through
+ *  an allocator handed to LLnewwith. The slab timings also include the
+ *  handle lookup and lock every LinkedList call takes, which the bare
+ *  list does not pay.
+ */
+#include "harness.h"
+#include "linkedlist.h"
+
+/**
+ * Struct and Type definitions
+ *
+ */
+/*
+ * The node layout LinkedList used before slabs, allocated one by one.
+ */
+struct _Plain {
+    void *elem;
+    struct _Plain *prev;
+    struct _Plain *next;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static unsigned long allocs = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *countalloc(size_t size, void *ctx) {
+    (void)ctx;
+    allocs++;
+    return malloc(size);
+}
+
+static void *countresize(void *p, size_t old, size_t size, void *ctx) {
+    (void)old;
+    (void)ctx;
+    allocs++;
+    return realloc(p, size);
+}
+
+static void countrelease(void *p, size_t size, void *ctx) {
+    (void)size;
+    (void)ctx;
+    free(p);
+}
+
+/*
+ * Keeps n elements while appending at the tail and removing at the head
+ * rounds times.
+ */
+static double churnlist(long n, long rounds) {
+    allocator counting = { countalloc, countresize, countrelease, NULL };
+    LinkedList list = LLnewwith(&counting);
+    double t = 0;
+    long i = 0;
+    
+    for (i = 0; i < n; i++) {
+        LLadd(list, (void *)(i + 1));
+    }
+    t = seconds();
+    for (i = 0; i < rounds; i++) {
+        CHECK(LLremove(list, 0) == (void *)(i + 1));
+        LLadd(list, (void *)(n + i + 1));
+    }
+    t = seconds() - t;
+    LLdispose(list);
+    return t;
+}
+
+static double churnplain(long n, long rounds) {
+    struct _Plain *head = NULL, *tail = NULL, *node = NULL;
+    double t = 0;
+    long i = 0;
+    
+    for (i = 0; i < n + rounds; i++) {
+        if (i == n) {
+            t = seconds();
+        }
+        if (i >= n) {
+            node = head;
+            CHECK(node->elem == (void *)(i - n + 1));
+            head = node->next;
+            head->prev = NULL;
+            free(node);
+        }
+        allocs++;
+        node = malloc(sizeof(struct _Plain));
+        node->elem = (void *)(i + 1);
+        node->prev = tail;
+        node->next = NULL;
+        if (tail != NULL) {
+            tail->next = node;
+        } else {
+            head = node;
+        }
+        tail = node;
+    }
+    t = seconds() - t;
+    while (head != NULL) {
+        node = head->next;
+        free(head);
+        head = node;
+    }
+    return t;
+}
+
+
+int main(int argc, char **argv) {
+    long rounds = sizearg(argc, argv, 4000000);
+    long n = 0;
+    double t = 0;
+    
+    printf("%10s %8s %12s %14s\n", "live", "path", "ns/op", "allocations");
+    for (n = 1000; n <= 1000000; n *= 10) {
+        allocs = 0;
+        t = churnplain(n, rounds);
+        printf("%10ld %8s %12.1f %14lu\n", n, "malloc", t*1e9/rounds, allocs);
+        allocs = 0;
+        t = churnlist(n, rounds);
+        printf("%10ld %8s %12.1f %14lu\n", n, "slab", t*1e9/rounds, allocs);
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+/**
+ *  @file   bench_slab.c
+ *  @link   https://github.com/joaolpinho
+ *  @brief  Reads of a segmented ArrayList through views and through locks
+ *  @brief  LinkedList node slabs against one malloc per node
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  One writer keeps appending to and popping from the back of the list,
+ *  publishing every PUBLISHEVERY changes, while N readers each make
+ *  READS random reads. Readers either take a view with ALsnapshot once
+ *  per VIEWREADS reads, or call ALget and so take the list lock. Readers
+ *  double up to twice the number of online cores.
+ */
+#include "harness.h"
+#include <pthread.h>
+#include <unistd.h>
+#include "arraylist.h"
+
+#define MAXREADERS 256
+#define READS 1000000
+#define VIEWREADS 256
+#define PUBLISHEVERY 64
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static ArrayList list = -1;
+static long n = 0;
+static int done = 0;
+static int viaview = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *writer(void *arg) {
+    long i = 0;
+    
+    (void)arg;
+    while (!__atomic_load_n(&done, __ATOMIC_ACQUIRE)) {
+        ALadd(list, (void *)-1L);
+        ALpopback(list);
+        if (++i % PUBLISHEVERY == 0) {
+            ALpublish(list);
+        }
+    }
+    return NULL;
+}
+
+static void *reader(void *arg) {
+    unsigned long state = 0x9E3779B97F4A7C15UL*((unsigned long)(size_t)arg + 1);
+    view *v = NULL;
+    long i = 0, k = 0;
+    
+    for (i = 0; i < READS; i++) {
+        k = (long)(nextrand(&state) % (unsigned long)n);
+        if (viaview) {
+            if (i % VIEWREADS == 0) {
+                if (v != NULL) {
+                    ALviewrelease(v);
+                }
+                v = ALsnapshot(list);
+                CHECK(v != NULL);
+            }
+            CHECK(ALviewget(v, (int)k) == (void *)(k + 1));
+        } else {
+            CHECK(ALget(list, (int)k) == (void *)(k + 1));
+        }
+    }
+    if (v != NULL) {
+        ALviewrelease(v);
+    }
+    return NULL;
+}
+
+static double run(int nreaders) {
+    pthread_t w, readers[MAXREADERS];
+    double t = 0;
+    int i = 0;
+    
+    __atomic_store_n(&done, 0, __ATOMIC_RELEASE);
+    CHECK(pthread_create(&w, NULL, writer, NULL) == 0);
+    t = seconds();
+    for (i = 0; i < nreaders; i++) {
+        CHECK(pthread_create(&readers[i], NULL, reader, (void *)(size_t)i) == 0);
+    }
+    for (i = 0; i < nreaders; i++) {
+        pthread_join(readers[i], NULL);
+    }
+    t = seconds() - t;
+    __atomic_store_n(&done, 1, __ATOMIC_RELEASE);
+    pthread_join(w, NULL);
+    return t;
+}
+
+
+int main(int argc, char **argv) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    double t = 0;
+    long i = 0;
+    int k = 0;
+    
+    n = sizearg(argc, argv, 1000000);
+    if ((cores < 1) || (cores > MAXREADERS/2)) {
+        cores = (cores < 1)?1:MAXREADERS/2;
+    }
+    list = ALnewsegmented(0, 0);
+    CHECK(list >= 0);
+    for (i = 0; i < n; i++) {
+        ALadd(list, (void *)(i + 1));
+    }
+    CHECK(ALpublish(list) == 0);
+    
+    printf("%8s %8s %14s %12s\n", "readers", "reads", "Mreads/s", "ns/read");
+    for (k = 1; k <= 2*cores; k *= 2) {
+        for (viaview = 0; viaview < 2; viaview++) {
+            t = run(k);
+            printf("%8d %8s %14.2f %12.1f\n", k, viaview?"view":"lock",
+                   (double)k*READS/t*1e-6, t*1e9/READS);
+        }
+    }
+    ALdispose(list);
+    return 0;
+}
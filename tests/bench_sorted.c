@@ -0,0 +1,127 @@
+/**
+ *  @file   bench_slab.c
+ *  @link   https://github.com/joaolpinho
+ *  @brief  SortedList against a sorted ArrayList under mixed inserts and lookups
+ *  @brief  LinkedList node slabs against one malloc per node
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Both containers start from the same n random keys, then run a mix of
+ *  random inserts and lookups, for a few insert ratios. The ArrayList
+ *  inserts at ALlowerbound, shifting everything after, and looks up with
+ *  ALbsearch; the SortedList uses SLinsert and SLfind. An insert into the
+ *  ArrayList costs O(n), so it only runs SHIFTWORK/n operations, and
+ *  never more than n so the list at most doubles.
+ */
+#include "harness.h"
+#include "arraylist.h"
+#include "sortedlist.h"
+
+#define SHIFTWORK 2000000000L
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static int cmp(const void *x, const void *y) {
+    unsigned long a = (unsigned long)x, b = (unsigned long)y;
+    
+    return (a > b) - (a < b);
+}
+
+/*
+ * Never NULL, so any key can be stored.
+ */
+static void *randkey(unsigned long *state) {
+    return (void *)(nextrand(state) | 1UL);
+}
+
+static double runarray(long n, long ops, int percent) {
+    unsigned long state = 0x9E3779B97F4A7C15UL, opstate = 0xD1B54A32D192ED03UL;
+    ArrayList list = ALnew((int)(n + ops));
+    void *key = NULL;
+    double t = 0;
+    long i = 0;
+    
+    for (i = 0; i < n; i++) {
+        ALadd(list, randkey(&state));
+    }
+    ALsort(list, cmp);
+    t = seconds();
+    for (i = 0; i < ops; i++) {
+        if ((long)(nextrand(&opstate) % 100) < percent) {
+            key = randkey(&state);
+            CHECK(ALset(list, ALlowerbound(list, key, cmp), key) == key);
+        } else {
+            key = ALget(list, (int)(nextrand(&opstate) % (unsigned long)ALsize(list)));
+            CHECK(ALget(list, ALbsearch(list, key, cmp)) == key);
+        }
+    }
+    t = seconds() - t;
+    ALdispose(list);
+    return t*1e9/ops;
+}
+
+static double runsorted(long n, long ops, int percent) {
+    unsigned long state = 0x9E3779B97F4A7C15UL, opstate = 0xD1B54A32D192ED03UL;
+    SortedList list = SLnew(cmp);
+    void *key = NULL;
+    double t = 0;
+    long i = 0;
+    
+    for (i = 0; i < n; i++) {
+        SLinsert(list, randkey(&state));
+    }
+    t = seconds();
+    for (i = 0; i < ops; i++) {
+        if ((long)(nextrand(&opstate) % 100) < percent) {
+            key = randkey(&state);
+            CHECK(SLinsert(list, key) == key);
+        } else {
+            key = SLget(list, (int)(nextrand(&opstate) % (unsigned long)SLsize(list)));
+            CHECK(SLfind(list, key) == key);
+        }
+    }
+    t = seconds() - t;
+    SLdispose(list);
+    return t*1e9/ops;
+}
+
+
+int main(int argc, char **argv) {
+    static const int percents[] = { 10, 50, 90 };
+    long max = sizearg(argc, argv, 1000000);
+    long n = 0, ops = 0;
+    int k = 0;
+    
+    printf("%10s %8s %10s %14s %14s\n", "n", "inserts", "ops", "ArrayList ns", "SortedList ns");
+    for (n = 10000; n <= max; n *= 10) {
+        ops = (SHIFTWORK/n < n)?SHIFTWORK/n:n;
+        for (k = 0; k < 3; k++) {
+            printf("%10ld %7d%% %10ld %14.1f %14.1f\n", n, percents[k], ops,
+                   runarray(n, ops, percents[k]), runsorted(n, ops, percents[k]));
+        }
+    }
+    return 0;
+}
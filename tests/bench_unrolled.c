@@ -0,0 +1,125 @@
+/**
+ *  @file   bench_unrolled.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  UnrolledList against LinkedList and ArrayList
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Times a full iterator scan, then inserts and removes in the middle of
+ *  the list, for each of the three sequential containers.
+ */
+#include "harness.h"
+#include "arraylist.h"
+#include "linkedlist.h"
+#include "unrolledlist.h"
+
+#define MIDDLEOPS 2000
+
+/**
+ * Struct and Type definitions
+ *
+ */
+/*
+ * The three lists share one signature for everything measured here.
+ */
+struct _Container {
+    const char *name;
+    int (*create)(void);
+    void *(*add)(int, void *);
+    void *(*set)(int, int, void *);
+    void *(*remove)(int, int);
+    iterator (*iterate)(int);
+    void (*dispose)(int);
+};
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static int newarray(void) {
+    return ALnew(0);
+}
+
+static int newlinked(void) {
+    return LLnew();
+}
+
+static int newunrolled(void) {
+    return ULnew();
+}
+
+static void run(const struct _Container *c, long n) {
+    iterator it;
+    double t = 0, scan = 0, insert = 0, removal = 0;
+    long sum = 0, i = 0;
+    int h = c->create();
+    
+    for (i = 0; i < n; i++) {
+        c->add(h, (void *)(i + 1));
+    }
+    
+    t = seconds();
+    it = c->iterate(h);
+    while (it.hasnext) {
+        sum += (long)it.next(&it);
+    }
+    scan = (seconds() - t)*1e9/n;
+    CHECK(sum == n*(n + 1)/2);
+    
+    t = seconds();
+    for (i = 0; i < MIDDLEOPS; i++) {
+        c->set(h, (int)(n/2), (void *)-1L);
+    }
+    insert = (seconds() - t)*1e9/MIDDLEOPS;
+    
+    t = seconds();
+    for (i = 0; i < MIDDLEOPS; i++) {
+        CHECK(c->remove(h, (int)(n/2)) == (void *)-1L);
+    }
+    removal = (seconds() - t)*1e9/MIDDLEOPS;
+    
+    printf("%10ld %14s %12.2f %14.1f %14.1f\n", n, c->name, scan, insert, removal);
+    c->dispose(h);
+}
+
+
+int main(int argc, char **argv) {
+    static const struct _Container containers[] = {
+        { "ArrayList", newarray, ALadd, ALset, ALremove, ALiterator, ALdispose },
+        { "LinkedList", newlinked, LLadd, LLset, LLremove, LLiterator, LLdispose },
+        { "UnrolledList", newunrolled, ULadd, ULset, ULremove, ULiterator, ULdispose }
+    };
+    long max = sizearg(argc, argv, 1000000);
+    long n = 0;
+    int k = 0;
+    
+    printf("%10s %14s %12s %14s %14s\n", "n", "list", "scan ns/el", "insert ns/op", "remove ns/op");
+    for (n = 10000; n <= max; n *= 10) {
+        for (k = 0; k < 3; k++) {
+            run(&containers[k], n);
+        }
+    }
+    return 0;
+}
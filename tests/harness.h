@@ -0,0 +1,85 @@
+/**
+ *  @file   harness.h
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Helpers shared by the benchmarks and checks
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Every program includes this first, as it sets the feature macros the
+ *  timers need.
+ */
+#ifndef moustached_harness_h
+#define moustached_harness_h
+
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+/*
+ * Unlike assert, never compiled out. Reports on stdout, as the library
+ * reports rejected handles on stderr and checks may silence it.
+ */
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE); \
+        } \
+    } while (0)
+
+/*
+ * Monotonic time in seconds.
+ */
+static inline double seconds(void) {
+    struct timespec ts;
+    
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec*1e-9;
+}
+
+/*
+ * The first program argument as a size, or fallback when there is none.
+ */
+static inline long sizearg(int argc, char **argv, long fallback) {
+    return (argc > 1)?atol(argv[1]):fallback;
+}
+
+/*
+ * xorshift, so runs are repeatable and cheap next to the code measured.
+ */
+static inline unsigned long nextrand(unsigned long *state) {
+    unsigned long x = *state;
+    
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    *state = x;
+    return x;
+}
+
+#endif
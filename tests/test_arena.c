@@ -0,0 +1,210 @@
+/**
+ *  @file   test_arena.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of the arena allocator and of lists built on it
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Covers bump allocation and alignment, resizing the latest allocation
+ *  in place, ARreset handing the same memory out again, the limit on the
+ *  bytes an arena takes from the heap, and ALnewwith lists that grow and
+ *  sort inside an arena, including a sort whose scratch space does not
+ *  fit under the limit.
+ */
+#include "harness.h"
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "arena.h"
+#include "arraylist.h"
+
+#define COUNT 20000
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *take(allocator *al, size_t size) {
+    return al->alloc(size, al->ctx);
+}
+
+static int aligned(void *p) {
+    return ((uintptr_t)p % AR_ALIGN) == 0;
+}
+
+static int cmplong(const void *x, const void *y) {
+    long a = *(const long *)x, b = *(const long *)y;
+    
+    return (a > b) - (a < b);
+}
+
+static int cmpword(const void *x, const void *y) {
+    long a = (long)x, b = (long)y;
+    
+    return (a > b) - (a < b);
+}
+
+static void basics(void) {
+    allocator *al = ARnew(0, 0);
+    char *p = NULL, *q = NULL, *r = NULL;
+    
+    CHECK(al != NULL);
+    p = take(al, 10);
+    q = take(al, 100);
+    CHECK(aligned(p) && aligned(q));
+    CHECK(q == p + AR_ALIGN);
+    memset(q, 7, 100);
+    
+    CHECK(al->resize(q, 100, 1000, al->ctx) == q);
+    CHECK(q[99] == 7);
+    CHECK(al->resize(q, 1000, 50, al->ctx) == q);
+    r = take(al, 1);
+    CHECK(r == q + 64);
+    
+    memset(p, 3, 10);
+    q = al->resize(p, 10, 40, al->ctx);
+    CHECK((q != p) && aligned(q));
+    CHECK((q[0] == 3) && (q[9] == 3));
+    
+    r = al->resize(q, 40, 2*AR_MINCHUNK, al->ctx);
+    CHECK((r != q) && aligned(r) && (r[9] == 3));
+    al->release(r, 2*AR_MINCHUNK, al->ctx);
+    CHECK(take(al, 8) == r);
+    al->release(p, 10, al->ctx);
+    CHECK(take(al, 8) != p);
+    
+    ARreset(al);
+    p = take(al, 8);
+    CHECK(take(al, 8) == p + AR_ALIGN);
+    ARreset(al);
+    CHECK(take(al, 8) == p);
+    ARdispose(al);
+    
+    al = ARnew(0, 0);
+    ARreset(al);
+    CHECK(aligned(take(al, 1)));
+    ARdispose(al);
+}
+
+static int fill(allocator *al, size_t size) {
+    int n = 0;
+    
+    errno = 0;
+    while (take(al, size) != NULL) {
+        n++;
+    }
+    CHECK(errno == ENOMEM);
+    return n;
+}
+
+static void limits(void) {
+    allocator *al = ARnew(AR_MINCHUNK, 4*AR_MINCHUNK);
+    int first = 0, last = 0, n = 0, round = 0;
+    
+    CHECK(take(al, 4*AR_MINCHUNK) == NULL);
+    CHECK(errno == ENOMEM);
+    CHECK(take(al, 2*AR_MINCHUNK) != NULL);
+    first = fill(al, 100);
+    CHECK(first > 0);
+    CHECK((size_t)(first*112) <= 2*AR_MINCHUNK);
+    CHECK(al->resize(NULL, 0, AR_MINCHUNK, al->ctx) == NULL);
+    
+    for (round = 0; round < 4; round++) {
+        ARreset(al);
+        CHECK(take(al, 2*AR_MINCHUNK) != NULL);
+        n = fill(al, 100);
+        CHECK((n > 0) && ((round == 0) || (n == last)));
+        last = n;
+    }
+    ARdispose(al);
+}
+
+static void lists(void) {
+    allocator *al = ARnew(0, 0);
+    ArrayList list = -1;
+    long values[COUNT];
+    long i = 0;
+    int round = 0;
+    
+    for (round = 0; round < 3; round++) {
+        list = ALnewwith(0, 0, al);
+        CHECK(list >= 0);
+        for (i = 0; i < COUNT; i++) {
+            CHECK(ALadd(list, (void *)((i*7919) % COUNT + 1)) != NULL);
+        }
+        ALsort(list, cmpword);
+        for (i = 0; i < COUNT; i++) {
+            CHECK(ALget(list, (int)i) == (void *)(i + 1));
+        }
+        ALdispose(list);
+        
+        list = ALnewwith(4, sizeof(long), al);
+        for (i = 0; i < COUNT; i++) {
+            values[i] = (i*104729) % COUNT - COUNT/2;
+            CHECK(ALadd(list, &values[i]) != NULL);
+        }
+        ALsort(list, cmplong);
+        for (i = 0; i < COUNT; i++) {
+            CHECK(*(long *)ALget(list, (int)i) == i - COUNT/2);
+        }
+        ALdispose(list);
+        ARreset(al);
+    }
+    ARdispose(al);
+}
+
+/*
+ * A list that fits under the limit but whose sort scratch does not is
+ * left as it was, with ENOMEM.
+ */
+static void tight(void) {
+    allocator *al = ARnew(0, sizeof(void *)*COUNT + 2*AR_MINCHUNK);
+    ArrayList list = ALnewwith(COUNT, 0, al);
+    long i = 0;
+    
+    CHECK(list >= 0);
+    for (i = 0; i < COUNT/2; i++) {
+        CHECK(ALadd(list, (void *)(COUNT - i)) != NULL);
+    }
+    errno = 0;
+    ALsort(list, cmpword);
+    CHECK(errno == ENOMEM);
+    CHECK(ALsize(list) == COUNT/2);
+    for (i = 0; i < COUNT/2; i++) {
+        CHECK(ALget(list, (int)i) == (void *)(COUNT - i));
+    }
+    ALdispose(list);
+    ARdispose(al);
+}
+
+int main(void) {
+    freopen("/dev/null", "w", stderr);
+    basics();
+    limits();
+    lists();
+    tight();
+    printf("ok\n");
+    return 0;
+}
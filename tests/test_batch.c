@@ -0,0 +1,372 @@
+/**
+ *  @file   test_batch.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of the batched list iterators
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Every ArrayList layout, plain or records, filled from the back or
+ *  from the front, segmented and still moving into a grown buffer, is
+ *  drained with ALnextbatch in batches of 1, 7 and more than the list
+ *  holds and with ALnextspan, and linked lists with LLnextbatch. Each
+ *  drain is followed by a second iterator stepping with next: both must
+ *  agree on the elements, on carriage, hasnext and hasprev, also after
+ *  a batch is followed by prev, and the sequence must be the one ALget
+ *  or LLget return. Lists changed mid-drain must reject the iterator.
+ */
+#include "harness.h"
+#include <errno.h>
+#include "arraylist.h"
+#include "linkedlist.h"
+
+#define MAXSIZE 300
+#define BLOCK 16
+#define START 64
+#define LAYOUTS 9
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Record {
+    long value;
+    long twice;
+};
+
+typedef int (*batcher)(iterator*, void**, int);
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static const int sizes[] = { 0, 1, 7, 40, 100 };
+static const int batches[] = { 1, 7, MAXSIZE + 1 };
+static long ref[MAXSIZE];
+static long seq[MAXSIZE];
+static int nref = 0;
+static char record = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static long unwrap(void *p) {
+    struct _Record *r = p;
+    
+    if (!record) {
+        return (long)p;
+    }
+    CHECK(r->twice == 2*r->value);
+    return r->value;
+}
+
+static void *wrap(long v, struct _Record *r) {
+    r->value = v;
+    r->twice = 2*v;
+    return record?(void *)r:(void *)v;
+}
+
+/*
+ * Layouts: plain and records, each filled from the back, half from the
+ * front, segmented, and growing one element per call, plus a segmented
+ * list filled from the front. Holds ref[0..n) in order.
+ */
+static ArrayList build(int layout, int n) {
+    ArrayList list = -1;
+    struct _Record r;
+    int capacity = 0;
+    int i = 0;
+    
+    record = (char)(layout & 1);
+    switch (layout) {
+        case 0: case 1: case 2: case 3:
+            list = record?ALnewsized(0, sizeof(struct _Record)):ALnew(0);
+            break;
+        case 4: case 5: case 8:
+            list = ALnewsegmented(BLOCK, record?sizeof(struct _Record):0);
+            break;
+        default:
+            list = record?ALnewsized(START, sizeof(struct _Record)):ALnew(START);
+            CHECK(ALgrowincrementally(list, 1) == 0);
+            capacity = ALcapacity(list);
+            for (nref = 0; ALcapacity(list) == capacity; nref++) {
+                ref[nref] = nref + 1;
+                CHECK(ALadd(list, wrap(ref[nref], &r)) != NULL);
+            }
+            return list;
+    }
+    CHECK(list >= 0);
+    for (i = 0; i < n; i++) {
+        ref[i] = i + 1;
+    }
+    nref = n;
+    if ((layout == 2) || (layout == 3) || (layout == 8)) {
+        for (i = n/2; i < n; i++) {
+            CHECK(ALadd(list, wrap(ref[i], &r)) != NULL);
+        }
+        for (i = n/2 - 1; i >= 0; i--) {
+            CHECK(ALpushfront(list, wrap(ref[i], &r)) != NULL);
+        }
+    } else {
+        for (i = 0; i < n; i++) {
+            CHECK(ALadd(list, wrap(ref[i], &r)) != NULL);
+        }
+    }
+    return list;
+}
+
+/*
+ * The shadow iterator takes one step with next for every element of a
+ * batch, and must land where the batched one did.
+ */
+static void follow(iterator *it, iterator *sh, int got, int total) {
+    int k = 0;
+    
+    for (k = 0; k < got; k++) {
+        seq[total + k] = unwrap(sh->next(sh));
+        CHECK(seq[total + k] == ref[total + k]);
+    }
+    CHECK(it->carriage == total + got);
+    CHECK(sh->carriage == total + got);
+    CHECK(it->hasnext == sh->hasnext);
+    CHECK(it->hasprev == sh->hasprev);
+    CHECK(it->hasnext == (total + got < nref));
+}
+
+/*
+ * Steps back over the last element of a batch and forward again.
+ */
+static void stepback(iterator *it, iterator *sh, int total) {
+    CHECK(unwrap(it->prev(it)) == ref[total - 1]);
+    CHECK(unwrap(sh->prev(sh)) == ref[total - 1]);
+    CHECK(it->carriage == total - 1);
+    CHECK(it->hasnext && sh->hasnext);
+    CHECK(unwrap(it->next(it)) == ref[total - 1]);
+    CHECK(unwrap(sh->next(sh)) == ref[total - 1]);
+}
+
+static void drain(iterator it, iterator sh, batcher batch, int size) {
+    void *out[MAXSIZE + 1];
+    int got = 0, total = 0, rounds = 0, k = 0;
+    
+    while ((got = batch(&it, out, size)) > 0) {
+        CHECK(got <= size);
+        for (k = 0; k < got; k++) {
+            CHECK(unwrap(out[k]) == ref[total + k]);
+        }
+        follow(&it, &sh, got, total);
+        total += got;
+        if (rounds++ == 1) {
+            stepback(&it, &sh, total);
+        }
+    }
+    CHECK(got == 0);
+    CHECK(total == nref);
+    CHECK(!it.hasnext);
+    CHECK(sh.next(&sh) == NULL);
+}
+
+static void drainspans(ArrayList list, int layout) {
+    iterator it = ALiterator(list), sh = ALiterator(list);
+    size_t es = record?sizeof(struct _Record):sizeof(void *);
+    char *span = NULL;
+    int len = 0, total = 0, rounds = 0, k = 0;
+    
+    while ((span = ALnextspan(&it, &len)) != NULL) {
+        CHECK((len > 0) && (total + len <= nref));
+        CHECK(((layout != 4) && (layout != 5) && (layout != 8)) || (len <= BLOCK));
+        for (k = 0; k < len; k++) {
+            CHECK(unwrap(record?(void *)(span + es*k):*(void **)(span + es*k)) == ref[total + k]);
+        }
+        follow(&it, &sh, len, total);
+        total += len;
+        if (rounds++ == 1) {
+            stepback(&it, &sh, total);
+        }
+    }
+    CHECK(len == 0);
+    CHECK(total == nref);
+    CHECK(sh.next(&sh) == NULL);
+}
+
+static void arrays(void) {
+    ArrayList list = -1;
+    size_t s = 0, b = 0;
+    int layout = 0, i = 0;
+    
+    for (layout = 0; layout < LAYOUTS; layout++) {
+        for (s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+            for (b = 0; b <= sizeof(batches)/sizeof(batches[0]); b++) {
+                list = build(layout, sizes[s]);
+                if (b < sizeof(batches)/sizeof(batches[0])) {
+                    drain(ALiterator(list), ALiterator(list), ALnextbatch, batches[b]);
+                } else {
+                    drainspans(list, layout);
+                }
+                for (i = 0; i < nref; i++) {
+                    CHECK(unwrap(ALget(list, i)) == seq[i]);
+                }
+                ALdispose(list);
+            }
+        }
+    }
+}
+
+/*
+ * Plain linked lists, filled from the front and indexed.
+ */
+static LinkedList buildlinked(int layout, int n) {
+    LinkedList list = LLnew();
+    int i = 0;
+    
+    CHECK(list >= 0);
+    record = 0;
+    for (i = 0; i < n; i++) {
+        ref[i] = i + 1;
+    }
+    nref = n;
+    for (i = 0; i < n; i++) {
+        if ((layout == 1) && (i > 0)) {
+            CHECK(LLset(list, 0, (void *)ref[n - 1 - i]) != NULL);
+        } else {
+            CHECK(LLadd(list, (void *)ref[(layout == 1)?(n - 1):i]) != NULL);
+        }
+    }
+    if (layout == 2) {
+        CHECK(LLsetindexed(list, 1) == 0);
+    }
+    return list;
+}
+
+static void linked(void) {
+    LinkedList list = -1;
+    size_t s = 0, b = 0;
+    int layout = 0, i = 0;
+    
+    for (layout = 0; layout < 3; layout++) {
+        for (s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+            for (b = 0; b < sizeof(batches)/sizeof(batches[0]); b++) {
+                list = buildlinked(layout, sizes[s]);
+                drain(LLiterator(list), LLiterator(list), LLnextbatch, batches[b]);
+                for (i = 0; i < nref; i++) {
+                    CHECK((long)LLget(list, i) == seq[i]);
+                }
+                LLdispose(list);
+            }
+        }
+    }
+}
+
+/*
+ * it.remove drops the last element of the batch, and only once.
+ */
+static void removes(void) {
+    LinkedList list = buildlinked(0, 40);
+    iterator it = LLiterator(list);
+    void *out[7];
+    int i = 0;
+    
+    errno = 0;
+    CHECK(it.remove(&it) == NULL);
+    CHECK(errno == EINVAL);
+    CHECK(LLnextbatch(&it, out, 7) == 7);
+    CHECK(it.remove(&it) == (void *)ref[6]);
+    CHECK(it.carriage == 6);
+    errno = 0;
+    CHECK(it.remove(&it) == NULL);
+    CHECK(errno == EINVAL);
+    CHECK(LLnextbatch(&it, out, 2) == 2);
+    CHECK((out[0] == (void *)ref[7]) && (out[1] == (void *)ref[8]));
+    CHECK(it.prev(&it) == (void *)ref[8]);
+    CHECK(it.remove(&it) == (void *)ref[8]);
+    CHECK(it.next(&it) == (void *)ref[9]);
+    CHECK(LLsize(list) == 38);
+    for (i = 0; i < 38; i++) {
+        CHECK(LLget(list, i) == (void *)ref[i + (i >= 6) + (i >= 7)]);
+    }
+    LLdispose(list);
+}
+
+/*
+ * Adds, inserts and removes through the list invalidate its iterators
+ * until they are reset.
+ */
+static void changes(void) {
+    ArrayList list = -1;
+    LinkedList linked = -1;
+    struct _Record r;
+    iterator it;
+    void *out[7];
+    int layout = 0, change = 0, len = 0;
+    
+    for (layout = 0; layout < LAYOUTS; layout++) {
+        for (change = 0; change < 3; change++) {
+            list = build(layout, 40);
+            it = ALiterator(list);
+            CHECK(ALnextbatch(&it, out, 7) == 7);
+            CHECK(ALget(list, 3) != NULL);
+            CHECK(ALnextbatch(&it, out, 7) == 7);
+            switch (change) {
+                case 0: CHECK(ALadd(list, wrap(999, &r)) != NULL); break;
+                case 1: CHECK(ALset(list, 20, wrap(999, &r)) != NULL); break;
+                default: ALremove(list, 20); break;
+            }
+            errno = 0;
+            CHECK(ALnextbatch(&it, out, 7) == -1);
+            CHECK(errno == EFAULT);
+            CHECK(!it.hasnext && !it.hasprev);
+            CHECK(ALnextspan(&it, &len) == NULL);
+            CHECK(len == 0);
+            CHECK(it.next(&it) == NULL);
+            it.reset(&it);
+            CHECK(ALnextbatch(&it, out, 7) == 7);
+            CHECK(unwrap(out[0]) == ref[0]);
+            ALdispose(list);
+        }
+    }
+    linked = buildlinked(0, 40);
+    it = LLiterator(linked);
+    CHECK(LLnextbatch(&it, out, 7) == 7);
+    CHECK(LLadd(linked, (void *)1L) != NULL);
+    errno = 0;
+    CHECK(LLnextbatch(&it, out, 7) == -1);
+    CHECK(errno == EFAULT);
+    CHECK(it.next(&it) == NULL);
+    it.reset(&it);
+    CHECK(LLnextbatch(&it, out, 7) == 7);
+    CHECK(out[0] == (void *)ref[0]);
+    LLdispose(linked);
+}
+
+
+int main(void) {
+    freopen("/dev/null", "w", stderr);
+    arrays();
+    linked();
+    removes();
+    changes();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,181 @@
+/**
+ *  @file   test_concurrent.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of concurrent appends to an ArrayList
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  PRODUCERS threads append PER known values each to a concurrent list,
+ *  one at a time and in batches through ALaddall, while another thread
+ *  reads the committed prefix as it grows. After joining, the list must
+ *  hold every value exactly once, each producer's values in the order it
+ *  appended them. Plain and record lists are both covered.
+ */
+#include "harness.h"
+#include <errno.h>
+#include <string.h>
+#include <pthread.h>
+#include "arraylist.h"
+
+#define PRODUCERS 8
+#define PER 25000
+#define TOTAL (PRODUCERS*PER)
+#define BATCH 5
+#define BLOCK 64
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Record {
+    long value;
+    long producer;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static ArrayList list = -1;
+static char record = 0;
+static char seen[TOTAL + 1];
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static long valueat(int i, long *producer) {
+    struct _Record *r = ALget(list, i);
+    long v = 0;
+    
+    CHECK(r != NULL);
+    if (record) {
+        v = r->value;
+        CHECK(r->producer == (v - 1)/PER);
+    } else {
+        v = (long)r;
+    }
+    CHECK((v >= 1) && (v <= TOTAL));
+    if (producer != NULL) {
+        *producer = (v - 1)/PER;
+    }
+    return v;
+}
+
+static void *producer(void *arg) {
+    long id = (long)arg;
+    long first = id*PER + 1;
+    struct _Record batch[BATCH];
+    void *values[BATCH];
+    long k = 0;
+    int j = 0;
+    
+    while (k < PER) {
+        if ((k % 7 == 0) && (k + BATCH <= PER)) {
+            for (j = 0; j < BATCH; j++) {
+                batch[j].value = first + k + j;
+                batch[j].producer = id;
+                values[j] = (void *)(first + k + j);
+            }
+            CHECK(ALaddall(list, record?(void **)batch:values, BATCH) == BATCH);
+            k += BATCH;
+        } else {
+            batch[0].value = first + k;
+            batch[0].producer = id;
+            if (record) {
+                CHECK(ALadd(list, &batch[0]) != NULL);
+            } else {
+                CHECK(ALpushback(list, (void *)(first + k)) == (void *)(first + k));
+            }
+            k++;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * The committed prefix only grows, and every element in it is complete.
+ */
+static void *reader(void *arg) {
+    int size = 0, last = 0, i = 0;
+    
+    (void)arg;
+    while (last < TOTAL) {
+        CHECK((size = ALsize(list)) >= last);
+        for (i = last; i < size; i++) {
+            valueat(i, NULL);
+        }
+        if (size > 0) {
+            valueat(size - 1, NULL);
+            valueat(size/2, NULL);
+        }
+        last = size;
+    }
+    return NULL;
+}
+
+static void run(void) {
+    pthread_t threads[PRODUCERS + 1];
+    long next[PRODUCERS];
+    long v = 0, p = 0;
+    int i = 0;
+    
+    list = ALnewconcurrent(BLOCK, record?sizeof(struct _Record):0);
+    CHECK(list >= 0);
+    CHECK(pthread_create(&threads[PRODUCERS], NULL, reader, NULL) == 0);
+    for (i = 0; i < PRODUCERS; i++) {
+        CHECK(pthread_create(&threads[i], NULL, producer, (void *)(long)i) == 0);
+    }
+    for (i = 0; i <= PRODUCERS; i++) {
+        CHECK(pthread_join(threads[i], NULL) == 0);
+    }
+    
+    CHECK(ALsize(list) == TOTAL);
+    memset(seen, 0, sizeof(seen));
+    for (i = 0; i < PRODUCERS; i++) {
+        next[i] = i*PER + 1;
+    }
+    for (i = 0; i < TOTAL; i++) {
+        v = valueat(i, &p);
+        CHECK(!seen[v]);
+        seen[v] = 1;
+        CHECK(v == next[p]);
+        next[p]++;
+    }
+    errno = 0;
+    CHECK(ALremove(list, 0) == NULL);
+    CHECK(errno == EINVAL);
+    CHECK(ALsize(list) == TOTAL);
+    ALdispose(list);
+}
+
+
+int main(void) {
+    for (record = 0; record < 2; record++) {
+        run();
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,301 @@
+/**
+ *  @file   test_controller.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Stress test of the shared handle controller
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Threads claim and dispose bursts of ArrayList and LinkedList handles,
+ *  so segments keep being added and released, while they all append to
+ *  one shared list and a stats dump walks the table. Handles disposed
+ *  last must be rejected once the threads are done. A single slot is
+ *  then disposed CYCLES times over, and a handle from its first cycle
+ *  must be rejected throughout. Last, every container's table is filled
+ *  to its cap, where each of its constructors must fail with EAGAIN
+ *  instead of exiting, and work again once a handle is disposed.
+ *  Rejections are reported on stderr, which is silenced.
+ */
+#include "harness.h"
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "arraylist.h"
+#include "linkedlist.h"
+#include "unrolledlist.h"
+#include "sortedlist.h"
+#include "hashmap.h"
+#include "queue.h"
+#include "deque.h"
+#include "controller.h"
+
+#define THREADS 8
+#define ROUNDS 2000
+#define BURST 64
+#define CYCLES 30000
+#define CAP (CT_FIRSTSEGMENT*((1 << CT_MAXSEGMENTS) - 1))
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static ArrayList shared = -1;
+static FILE *sink = NULL;
+static ArrayList stale[THREADS][BURST];
+static int nstale[THREADS];
+static int handles[CAP];
+static char plainfile[] = "/tmp/test_controllerXXXXXX";
+static char recordfile[] = "/tmp/test_controllerXXXXXX";
+
+/**
+ * Static-scope functions definition
+ *
+ */
+/*
+ * Claims a burst of lists, checks each holds only what this thread put
+ * in it, then disposes them all so trailing segments can be released.
+ * Handles of the last burst are kept to check once every thread is
+ * done, as a stale handle may not be used while the table shrinks.
+ */
+static void *worker(void *arg) {
+    unsigned long state = 0x9E3779B97F4A7C15UL*((unsigned long)(size_t)arg + 1);
+    ArrayList arrays[BURST];
+    LinkedList links[BURST];
+    long id = (long)(size_t)arg;
+    int round = 0, n = 0, i = 0;
+    
+    for (round = 0; round < ROUNDS; round++) {
+        n = 1 + (int)(nextrand(&state) % BURST);
+        for (i = 0; i < n; i++) {
+            arrays[i] = ALnew(4);
+            links[i] = LLnew();
+            CHECK((arrays[i] >= 0) && (links[i] >= 0));
+            ALadd(arrays[i], (void *)id);
+            LLadd(links[i], (void *)(id + i));
+        }
+        ALadd(shared, (void *)id);
+        if (round % 64 == 0) {
+            ALdumpstats(sink);
+        }
+        for (i = 0; i < n; i++) {
+            CHECK(ALsize(arrays[i]) == 1);
+            CHECK(ALget(arrays[i], 0) == (void *)id);
+            CHECK(LLget(links[i], 0) == (void *)(id + i));
+        }
+        for (i = 0; i < n; i++) {
+            ALdispose(arrays[i]);
+            LLdispose(links[i]);
+            stale[id][i] = arrays[i];
+        }
+        nstale[id] = n;
+    }
+    return NULL;
+}
+
+/*
+ * Free slots are reused last in, first out, so claiming right after a
+ * dispose takes the same slot with the next generation.
+ */
+static void wraparound(void) {
+    ArrayList stale = ALnew(0);
+    ArrayList list = -1;
+    int cycle = 0;
+    
+    ALadd(stale, (void *)1L);
+    ALdispose(stale);
+    CHECK(CYCLES <= CT_GENMASK);
+    for (cycle = 1; cycle <= CYCLES; cycle++) {
+        list = ALnew(0);
+        CHECK((list & CT_INDEXMASK) == (stale & CT_INDEXMASK));
+        CHECK(list != stale);
+        CHECK(ALsize(stale) == -1);
+        CHECK(ALadd(list, (void *)2L) == (void *)2L);
+        ALdispose(list);
+        CHECK(ALsize(list) == -1);
+    }
+    CHECK(ALsize(stale) == -1);
+}
+
+static void *heapalloc(size_t size, void *ctx) {
+    (void)ctx;
+    return malloc(size);
+}
+
+static void *heapresize(void *p, size_t from, size_t to, void *ctx) {
+    (void)from;
+    (void)ctx;
+    return realloc(p, to);
+}
+
+static void heaprelease(void *p, size_t size, void *ctx) {
+    (void)size;
+    (void)ctx;
+    free(p);
+}
+
+static int savelong(void *elem, FILE *f, void *ctx) {
+    (void)ctx;
+    return (fwrite(&elem, sizeof(elem), 1, f) == 1)?0:-1;
+}
+
+static int loadlong(FILE *f, void **elem, void *ctx) {
+    (void)ctx;
+    return (fread(elem, sizeof(*elem), 1, f) == 1)?0:-1;
+}
+
+static int before(const void *x, const void *y) {
+    return (x > y) - (x < y);
+}
+
+static int newarray(void) { return ALnew(1); }
+static int newlinked(void) { return LLnew(); }
+static int newunrolled(void) { return ULnew(); }
+static int newsorted(void) { return SLnew(before); }
+static int newmap(void) { return HMnew(0, NULL, NULL); }
+static int newqueue(void) { return QUnew(1); }
+static int newdeque(void) { return DQnew(0); }
+
+/*
+ * Claims handles with make until the table is full, keeping n already
+ * taken, and checks it filled up to the cap. The last one is given back
+ * and taken again to show the table works past the failure.
+ */
+static void fill(int (*make)(void), void (*drop)(int), int n) {
+    int i = 0;
+    
+    for (i = n; i < CAP; i++) {
+        handles[i] = make();
+        CHECK(handles[i] >= 0);
+    }
+    errno = 0;
+    CHECK(make() == -1);
+    CHECK(errno == EAGAIN);
+    drop(handles[CAP - 1]);
+    CHECK((handles[CAP - 1] = make()) >= 0);
+    errno = 0;
+    CHECK(make() == -1);
+    CHECK(errno == EAGAIN);
+}
+
+static void drain(void (*drop)(int)) {
+    int i = 0;
+    
+    for (i = 0; i < CAP; i++) {
+        drop(handles[i]);
+    }
+}
+
+static void failed(int handler) {
+    CHECK(handler == -1);
+    CHECK(errno == EAGAIN);
+    errno = 0;
+}
+
+/*
+ * The two saved lists are kept among the handles, so they count
+ * against the cap.
+ */
+static void exhaust(void) {
+    allocator heap = { heapalloc, heapresize, heaprelease, NULL };
+    long one = 1;
+    int fd = -1;
+    
+    CHECK((fd = mkstemp(plainfile)) >= 0);
+    close(fd);
+    CHECK((fd = mkstemp(recordfile)) >= 0);
+    close(fd);
+    handles[0] = ALnewsized(0, sizeof(long));
+    handles[1] = ALnew(0);
+    CHECK(ALadd(handles[0], &one) != NULL);
+    CHECK(ALadd(handles[1], (void *)one) != NULL);
+    CHECK(ALsave(handles[0], recordfile, NULL, NULL) == 0);
+    CHECK(ALsave(handles[1], plainfile, savelong, NULL) == 0);
+    fill(newarray, ALdispose, 2);
+    errno = 0;
+    failed(ALnewsized(0, sizeof(long)));
+    failed(ALnewsegmented(16, 0));
+    failed(ALnewconcurrent(16, 0));
+    failed(ALnewwith(0, 0, &heap));
+    failed(ALmap(handles[1], NULL, NULL));
+    failed(ALload(recordfile, NULL, NULL, NULL));
+    failed(ALload(plainfile, loadlong, NULL, NULL));
+    failed(ALloadmapped(recordfile));
+    CHECK(ALsize(handles[1]) == 1);
+    drain(ALdispose);
+    
+    fill(newlinked, LLdispose, 0);
+    failed(LLnewwith(&heap));
+    failed(LLload(plainfile, loadlong, NULL, NULL));
+    drain(LLdispose);
+    fill(newunrolled, ULdispose, 0);
+    drain(ULdispose);
+    fill(newsorted, SLdispose, 0);
+    drain(SLdispose);
+    fill(newmap, HMdispose, 0);
+    failed(HSnew(0, NULL, NULL));
+    drain(HMdispose);
+    fill(newqueue, QUdispose, 0);
+    drain(QUdispose);
+    fill(newdeque, DQdispose, 0);
+    drain(DQdispose);
+    unlink(plainfile);
+    unlink(recordfile);
+}
+
+
+int main(void) {
+    pthread_t threads[THREADS];
+    long counts[THREADS] = {0};
+    long i = 0;
+    int j = 0;
+    
+    sink = fopen("/dev/null", "w");
+    CHECK(sink != NULL);
+    CHECK(freopen("/dev/null", "w", stderr) != NULL);
+    shared = ALnew(0);
+    for (i = 0; i < THREADS; i++) {
+        CHECK(pthread_create(&threads[i], NULL, worker, (void *)(size_t)i) == 0);
+    }
+    for (i = 0; i < THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    CHECK(ALsize(shared) == THREADS*ROUNDS);
+    for (i = 0; i < THREADS*ROUNDS; i++) {
+        counts[(long)ALget(shared, (int)i)]++;
+    }
+    for (i = 0; i < THREADS; i++) {
+        CHECK(counts[i] == ROUNDS);
+    }
+    for (i = 0; i < THREADS; i++) {
+        for (j = 0; j < nstale[i]; j++) {
+            CHECK(ALsize(stale[i][j]) == -1);
+        }
+    }
+    ALdispose(shared);
+    wraparound();
+    exhaust();
+    fclose(sink);
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,201 @@
+/**
+ *  @file   test_deque.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of Deque pops racing steals
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  First the owner pushes a single element and pops it while THIEVES
+ *  threads steal at the same moment, over and over: exactly one of them
+ *  must get it. Then, on a fresh deque every round, the owner pushes a
+ *  burst that keeps doubling the ring, retiring the old ones to the
+ *  epoch collector while thieves may still read them, and pops some back
+ *  in between. Every value must be taken exactly once, by the owner or
+ *  by a thief.
+ */
+#include "harness.h"
+#include <pthread.h>
+#include <sched.h>
+#include "deque.h"
+
+#define THIEVES 3
+#define RACES 20000
+#define ROUNDS 50
+#define BURST 4000
+#define TOTAL (ROUNDS*BURST)
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static Deque deque = -1;
+static pthread_barrier_t barrier;
+static void *stolen[THIEVES];
+static char seen[THIEVES + 1][TOTAL + 1];
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int done = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *racer(void *arg) {
+    long id = (long)arg;
+    int k = 0;
+    
+    for (k = 0; k < RACES; k++) {
+        pthread_barrier_wait(&barrier);
+        stolen[id] = DQsteal(deque);
+        pthread_barrier_wait(&barrier);
+    }
+    return NULL;
+}
+
+/*
+ * One element, one pop and THIEVES steals at once.
+ */
+static void races(void) {
+    pthread_t threads[THIEVES];
+    void *popped = NULL;
+    long k = 0;
+    int i = 0, winners = 0;
+    
+    CHECK((deque = DQnew(0)) >= 0);
+    for (i = 0; i < THIEVES; i++) {
+        CHECK(pthread_create(&threads[i], NULL, racer, (void *)(long)i) == 0);
+    }
+    for (k = 1; k <= RACES; k++) {
+        CHECK(DQpush(deque, (void *)k) == 0);
+        pthread_barrier_wait(&barrier);
+        popped = DQpop(deque);
+        pthread_barrier_wait(&barrier);
+        winners = (popped != NULL);
+        CHECK((popped == NULL) || (popped == (void *)k));
+        for (i = 0; i < THIEVES; i++) {
+            CHECK((stolen[i] == NULL) || (stolen[i] == (void *)k));
+            winners += (stolen[i] != NULL);
+        }
+        CHECK(winners == 1);
+        CHECK(DQsize(deque) == 0);
+    }
+    for (i = 0; i < THIEVES; i++) {
+        CHECK(pthread_join(threads[i], NULL) == 0);
+    }
+    DQdispose(deque);
+}
+
+static int finished(void) {
+    int d = 0;
+    
+    pthread_mutex_lock(&lock);
+    d = done;
+    pthread_mutex_unlock(&lock);
+    return d;
+}
+
+static void take(int who, void *elem) {
+    long v = (long)elem;
+    
+    CHECK((v >= 1) && (v <= TOTAL));
+    CHECK(!seen[who][v]);
+    seen[who][v] = 1;
+}
+
+/*
+ * Steals from the deque of each round until the owner is done with it.
+ */
+static void *thief(void *arg) {
+    long id = (long)arg;
+    void *elem = NULL;
+    int round = 0, k = 0;
+    
+    for (round = 0; round < ROUNDS; round++) {
+        pthread_barrier_wait(&barrier);
+        for (k = 0; (k % 64 != 0) || !finished(); k++) {
+            if ((elem = DQsteal(deque)) != NULL) {
+                take((int)id, elem);
+            } else {
+                sched_yield();
+            }
+        }
+        while ((elem = DQsteal(deque)) != NULL) {
+            take((int)id, elem);
+        }
+        pthread_barrier_wait(&barrier);
+    }
+    return NULL;
+}
+
+static void growth(void) {
+    pthread_t threads[THIEVES];
+    unsigned long state = 0x853C49E6748FEA9BUL;
+    void *elem = NULL;
+    long v = 1;
+    int round = 0, i = 0, k = 0, taken = 0;
+    
+    for (i = 0; i < THIEVES; i++) {
+        CHECK(pthread_create(&threads[i], NULL, thief, (void *)(long)i) == 0);
+    }
+    for (round = 0; round < ROUNDS; round++) {
+        CHECK((deque = DQnew(0)) >= 0);
+        done = 0;
+        pthread_barrier_wait(&barrier);
+        for (k = 0; k < BURST; k++) {
+            CHECK(DQpush(deque, (void *)v++) == 0);
+            if ((nextrand(&state) % 8 == 0) && ((elem = DQpop(deque)) != NULL)) {
+                take(THIEVES, elem);
+            }
+        }
+        while ((elem = DQpop(deque)) != NULL) {
+            take(THIEVES, elem);
+        }
+        pthread_mutex_lock(&lock);
+        done = 1;
+        pthread_mutex_unlock(&lock);
+        pthread_barrier_wait(&barrier);
+        CHECK(DQsize(deque) == 0);
+        DQdispose(deque);
+    }
+    for (i = 0; i < THIEVES; i++) {
+        CHECK(pthread_join(threads[i], NULL) == 0);
+    }
+    
+    for (v = 1; v <= TOTAL; v++) {
+        for (i = 0, taken = 0; i <= THIEVES; i++) {
+            taken += seen[i][v];
+        }
+        CHECK(taken == 1);
+    }
+}
+
+
+int main(void) {
+    CHECK(pthread_barrier_init(&barrier, NULL, THIEVES + 1) == 0);
+    races();
+    growth();
+    pthread_barrier_destroy(&barrier);
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,179 @@
+/**
+ *  @file   test_epoch.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of epoch reclamation past EP_MAXTHREADS threads
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  More threads than there are epoch records are all kept alive at
+ *  once, so the last ones share the overflow record. Each reads a
+ *  shared object inside nested sections and snapshots a segmented list
+ *  while a writer keeps replacing the object, retiring the old one, and
+ *  appending to and publishing the list. A retired object is poisoned
+ *  before it is freed, so a reader finding the poison saw memory
+ *  reclaimed under it. Once the readers are idle but still registered,
+ *  collecting must free everything retired.
+ */
+#include "harness.h"
+#include <pthread.h>
+#include "arraylist.h"
+#include "epoch.h"
+
+#define READERS (EP_MAXTHREADS + 44)
+#define ROUNDS 200
+#define MAGIC 0x5EEDL
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Object {
+    long magic;
+    long serial;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static struct _Object *current = NULL;
+static ArrayList list = -1;
+static pthread_barrier_t registered, idle, done;
+static int stop = 0;
+static long retired = 0;
+static long destroyed = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void poison(void *p) {
+    struct _Object *o = p;
+    
+    o->magic = 0;
+    __atomic_add_fetch(&destroyed, 1, __ATOMIC_RELAXED);
+    free(o);
+}
+
+static struct _Object *fresh(long serial) {
+    struct _Object *o = malloc(sizeof(struct _Object));
+    
+    CHECK(o != NULL);
+    o->magic = MAGIC;
+    o->serial = serial;
+    return o;
+}
+
+static void snapshot(void) {
+    view *v = ALsnapshot(list);
+    int n = 0;
+    
+    CHECK(v != NULL);
+    n = ALviewsize(v);
+    CHECK(n >= 1);
+    CHECK(ALviewget(v, 0) == (void *)1L);
+    CHECK(ALviewget(v, n - 1) == (void *)(long)n);
+    ALviewrelease(v);
+}
+
+static void *reader(void *arg) {
+    struct _Object *o = NULL;
+    long last = 0;
+    int round = 0;
+    
+    (void)arg;
+    EPenter();
+    EPexit();
+    pthread_barrier_wait(&registered);
+    for (round = 0; round < ROUNDS; round++) {
+        EPenter();
+        o = __atomic_load_n(&current, __ATOMIC_ACQUIRE);
+        EPenter();
+        CHECK(o->magic == MAGIC);
+        EPexit();
+        CHECK(o->serial >= last);
+        last = o->serial;
+        CHECK(o->magic == MAGIC);
+        EPexit();
+        snapshot();
+    }
+    pthread_barrier_wait(&idle);
+    pthread_barrier_wait(&done);
+    return NULL;
+}
+
+/*
+ * Replaces the object and grows the list until every reader is done.
+ */
+static void *writer(void *arg) {
+    struct _Object *old = NULL;
+    long serial = 1;
+    
+    (void)arg;
+    while (!__atomic_load_n(&stop, __ATOMIC_ACQUIRE)) {
+        old = __atomic_exchange_n(&current, fresh(++serial), __ATOMIC_ACQ_REL);
+        EPretire(old, poison);
+        retired++;
+        CHECK(ALadd(list, (void *)(long)(ALsize(list) + 1)) != NULL);
+        if (serial % 8 == 0) {
+            CHECK(ALpublish(list) == 0);
+        }
+    }
+    return NULL;
+}
+
+
+int main(void) {
+    pthread_t readers[READERS];
+    pthread_t tid;
+    int i = 0;
+    
+    current = fresh(1);
+    list = ALnewsegmented(16, 0);
+    CHECK(ALadd(list, (void *)1L) != NULL);
+    CHECK(ALpublish(list) == 0);
+    CHECK(pthread_barrier_init(&registered, NULL, READERS + 1) == 0);
+    CHECK(pthread_barrier_init(&idle, NULL, READERS + 1) == 0);
+    CHECK(pthread_barrier_init(&done, NULL, READERS + 1) == 0);
+    for (i = 0; i < READERS; i++) {
+        CHECK(pthread_create(&readers[i], NULL, reader, NULL) == 0);
+    }
+    pthread_barrier_wait(&registered);
+    CHECK(pthread_create(&tid, NULL, writer, NULL) == 0);
+    pthread_barrier_wait(&idle);
+    __atomic_store_n(&stop, 1, __ATOMIC_RELEASE);
+    CHECK(pthread_join(tid, NULL) == 0);
+    EPcollect();
+    EPcollect();
+    CHECK(__atomic_load_n(&destroyed, __ATOMIC_RELAXED) == retired);
+    pthread_barrier_wait(&done);
+    for (i = 0; i < READERS; i++) {
+        CHECK(pthread_join(readers[i], NULL) == 0);
+    }
+    ALdispose(list);
+    free(current);
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,159 @@
+/**
+ *  @file   test_growth.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of ArrayList growth policies at the edges of capacity
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Every policy must leave room for what is added, however little its
+ *  callback returns, and no policy may ask for more than INT_MAX slots,
+ *  however large its factor or amount. An allocator that records the
+ *  sizes asked of it and refuses anything large checks the latter
+ *  without allocating it. Adding more than any list can hold fails with
+ *  ENOMEM and leaves the list as it was.
+ */
+#include "harness.h"
+#include <errno.h>
+#include <limits.h>
+#include "arraylist.h"
+
+#define SMALL (1 << 20)
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static size_t largest = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *boundedalloc(size_t size, void *ctx) {
+    (void)ctx;
+    largest = (size > largest)?size:largest;
+    return (size > SMALL)?NULL:malloc(size);
+}
+
+static void *boundedresize(void *p, size_t old, size_t size, void *ctx) {
+    (void)old;
+    (void)ctx;
+    largest = (size > largest)?size:largest;
+    return (size > SMALL)?NULL:realloc(p, size);
+}
+
+static void boundedrelease(void *p, size_t size, void *ctx) {
+    (void)size;
+    (void)ctx;
+    free(p);
+}
+
+static int nothing(int total, int needed, void *ctx) {
+    (void)total;
+    (void)needed;
+    return *(int *)ctx;
+}
+
+static void fill(ArrayList list, int n) {
+    int i = 0;
+    
+    for (i = 0; i < n; i++) {
+        CHECK(ALadd(list, (void *)(long)(i + 1)) == (void *)(long)(i + 1));
+    }
+    CHECK(ALsize(list) == n);
+    CHECK(ALcapacity(list) >= n);
+    for (i = 0; i < n; i++) {
+        CHECK(ALget(list, i) == (void *)(long)(i + 1));
+    }
+}
+
+/*
+ * Appends until the policy asks for a capacity the allocator refuses,
+ * which must be the largest a list can have.
+ */
+static void overgrow(ArrayList list) {
+    int size = ALsize(list);
+    
+    largest = 0;
+    while (ALadd(list, (void *)1L) != NULL) {
+        size++;
+        CHECK(size < SMALL);
+    }
+    CHECK(errno == ENOMEM);
+    CHECK(largest == (size_t)INT_MAX*sizeof(void *));
+    CHECK(ALsize(list) == size);
+}
+
+
+int main(void) {
+    static const int returns[] = { 0, -1, 1, INT_MIN };
+    allocator bounded = { boundedalloc, boundedresize, boundedrelease, NULL };
+    ArrayList list = -1;
+    int k = 0;
+    
+    CHECK(freopen("/dev/null", "w", stderr) != NULL);
+    for (k = 0; k < (int)(sizeof(returns)/sizeof(returns[0])); k++) {
+        list = ALnew(1);
+        CHECK(ALgrowwith(list, nothing, (void *)&returns[k]) == 0);
+        fill(list, 1000);
+        ALdispose(list);
+    }
+    
+    list = ALnewwith(4, 0, &bounded);
+    CHECK(ALgrowbyfactor(list, 1e300) == 0);
+    overgrow(list);
+    ALdispose(list);
+    
+    list = ALnewwith(4, 0, &bounded);
+    CHECK(ALgrowbyamount(list, INT_MAX) == 0);
+    overgrow(list);
+    ALdispose(list);
+    
+    list = ALnewwith(4, 0, &bounded);
+    k = INT_MAX;
+    CHECK(ALgrowwith(list, nothing, &k) == 0);
+    overgrow(list);
+    ALdispose(list);
+    
+    list = ALnew(0);
+    fill(list, 10);
+    errno = 0;
+    CHECK(ALinsertrange(list, 10, (void **)&list, INT_MAX) == -1);
+    CHECK(errno == ENOMEM);
+    CHECK(ALsize(list) == 10);
+    CHECK(ALget(list, 9) == (void *)10L);
+    ALdispose(list);
+    
+    list = ALnewwith(4, 0, &bounded);
+    fill(list, 10);
+    largest = 0;
+    CHECK(ALinsertrange(list, 0, (void **)&list, INT_MAX - 10) == -1);
+    CHECK(largest == (size_t)INT_MAX*sizeof(void *));
+    CHECK(ALsize(list) == 10);
+    CHECK(ALget(list, 9) == (void *)10L);
+    ALdispose(list);
+    printf("ok\n");
+    return 0;
+}
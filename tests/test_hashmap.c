@@ -0,0 +1,298 @@
+/**
+ *  @file   test_hashmap.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of HashMap puts, removes and iteration against a reference array
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Random puts, overwrites and removes run against a plain array of
+ *  values through many incremental moves to larger tables, with targeted
+ *  overwrites and removes of keys on both sides of a move right after it
+ *  starts, and iterators taken while one is going on. Keys that all hash
+ *  alike then pile into one full group, where removals leave tombstones
+ *  that later puts must take back without counting against growthleft,
+ *  and a long erase-heavy churn must keep the table from growing.
+ */
+#include "harness.h"
+#include <string.h>
+#include <errno.h>
+#include "hashmap.h"
+
+#define KEYS 6000
+#define STEPS 400000
+#define PILE 20
+#define CHURN 200000
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static long values[KEYS + 1];
+static int nvalues = 0;
+static long version = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *key(long k) {
+    return (void *)k;
+}
+
+static size_t same(const void *k) {
+    (void)k;
+    return 42;
+}
+
+static void checkmap(HashMap map) {
+    long k = 0;
+    
+    CHECK(HMsize(map) == nvalues);
+    for (k = 1; k <= KEYS; k++) {
+        CHECK(HMget(map, key(k)) == (void *)values[k]);
+        CHECK(HMcontains(map, key(k)) == (values[k] != 0));
+    }
+}
+
+static void put(HashMap map, long k) {
+    long value = ++version;
+    
+    CHECK(HMput(map, key(k), (void *)value) == (void *)values[k]);
+    nvalues += (values[k] == 0);
+    values[k] = value;
+}
+
+static void erase(HashMap map, long k) {
+    CHECK(HMremove(map, key(k)) == (void *)values[k]);
+    nvalues -= (values[k] != 0);
+    values[k] = 0;
+}
+
+/*
+ * Every key exactly once, with its value in cursor, from an iterator
+ * that finishes whatever move is going on.
+ */
+static void checkiterator(HashMap map) {
+    static char seen[KEYS + 1];
+    iterator it = HMiterator(map);
+    long k = 0;
+    int n = 0;
+    
+    memset(seen, 0, sizeof(seen));
+    while (it.hasnext) {
+        k = (long)it.next(&it);
+        CHECK((k >= 1) && (k <= KEYS));
+        CHECK(!seen[k]);
+        seen[k] = 1;
+        CHECK(it.cursor == (void *)values[k]);
+        n++;
+    }
+    CHECK(n == nvalues);
+    CHECK(it.next(&it) == NULL);
+}
+
+/*
+ * Puts until the table starts moving to a larger one.
+ */
+static void startmove(HashMap map, unsigned long *state) {
+    int capacity = HMcapacity(map);
+    long k = 0;
+    
+    while (HMcapacity(map) == capacity) {
+        CHECK(nvalues < KEYS);
+        do {
+            k = (long)(nextrand(state) % KEYS) + 1;
+        } while (values[k] != 0);
+        put(map, k);
+    }
+}
+
+static void randomwalk(HashMap map, unsigned long *state) {
+    long k = 0;
+    int step = 0;
+    
+    for (step = 0; step < STEPS; step++) {
+        k = (long)(nextrand(state) % KEYS) + 1;
+        switch (nextrand(state) % 4) {
+            case 0:
+            case 1:
+                put(map, k);
+                break;
+            case 2:
+                erase(map, k);
+                break;
+            default:
+                CHECK(HMget(map, key(k)) == (void *)values[k]);
+                break;
+        }
+        if (step % 50000 == 0) {
+            checkmap(map);
+        }
+    }
+    checkmap(map);
+}
+
+/*
+ * Right after a move starts most keys are still in the old table and
+ * the latest one is in the new, so overwriting and removing every key
+ * in turn hits both. Each round doubles the table three times.
+ */
+static void moves(HashMap map, unsigned long *state) {
+    iterator it;
+    long k = 0;
+    int round = 0, n = 0;
+    
+    for (round = 0; round < 2; round++) {
+        startmove(map, state);
+        for (k = 1; k <= KEYS; k++) {
+            if (values[k] != 0) {
+                if (k % 3 == 0) {
+                    erase(map, k);
+                } else {
+                    put(map, k);
+                }
+            }
+        }
+        checkmap(map);
+        
+        startmove(map, state);
+        checkiterator(map);
+        startmove(map, state);
+        it = HMiterator(map);
+        for (n = 0; it.hasnext; n++) {
+            k = (long)it.next(&it);
+            if (n % 2) {
+                CHECK(it.remove(&it) == (void *)values[k]);
+                nvalues--;
+                values[k] = 0;
+            }
+        }
+        checkmap(map);
+    }
+    HMpurge(map);
+    memset(values, 0, sizeof(values));
+    nvalues = 0;
+    checkmap(map);
+}
+
+/*
+ * PILE keys of one hash fill their home group and spill into the next.
+ * Emptying the full group leaves tombstones only, which a put takes back
+ * in slot order; none of this may use up growthleft, or the table would
+ * double with more than 7/16 of it used.
+ */
+static void tombstones(void) {
+    HashMap map = HMnew(20, same, NULL);
+    iterator it;
+    long order[PILE];
+    long k = 0, fresh = PILE;
+    int capacity = HMcapacity(map);
+    int i = 0, cycle = 0;
+    
+    CHECK(capacity == 2*HM_GROUP);
+    for (k = 1; k <= PILE; k++) {
+        CHECK(HMput(map, key(k), key(k)) == NULL);
+    }
+    it = HMiterator(map);
+    for (i = 0; i < PILE; i++) {
+        order[i] = (long)it.next(&it);
+    }
+    for (cycle = 0; cycle < 1000; cycle++) {
+        i = cycle % HM_GROUP;
+        CHECK(HMremove(map, key(order[i])) == key(order[i]));
+        CHECK(!HMcontains(map, key(order[i])));
+        order[i] = ++fresh;
+        CHECK(HMput(map, key(fresh), key(fresh)) == NULL);
+        CHECK(HMcapacity(map) == capacity);
+    }
+    it = HMiterator(map);
+    for (i = 0; i < PILE; i++) {
+        CHECK((long)it.next(&it) == order[i]);
+    }
+    for (i = 0; i < HM_GROUP; i++) {
+        CHECK(HMremove(map, key(order[i])) == key(order[i]));
+    }
+    CHECK(HMsize(map) == PILE - HM_GROUP);
+    for (i = 0; i < HM_GROUP; i++) {
+        order[i] = ++fresh;
+        CHECK(HMput(map, key(fresh), key(fresh)) == NULL);
+    }
+    CHECK(HMcapacity(map) == capacity);
+    for (i = 0; i < PILE; i++) {
+        CHECK(HMget(map, key(order[i])) == key(order[i]));
+    }
+    CHECK(HMget(map, key(++fresh)) == NULL);
+    HMdispose(map);
+}
+
+/*
+ * Replacing keys one by one at a steady size under 7/16 of the table
+ * must keep reusing space: same-size rehashes may clear tombstones, but
+ * the table never doubles and missing keys are still found missing.
+ */
+static void churn(unsigned long *state) {
+    HashMap map = HMnew(KEYS/2, NULL, NULL);
+    int capacity = HMcapacity(map);
+    long k = 0;
+    int cycle = 0;
+    
+    for (k = 1; k <= KEYS/4; k++) {
+        put(map, k);
+    }
+    for (cycle = 0; cycle < CHURN; cycle++) {
+        do {
+            k = (long)(nextrand(state) % KEYS) + 1;
+        } while (values[k] == 0);
+        erase(map, k);
+        CHECK(HMget(map, key(k)) == NULL);
+        do {
+            k = (long)(nextrand(state) % KEYS) + 1;
+        } while (values[k] != 0);
+        CHECK(!HMcontains(map, key(k)));
+        put(map, k);
+        CHECK(HMcapacity(map) == capacity);
+    }
+    CHECK(HMsize(map) == KEYS/4);
+    checkmap(map);
+    HMdispose(map);
+}
+
+int main(void) {
+    unsigned long state = 0x9E3779B97F4A7C15UL;
+    HashMap map = HMnew(0, NULL, NULL);
+    
+    CHECK(map >= 0);
+    checkmap(map);
+    moves(map, &state);
+    randomwalk(map, &state);
+    HMdispose(map);
+    
+    memset(values, 0, sizeof(values));
+    nvalues = 0;
+    tombstones();
+    churn(&state);
+    printf("ok\n");
+    return 0;
+}
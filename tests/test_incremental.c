@@ -0,0 +1,245 @@
+/**
+ *  @file   test_incremental.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of ArrayList operations in the middle of an incremental growth
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Lists moving one element per call into their grown buffer are read,
+ *  written, popped, inserted into and removed from at indices on both
+ *  sides of the elements moved so far, then compared against a plain
+ *  array. Every call moves one more element, so a list that grew past
+ *  START/2 elements is still migrating for that many calls; only the
+ *  final full comparison of each case runs past it.
+ */
+#include "harness.h"
+#include <string.h>
+#include "arraylist.h"
+
+#define START 256
+#define MAXSIZE 1024
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Record {
+    long value;
+    long twice;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static long ref[MAXSIZE];
+static int nref = 0;
+static long fresh = 1;
+static char record = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *elem(long v, struct _Record *r) {
+    r->value = v;
+    r->twice = 2*v;
+    return record?(void *)r:(void *)v;
+}
+
+static long value(ArrayList list, int i) {
+    struct _Record *r = NULL;
+    
+    if (!record) {
+        return (long)ALget(list, i);
+    }
+    r = ALget(list, i);
+    CHECK(r->twice == 2*r->value);
+    return r->value;
+}
+
+static void checklist(ArrayList list) {
+    int i = 0;
+    
+    CHECK(ALsize(list) == nref);
+    for (i = 0; i < nref; i++) {
+        CHECK(value(list, i) == ref[i]);
+    }
+}
+
+static void add(ArrayList list) {
+    struct _Record r;
+    
+    CHECK(ALadd(list, elem(fresh, &r)) != NULL);
+    ref[nref++] = fresh++;
+}
+
+static void insert(ArrayList list, int i) {
+    struct _Record r;
+    
+    CHECK(ALset(list, i, elem(fresh, &r)) != NULL);
+    memmove(&ref[i + 1], &ref[i], sizeof(long)*(nref - i));
+    ref[i] = fresh++;
+    nref++;
+}
+
+static void removeat(ArrayList list, int i) {
+    if (record) {
+        CHECK(ALremove(list, i) == NULL);
+    } else {
+        CHECK(ALremove(list, i) == (void *)ref[i]);
+    }
+    memmove(&ref[i], &ref[i + 1], sizeof(long)*(nref - i - 1));
+    nref--;
+}
+
+/*
+ * A list that has just grown, with one element moved.
+ */
+static ArrayList growing(void) {
+    ArrayList list = record?ALnewsized(START, sizeof(struct _Record)):ALnew(START);
+    int capacity = 0;
+    
+    CHECK(list >= 0);
+    CHECK(ALgrowincrementally(list, 1) == 0);
+    nref = 0;
+    capacity = ALcapacity(list);
+    while (ALcapacity(list) == capacity) {
+        add(list);
+    }
+    CHECK(nref > START/2);
+    return list;
+}
+
+static void reads(void) {
+    ArrayList list = growing();
+    int k = 0;
+    
+    for (k = 0; k < 32; k++) {
+        CHECK(value(list, k) == ref[k]);
+        CHECK(value(list, nref - 1 - k) == ref[nref - 1 - k]);
+        CHECK(value(list, nref/2 + k) == ref[nref/2 + k]);
+    }
+    checklist(list);
+    ALdispose(list);
+}
+
+/*
+ * Records written in place on either side of the moved ones must be
+ * carried over by the rest of the move.
+ */
+static void writes(void) {
+    ArrayList list = growing();
+    struct _Record *r = NULL;
+    int k = 0, i = 0;
+    
+    for (k = 0; k < 32; k++) {
+        i = (k % 2)?(k/2):(nref - 1 - k);
+        r = ALget(list, i);
+        r->value = -ref[i];
+        r->twice = -2*ref[i];
+        ref[i] = -ref[i];
+    }
+    checklist(list);
+    ALdispose(list);
+}
+
+static void pops(void) {
+    ArrayList list = growing();
+    int k = 0;
+    
+    for (k = 0; k < 16; k++) {
+        removeat(list, nref - 1);
+        CHECK(value(list, k) == ref[k]);
+        CHECK(value(list, nref - 1) == ref[nref - 1]);
+    }
+    for (k = 0; k < 8; k++) {
+        add(list);
+        CHECK(value(list, nref - 2) == ref[nref - 2]);
+    }
+    checklist(list);
+    ALdispose(list);
+}
+
+static void removals(int low) {
+    ArrayList list = growing();
+    
+    CHECK(value(list, 2) == ref[2]);
+    removeat(list, low?1:(nref - 3));
+    CHECK(value(list, 1) == ref[1]);
+    removeat(list, low?(nref - 3):1);
+    CHECK(ALremoverange(list, 3, 5) == 2);
+    memmove(&ref[3], &ref[5], sizeof(long)*(nref - 5));
+    nref -= 2;
+    checklist(list);
+    ALdispose(list);
+}
+
+static void inserts(int low) {
+    ArrayList list = growing();
+    
+    CHECK(value(list, 2) == ref[2]);
+    insert(list, low?1:(nref - 3));
+    insert(list, low?(nref - 3):1);
+    add(list);
+    checklist(list);
+    ALdispose(list);
+}
+
+static void reshape(void) {
+    ArrayList list = growing();
+    
+    CHECK(value(list, 3) == ref[3]);
+    CHECK(ALshrinktofit(list) == nref);
+    checklist(list);
+    ALdispose(list);
+    
+    list = growing();
+    CHECK(value(list, 3) == ref[3]);
+    ALpurge(list);
+    nref = 0;
+    add(list);
+    add(list);
+    checklist(list);
+    ALdispose(list);
+}
+
+
+int main(void) {
+    for (record = 0; record < 2; record++) {
+        reads();
+        if (record) {
+            writes();
+        }
+        pops();
+        removals(1);
+        removals(0);
+        inserts(1);
+        inserts(0);
+        reshape();
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,271 @@
+/**
+ *  @file   test_linkedlist.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Randomized checks of LinkedList iterators
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  An iterator walks the list both ways at random, removing what it last
+ *  returned and inserting at its position, while a plain array takes the
+ *  same steps. Changing the list behind the iterator must then make
+ *  every call on it fail with EFAULT. The same list is then indexed and
+ *  read, inserted into and removed from by position, at random and at
+ *  the first node under the head tower, with the index switched off
+ *  and on again along the way.
+ */
+#include "harness.h"
+#include <errno.h>
+#include "linkedlist.h"
+
+#define STEPS 200000
+#define MAXSIZE 4096
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static void *ref[MAXSIZE];
+static int nref = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void refinsert(int i, void *elem) {
+    int k = 0;
+    
+    for (k = nref; k > i; k--) {
+        ref[k] = ref[k - 1];
+    }
+    ref[i] = elem;
+    nref++;
+}
+
+static void refremove(int i) {
+    int k = 0;
+    
+    for (k = i; k < nref - 1; k++) {
+        ref[k] = ref[k + 1];
+    }
+    nref--;
+}
+
+static void checklist(LinkedList list) {
+    iterator it = LLiterator(list);
+    int i = 0;
+    
+    CHECK(LLsize(list) == nref);
+    for (i = 0; i < nref; i++) {
+        CHECK(it.hasnext);
+        CHECK(it.next(&it) == ref[i]);
+    }
+    CHECK(!it.hasnext);
+}
+
+/*
+ * Every position through LLget, which an indexed list finds by adding up
+ * tower widths.
+ */
+static void checkindexed(LinkedList list) {
+    int i = 0;
+    
+    CHECK(LLsize(list) == nref);
+    for (i = 0; i < nref; i++) {
+        CHECK(LLget(list, i) == ref[i]);
+    }
+    errno = 0;
+    CHECK(LLget(list, nref) == NULL);
+    CHECK(errno == EINVAL);
+}
+
+/*
+ * cursor is the position next would return, last that of the element
+ * the last next or prev returned, -1 after a remove or an insert.
+ */
+static void walk(LinkedList list, unsigned long *state) {
+    iterator it = LLiterator(list);
+    long fresh = 1;
+    int cursor = 0, last = -1, step = 0;
+    
+    for (step = 0; step < STEPS; step++) {
+        CHECK(it.hasnext == (cursor < nref));
+        CHECK(it.hasprev == (cursor > 0));
+        CHECK(it.total_elems == nref);
+        switch (nextrand(state) % 5) {
+            case 0:
+                if (cursor < nref) {
+                    CHECK(it.next(&it) == ref[cursor]);
+                    last = cursor++;
+                }
+                break;
+            case 1:
+                if (cursor > 0) {
+                    CHECK(it.prev(&it) == ref[--cursor]);
+                    last = cursor;
+                }
+                break;
+            case 2:
+                if (last < 0) {
+                    errno = 0;
+                    CHECK(it.remove(&it) == NULL);
+                    CHECK(errno == EINVAL);
+                } else {
+                    CHECK(it.remove(&it) == ref[last]);
+                    refremove(last);
+                    if (last < cursor) {
+                        cursor--;
+                    }
+                    last = -1;
+                }
+                break;
+            default:
+                if (nref < MAXSIZE - 8) {
+                    CHECK(it.insert(&it, (void *)fresh) == (void *)fresh);
+                    refinsert(cursor++, (void *)fresh++);
+                    last = -1;
+                }
+                break;
+        }
+    }
+    checklist(list);
+}
+
+static void indexed(LinkedList list, unsigned long *state) {
+    long fresh = -10;
+    int step = 0, i = 0;
+    
+    CHECK(LLsetindexed(list, 1) == 0);
+    checkindexed(list);
+    for (step = 0; step < STEPS/4; step++) {
+        i = (nref > 0)?(int)(nextrand(state) % nref):0;
+        switch (nextrand(state) % 8) {
+            case 0:
+            case 1:
+                if (nref > 0) {
+                    CHECK(LLget(list, i) == ref[i]);
+                }
+                break;
+            case 2:
+                if ((nref > 0) && (nref < MAXSIZE - 8)) {
+                    CHECK(LLset(list, i, (void *)fresh) == (void *)fresh);
+                    refinsert(i, (void *)fresh--);
+                }
+                break;
+            case 3:
+                if (nref < MAXSIZE - 8) {
+                    CHECK(LLadd(list, (void *)fresh) == (void *)fresh);
+                    refinsert(nref, (void *)fresh--);
+                }
+                break;
+            case 4:
+                if (nref > 0) {
+                    CHECK(LLremove(list, i) == ref[i]);
+                    refremove(i);
+                }
+                break;
+            case 5:
+                if (nref > 0) {
+                    CHECK(LLremove(list, 0) == ref[0]);
+                    refremove(0);
+                }
+                break;
+            case 6:
+                if (nref > 0) {
+                    CHECK(LLremove(list, nref - 1) == ref[nref - 1]);
+                    refremove(nref - 1);
+                }
+                break;
+            default:
+                if (step % 1000 == 7) {
+                    CHECK(LLsetindexed(list, 0) == 0);
+                    checkindexed(list);
+                    CHECK(LLsetindexed(list, 1) == 0);
+                }
+                break;
+        }
+        if (step % 4096 == 0) {
+            checkindexed(list);
+        }
+    }
+    checkindexed(list);
+    walk(list, state);
+    checkindexed(list);
+    while (nref > 0) {
+        CHECK(LLremove(list, 0) == ref[0]);
+        refremove(0);
+        if (nref % 64 == 0) {
+            checkindexed(list);
+        }
+    }
+    for (i = 0; i < 64; i++) {
+        CHECK(LLadd(list, (void *)fresh) == (void *)fresh);
+        refinsert(nref, (void *)fresh--);
+    }
+    checkindexed(list);
+}
+
+
+int main(void) {
+    unsigned long state = 0x9E3779B97F4A7C15UL;
+    LinkedList list = LLnew();
+    iterator it;
+    
+    CHECK(list >= 0);
+    walk(list, &state);
+    
+    it = LLiterator(list);
+    CHECK(it.next(&it) == ref[0]);
+    LLadd(list, (void *)-1L);
+    refinsert(nref, (void *)-1L);
+    errno = 0;
+    CHECK(it.next(&it) == NULL);
+    CHECK(errno == EFAULT);
+    CHECK(!it.hasnext && !it.hasprev);
+    errno = 0;
+    CHECK(it.prev(&it) == NULL);
+    errno = 0;
+    CHECK(it.remove(&it) == NULL);
+    CHECK(errno == EFAULT);
+    errno = 0;
+    it.insert(&it, (void *)-2L);
+    CHECK(errno == EFAULT);
+    checklist(list);
+    
+    it.reset(&it);
+    CHECK(it.hasnext);
+    CHECK(it.next(&it) == ref[0]);
+    LLremove(list, 0);
+    refremove(0);
+    errno = 0;
+    it.update(&it);
+    CHECK(errno == EFAULT);
+    CHECK(it.remove(&it) == NULL);
+    checklist(list);
+    
+    indexed(list, &state);
+    LLdispose(list);
+    printf("ok\n");
+    return 0;
+}
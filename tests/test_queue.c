@@ -0,0 +1,135 @@
+/**
+ *  @file   test_queue.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks that every element pushed on a Queue is popped exactly once
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  PRODUCERS threads push PER known values each onto a small queue, half
+ *  through QUpush and half retrying QUtrypush, while as many consumers
+ *  pop a fixed share each, half through QUpop and half retrying
+ *  QUtrypop. Every value must come out exactly once, and each consumer
+ *  must see the values of any one producer in the order they went in.
+ */
+#include "harness.h"
+#include <errno.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "queue.h"
+
+#define PRODUCERS 4
+#define CONSUMERS 4
+#define PER 50000
+#define TOTAL (PRODUCERS*PER)
+#define CAPACITY 64
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static Queue queue = -1;
+static char seen[CONSUMERS][TOTAL + 1];
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *producer(void *arg) {
+    long id = (long)arg;
+    long v = 0;
+    
+    for (v = id*PER + 1; v <= (id + 1)*PER; v++) {
+        if (id % 2) {
+            CHECK(QUpush(queue, (void *)v) == 0);
+        } else {
+            while (QUtrypush(queue, (void *)v) != 0) {
+                CHECK(errno == EAGAIN);
+                sched_yield();
+            }
+        }
+    }
+    return NULL;
+}
+
+static void *consumer(void *arg) {
+    long id = (long)arg;
+    long last[PRODUCERS];
+    long v = 0, p = 0;
+    int k = 0;
+    
+    memset(last, 0, sizeof(last));
+    for (k = 0; k < TOTAL/CONSUMERS; k++) {
+        if (id % 2) {
+            v = (long)QUpop(queue);
+        } else {
+            while ((v = (long)QUtrypop(queue)) == 0) {
+                sched_yield();
+            }
+        }
+        CHECK((v >= 1) && (v <= TOTAL));
+        CHECK(!seen[id][v]);
+        seen[id][v] = 1;
+        p = (v - 1)/PER;
+        CHECK(v > last[p]);
+        last[p] = v;
+    }
+    return NULL;
+}
+
+
+int main(void) {
+    pthread_t threads[PRODUCERS + CONSUMERS];
+    long i = 0, v = 0;
+    int taken = 0, c = 0;
+    
+    CHECK(QUnew(0) == -1);
+    CHECK((queue = QUnew(CAPACITY)) >= 0);
+    CHECK(QUcapacity(queue) == CAPACITY);
+    CHECK(QUtrypop(queue) == NULL);
+    CHECK(QUpush(queue, NULL) == -1);
+    
+    for (i = 0; i < CONSUMERS; i++) {
+        CHECK(pthread_create(&threads[PRODUCERS + i], NULL, consumer, (void *)i) == 0);
+    }
+    for (i = 0; i < PRODUCERS; i++) {
+        CHECK(pthread_create(&threads[i], NULL, producer, (void *)i) == 0);
+    }
+    for (i = 0; i < PRODUCERS + CONSUMERS; i++) {
+        CHECK(pthread_join(threads[i], NULL) == 0);
+    }
+    
+    for (v = 1; v <= TOTAL; v++) {
+        for (c = 0, taken = 0; c < CONSUMERS; c++) {
+            taken += seen[c][v];
+        }
+        CHECK(taken == 1);
+    }
+    CHECK(QUsize(queue) == 0);
+    CHECK(QUtrypop(queue) == NULL);
+    QUdispose(queue);
+    printf("ok\n");
+    return 0;
+}
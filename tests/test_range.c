@@ -0,0 +1,200 @@
+/**
+ *  @file   test_range.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of ArrayList range inserts and removals in every layout
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Inserts and removes ranges at the front, in the middle and at the end
+ *  of plain and record lists, flat, segmented, and built from the front
+ *  so they start with a gap, against a plain array. Ranges are sized to
+ *  fit in the front gap, to overrun it and to span several blocks.
+ */
+#include "harness.h"
+#include <string.h>
+#include "arraylist.h"
+
+#define START 100
+#define MAXSIZE 4096
+#define BLOCK 16
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Record {
+    long value;
+    long twice;
+};
+
+struct _Layout {
+    const char *name;
+    ArrayList (*create)(void);
+    char record;
+    char fromfront;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static long ref[MAXSIZE];
+static int nref = 0;
+static long fresh = 1;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static ArrayList newplain(void) {
+    return ALnew(0);
+}
+
+static ArrayList newrecords(void) {
+    return ALnewsized(0, sizeof(struct _Record));
+}
+
+static ArrayList newsegmented(void) {
+    return ALnewsegmented(BLOCK, 0);
+}
+
+static ArrayList newsegmentedrecords(void) {
+    return ALnewsegmented(BLOCK, sizeof(struct _Record));
+}
+
+static void checklist(const struct _Layout *l, ArrayList list) {
+    struct _Record *r = NULL;
+    int i = 0;
+    
+    CHECK(ALsize(list) == nref);
+    for (i = 0; i < nref; i++) {
+        if (l->record) {
+            r = ALget(list, i);
+            CHECK((r->value == ref[i]) && (r->twice == 2*ref[i]));
+        } else {
+            CHECK(ALget(list, i) == (void *)ref[i]);
+        }
+    }
+}
+
+static void insertrange(const struct _Layout *l, ArrayList list, int at, int n) {
+    static struct _Record records[MAXSIZE];
+    static void *pointers[MAXSIZE];
+    int k = 0;
+    
+    for (k = 0; k < n; k++) {
+        records[k].value = fresh;
+        records[k].twice = 2*fresh;
+        pointers[k] = (void *)fresh++;
+    }
+    CHECK(ALinsertrange(list, at, l->record?(void **)records:pointers, n) == n);
+    memmove(&ref[at + n], &ref[at], sizeof(long)*(nref - at));
+    for (k = 0; k < n; k++) {
+        ref[at + k] = fresh - n + k;
+    }
+    nref += n;
+    checklist(l, list);
+}
+
+static void removerange(const struct _Layout *l, ArrayList list, int from, int to) {
+    CHECK(ALremoverange(list, from, to) == to - from);
+    memmove(&ref[from], &ref[to], sizeof(long)*(nref - to));
+    nref -= to - from;
+    checklist(l, list);
+}
+
+static void run(const struct _Layout *l) {
+    static const int sizes[] = { 1, 7, 40, 3*BLOCK + 5 };
+    struct _Record r;
+    ArrayList list = l->create();
+    int k = 0, n = 0;
+    
+    CHECK(list >= 0);
+    nref = 0;
+    for (k = 0; k < START; k++) {
+        r.value = fresh;
+        r.twice = 2*fresh;
+        if (l->fromfront) {
+            ALpushfront(list, l->record?(void *)&r:(void *)fresh);
+            memmove(&ref[1], &ref[0], sizeof(long)*nref);
+            ref[0] = fresh++;
+        } else {
+            ALadd(list, l->record?(void *)&r:(void *)fresh);
+            ref[nref] = fresh++;
+        }
+        nref++;
+    }
+    checklist(l, list);
+    
+    for (k = 0; k < (int)(sizeof(sizes)/sizeof(sizes[0])); k++) {
+        n = sizes[k];
+        insertrange(l, list, 0, n);
+        insertrange(l, list, nref/2, n);
+        insertrange(l, list, nref, n);
+        insertrange(l, list, 1, n);
+        insertrange(l, list, nref - 1, n);
+        removerange(l, list, 0, n);
+        removerange(l, list, nref/2 - n/2, nref/2 - n/2 + n);
+        removerange(l, list, nref - n, nref);
+        removerange(l, list, 1, 1 + n);
+        removerange(l, list, nref - 1 - n, nref - 1);
+        removerange(l, list, nref/2, nref/2);
+        insertrange(l, list, nref/2, 0);
+    }
+    CHECK(nref == START);
+    
+    CHECK(ALinsertrange(list, nref + 1, NULL, 1) == -1);
+    CHECK(ALinsertrange(list, 0, NULL, -1) == -1);
+    CHECK(ALremoverange(list, 0, nref + 1) == -1);
+    CHECK(ALremoverange(list, 2, 1) == -1);
+    CHECK(ALremoverange(list, -1, 1) == -1);
+    checklist(l, list);
+    
+    removerange(l, list, 0, nref);
+    insertrange(l, list, 0, 3*BLOCK + 5);
+    insertrange(l, list, 0, 1);
+    ALdispose(list);
+}
+
+
+int main(void) {
+    static const struct _Layout layouts[] = {
+        { "plain", newplain, 0, 0 },
+        { "records", newrecords, 1, 0 },
+        { "plain from front", newplain, 0, 1 },
+        { "records from front", newrecords, 1, 1 },
+        { "segmented", newsegmented, 0, 0 },
+        { "segmented records", newsegmentedrecords, 1, 0 },
+        { "segmented from front", newsegmented, 0, 1 }
+    };
+    int k = 0;
+    
+    CHECK(freopen("/dev/null", "w", stderr) != NULL);
+    for (k = 0; k < (int)(sizeof(layouts)/sizeof(layouts[0])); k++) {
+        run(&layouts[k]);
+    }
+    printf("ok\n");
+    return 0;
+}
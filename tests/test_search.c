@@ -0,0 +1,255 @@
+/**
+ *  @file   test_search.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of the ArrayList searches against a plain loop
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  ALindexof, ALlastindexof, ALcontains, ALcount, ALindexofkey and
+ *  ALcountkey are compared with a loop over ALget on plain and record
+ *  lists, filled from the back or from the front, and segmented ones.
+ *  Lengths run past several vector widths and blocks, keys repeat, and
+ *  every position of a list of distinct elements is looked up in turn,
+ *  so matches land in vector lanes, scalar tails and on both sides of
+ *  block boundaries. make check runs it again built with
+ *  MOUSTASHED_NOAVX2 and MOUSTASHED_NOSIMD to cover every scanner.
+ */
+#include "harness.h"
+#include <errno.h>
+#include <string.h>
+#include <stddef.h>
+#include "arraylist.h"
+
+#define BLOCK 16
+#define LAYOUTS 7
+#define DISTINCT 70
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Record {
+    long id;
+    int group;
+    short tag;
+    char code[3];
+    char flag;
+};
+
+struct _Key {
+    size_t offset;
+    size_t width;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static const int sizes[] = { 0, 1, 2, 3, 4, 5, 7, 8, 9, 15, 16, 17, 31, 32, 33, 63, 64, 65, 100, 257 };
+static const struct _Key keys[] = {
+    { offsetof(struct _Record, id), sizeof(long) },
+    { offsetof(struct _Record, group), sizeof(int) },
+    { offsetof(struct _Record, tag), sizeof(short) },
+    { offsetof(struct _Record, code), 3 },
+    { offsetof(struct _Record, flag), 1 },
+    { offsetof(struct _Record, group), sizeof(int) + sizeof(short) }
+};
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static int isrecord(int layout) {
+    return (layout == 1) || (layout == 3) || (layout == 6);
+}
+
+static void record(long v, struct _Record *r) {
+    memset(r, 0, sizeof(*r));
+    r->id = v;
+    r->group = (int)(v % 3);
+    r->tag = (short)(v % 5);
+    r->code[0] = 'a' + (char)(v % 2);
+    r->code[2] = 'z';
+    r->flag = (char)(v % 4);
+}
+
+/*
+ * Layouts: plain, records, plain and records pushed from the front,
+ * segmented plain, segmented plain pushed from the front and segmented
+ * records. values[i] ends up at index i.
+ */
+static ArrayList build(int layout, const long *values, int n) {
+    ArrayList list = -1;
+    struct _Record r;
+    int i = 0;
+    
+    switch (layout) {
+        case 0: case 2: list = ALnew(0); break;
+        case 1: case 3: list = ALnewsized(0, sizeof(struct _Record)); break;
+        case 4: case 5: list = ALnewsegmented(BLOCK, 0); break;
+        default: list = ALnewsegmented(BLOCK, sizeof(struct _Record)); break;
+    }
+    CHECK(list >= 0);
+    for (i = 0; i < n; i++) {
+        if ((layout == 2) || (layout == 3) || (layout == 5)) {
+            record(values[n - 1 - i], &r);
+            CHECK(ALpushfront(list, isrecord(layout)?(void *)&r:(void *)values[n - 1 - i]) != NULL);
+        } else {
+            record(values[i], &r);
+            CHECK(ALadd(list, isrecord(layout)?(void *)&r:(void *)values[i]) != NULL);
+        }
+    }
+    CHECK(ALsize(list) == n);
+    return list;
+}
+
+static int same(ArrayList list, int layout, int i, void *elem, const struct _Key *k) {
+    char *x = ALget(list, i);
+    
+    if (!isrecord(layout)) {
+        return x == elem;
+    }
+    if (k == NULL) {
+        return memcmp(x, elem, sizeof(struct _Record)) == 0;
+    }
+    return memcmp(x + k->offset, (char *)elem + k->offset, k->width) == 0;
+}
+
+/*
+ * Every search for elem, or for the key k of it, against a loop.
+ */
+static void lookup(ArrayList list, int layout, void *elem, const struct _Key *k) {
+    int n = ALsize(list);
+    int first = -1, last = -1, count = 0, i = 0;
+    
+    for (i = 0; i < n; i++) {
+        if (same(list, layout, i, elem, k)) {
+            first = (first < 0)?i:first;
+            last = i;
+            count++;
+        }
+    }
+    if (k == NULL) {
+        CHECK(ALindexof(list, elem) == first);
+        CHECK(ALlastindexof(list, elem) == last);
+        CHECK(ALcontains(list, elem) == (count > 0));
+        CHECK(ALcount(list, elem) == count);
+    } else {
+        CHECK(ALindexofkey(list, (char *)elem + k->offset, k->offset, k->width) == first);
+        CHECK(ALcountkey(list, (char *)elem + k->offset, k->offset, k->width) == count);
+    }
+}
+
+static void lookups(ArrayList list, int layout, long v) {
+    struct _Record r;
+    size_t k = 0;
+    
+    if (!isrecord(layout)) {
+        lookup(list, layout, (void *)v, NULL);
+        return;
+    }
+    record(v, &r);
+    lookup(list, layout, &r, NULL);
+    for (k = 0; k < sizeof(keys)/sizeof(keys[0]); k++) {
+        lookup(list, layout, &r, &keys[k]);
+    }
+}
+
+/*
+ * Few values, so every one repeats and the counts and last matches
+ * differ from the first ones.
+ */
+static void repeats(int layout) {
+    long values[257];
+    size_t s = 0;
+    long v = 0;
+    int n = 0, i = 0;
+    ArrayList list = -1;
+    
+    for (s = 0; s < sizeof(sizes)/sizeof(sizes[0]); s++) {
+        n = sizes[s];
+        for (i = 0; i < n; i++) {
+            values[i] = (long)((i*7 + n) % 5) + 1;
+        }
+        list = build(layout, values, n);
+        for (v = 0; v <= 6; v++) {
+            lookups(list, layout, v);
+        }
+        ALdispose(list);
+    }
+}
+
+/*
+ * Distinct values, each looked up where it is, plus one a single time
+ * at the end, which only the tail of the last run holds.
+ */
+static void positions(int layout) {
+    long values[DISTINCT];
+    ArrayList list = -1;
+    int n = 0, i = 0;
+    
+    for (n = 1; n <= DISTINCT; n += (n < 20)?1:7) {
+        for (i = 0; i < n; i++) {
+            values[i] = 1000 + i;
+        }
+        values[n - 1] = 7;
+        list = build(layout, values, n);
+        for (i = 0; i < n; i++) {
+            lookups(list, layout, values[i]);
+        }
+        lookups(list, layout, 999);
+        ALdispose(list);
+    }
+}
+
+static void invalid(void) {
+    ArrayList plain = ALnew(0);
+    ArrayList records = ALnewsized(0, sizeof(struct _Record));
+    long key = 1;
+    
+    CHECK(ALindexofkey(plain, &key, 0, sizeof(key)) == -1);
+    CHECK(errno == EINVAL);
+    errno = 0;
+    CHECK(ALcountkey(records, &key, sizeof(struct _Record) - 2, 4) == -1);
+    CHECK(errno == EINVAL);
+    errno = 0;
+    CHECK(ALindexofkey(records, &key, 0, 0) == -1);
+    CHECK(errno == EINVAL);
+    ALdispose(plain);
+    ALdispose(records);
+}
+
+
+int main(void) {
+    int layout = 0;
+    
+    for (layout = 0; layout < LAYOUTS; layout++) {
+        repeats(layout);
+        positions(layout);
+    }
+    invalid();
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,231 @@
+/**
+ *  @file   test_snapshot.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Round trips and truncated files through ALsave, ALload and LLload
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Record lists are saved raw and read back with ALload and ALloadmapped,
+ *  lists of heap strings go through a serializer into both list kinds,
+ *  and every file is then cut short to check that loading fails and
+ *  hands each element it already produced to the release callback.
+ */
+#include "harness.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include "arraylist.h"
+#include "linkedlist.h"
+
+#define COUNT 1000
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Record {
+    long value;
+    char tag[8];
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static char path[] = "/tmp/test_snapshotXXXXXX";
+static int live = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static char *text(long v) {
+    char *s = malloc(32);
+    
+    CHECK(s != NULL);
+    snprintf(s, 32, "elem-%ld", v);
+    live++;
+    return s;
+}
+
+static int save(void *elem, FILE *f, void *ctx) {
+    size_t len = strlen(elem);
+    
+    (void)ctx;
+    return ((fwrite(&len, sizeof(len), 1, f) == 1)
+            && (fwrite(elem, 1, len, f) == len))?0:-1;
+}
+
+static int load(FILE *f, void **elem, void *ctx) {
+    size_t len = 0;
+    char *s = NULL;
+    
+    (void)ctx;
+    if ((fread(&len, sizeof(len), 1, f) != 1) || (len > 64)
+        || ((s = malloc(len + 1)) == NULL)) {
+        return -1;
+    }
+    if (fread(s, 1, len, f) != len) {
+        free(s);
+        return -1;
+    }
+    s[len] = '\0';
+    live++;
+    *elem = s;
+    return 0;
+}
+
+static void release(void *elem, void *ctx) {
+    (void)ctx;
+    free(elem);
+    live--;
+}
+
+static void cut(long size) {
+    CHECK(truncate(path, size) == 0);
+}
+
+static long filesize(void) {
+    FILE *f = fopen(path, "rb");
+    long size = 0;
+    
+    CHECK(f != NULL);
+    CHECK(fseek(f, 0, SEEK_END) == 0);
+    size = ftell(f);
+    fclose(f);
+    return size;
+}
+
+static void checkrecords(ArrayList list) {
+    struct _Record *r = NULL;
+    long i = 0;
+    
+    CHECK(ALsize(list) == COUNT);
+    for (i = 0; i < COUNT; i++) {
+        r = ALget(list, (int)i);
+        CHECK(r->value == i*i);
+        CHECK(strcmp(r->tag, "rec") == 0);
+    }
+}
+
+static void records(void) {
+    ArrayList list = ALnewsized(0, sizeof(struct _Record));
+    ArrayList back = -1;
+    struct _Record r;
+    long i = 0;
+    
+    memset(&r, 0, sizeof(r));
+    strcpy(r.tag, "rec");
+    for (i = 0; i < COUNT; i++) {
+        r.value = i*i;
+        CHECK(ALadd(list, &r) != NULL);
+    }
+    CHECK(ALsave(list, path, NULL, NULL) == 0);
+    ALdispose(list);
+    
+    back = ALload(path, NULL, NULL, NULL);
+    checkrecords(back);
+    ALdispose(back);
+    
+    back = ALloadmapped(path);
+    checkrecords(back);
+    r.value = -1;
+    CHECK(ALadd(back, &r) != NULL);
+    CHECK(((struct _Record *)ALget(back, 0))->value == 0);
+    ALdispose(back);
+    back = ALloadmapped(path);
+    CHECK(ALsize(back) == COUNT);
+    ALdispose(back);
+    
+    cut(filesize() - (long)sizeof(struct _Record)/2);
+    CHECK(ALload(path, NULL, NULL, NULL) == -1);
+    CHECK(errno == EINVAL);
+    CHECK(ALloadmapped(path) == -1);
+    cut(4);
+    CHECK(ALload(path, NULL, NULL, NULL) == -1);
+    CHECK(ALloadmapped(path) == -1);
+}
+
+static void serialized(void) {
+    ArrayList list = ALnew(0);
+    ArrayList back = -1;
+    LinkedList linked = -1;
+    char expect[32];
+    long i = 0;
+    
+    for (i = 0; i < COUNT; i++) {
+        CHECK(ALadd(list, text(i)) != NULL);
+    }
+    CHECK(ALsave(list, path, NULL, NULL) == -1);
+    CHECK(ALsave(list, path, save, NULL) == 0);
+    CHECK(ALloadmapped(path) == -1);
+    CHECK(ALload(path, NULL, NULL, NULL) == -1);
+    
+    back = ALload(path, load, release, NULL);
+    linked = LLload(path, load, release, NULL);
+    CHECK(ALsize(back) == COUNT);
+    CHECK(LLsize(linked) == COUNT);
+    for (i = 0; i < COUNT; i++) {
+        snprintf(expect, sizeof(expect), "elem-%ld", i);
+        CHECK(strcmp(ALget(back, (int)i), expect) == 0);
+        CHECK(strcmp(LLget(linked, (int)i), expect) == 0);
+    }
+    CHECK(live == 3*COUNT);
+    CHECK(LLsave(linked, path, save, NULL) == 0);
+    ALforeach(back, release, NULL);
+    ALdispose(back);
+    while (LLsize(linked) > 0) {
+        release(LLremove(linked, 0), NULL);
+    }
+    LLdispose(linked);
+    
+    back = ALload(path, load, release, NULL);
+    CHECK(ALsize(back) == COUNT);
+    ALforeach(back, release, NULL);
+    ALdispose(back);
+    
+    cut(filesize() - 3);
+    CHECK(ALload(path, load, release, NULL) == -1);
+    CHECK(LLload(path, load, release, NULL) == -1);
+    CHECK(live == COUNT);
+    ALforeach(list, release, NULL);
+    ALdispose(list);
+    CHECK(live == 0);
+}
+
+
+int main(void) {
+    int fd = mkstemp(path);
+    
+    CHECK(fd >= 0);
+    close(fd);
+    freopen("/dev/null", "w", stderr);
+    records();
+    serialized();
+    unlink(path);
+    printf("ok\n");
+    return 0;
+}
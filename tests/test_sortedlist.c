@@ -0,0 +1,211 @@
+/**
+ *  @file   test_sortedlist.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of SortedList against a sorted reference array
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Random inserts and removes, by key and by position, run against a
+ *  plain array kept sorted the same way, with few enough distinct keys
+ *  that runs of equal elements straddle leaves. After every step the
+ *  tree passes SLverify, which also checks that keys[i] is the first
+ *  element under children[i + 1], and SLget, SLindexof, SLfind and both
+ *  bounds agree with the array. The list grows to thousands of elements
+ *  and drains again, so nodes split, borrow and merge on the way.
+ */
+#include "harness.h"
+#include <string.h>
+#include "sortedlist.h"
+
+#define STEPS 60000
+#define MAXSIZE 4000
+#define KEYRANGE 40
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Elem {
+    int key;
+    int id;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static struct _Elem pool[STEPS];
+static struct _Elem *ref[MAXSIZE];
+static int nref = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static int cmp(const void *x, const void *y) {
+    const struct _Elem *a = x, *b = y;
+    
+    return (a->key > b->key) - (a->key < b->key);
+}
+
+static int refbound(int key, int upper) {
+    int i = 0;
+    
+    while ((i < nref) && ((ref[i]->key < key) || (upper && (ref[i]->key == key)))) {
+        i++;
+    }
+    return i;
+}
+
+static void refinsert(int i, struct _Elem *e) {
+    memmove(&ref[i + 1], &ref[i], sizeof(ref[0])*(nref - i));
+    ref[i] = e;
+    nref++;
+}
+
+static void refremove(int i) {
+    memmove(&ref[i], &ref[i + 1], sizeof(ref[0])*(nref - i - 1));
+    nref--;
+}
+
+static void probe(SortedList list, int key) {
+    struct _Elem k;
+    int lo = refbound(key, 0);
+    int hi = refbound(key, 1);
+    
+    k.key = key;
+    k.id = -1;
+    CHECK(SLlowerbound(list, &k) == lo);
+    CHECK(SLupperbound(list, &k) == hi);
+    CHECK(SLindexof(list, &k) == ((lo < hi)?lo:-1));
+    CHECK(SLfind(list, &k) == ((lo < hi)?(void *)ref[lo]:NULL));
+    if (lo < hi) {
+        CHECK(SLget(list, lo) == ref[lo]);
+        CHECK(SLget(list, hi - 1) == ref[hi - 1]);
+    }
+}
+
+static void checklist(SortedList list) {
+    iterator it = SLiterator(list);
+    int i = 0;
+    
+    CHECK(SLverify(list) == 0);
+    CHECK(SLsize(list) == nref);
+    for (i = 0; i < nref; i++) {
+        CHECK(SLget(list, i) == ref[i]);
+        CHECK(it.next(&it) == ref[i]);
+    }
+    CHECK(!it.hasnext);
+    CHECK(SLget(list, nref) == NULL);
+}
+
+/*
+ * Mostly inserts while filling, mostly removes while draining.
+ */
+static void walk(SortedList list, unsigned long *state, int filling) {
+    struct _Elem k;
+    struct _Elem *e = NULL;
+    static int fresh = 0;
+    int step = 0, i = 0, key = 0;
+    
+    for (step = 0; step < STEPS/2; step++) {
+        key = (int)(nextrand(state) % KEYRANGE);
+        k.key = key;
+        k.id = -1;
+        switch (nextrand(state) % 8) {
+            case 0:
+                if (nref > 0) {
+                    i = (int)(nextrand(state) % nref);
+                    CHECK(SLremoveat(list, i) == ref[i]);
+                    refremove(i);
+                }
+                break;
+            case 1:
+            case 2:
+                i = refbound(key, 0);
+                if ((i < nref) && (ref[i]->key == key)) {
+                    CHECK(SLremove(list, &k) == ref[i]);
+                    refremove(i);
+                } else {
+                    CHECK(SLremove(list, &k) == NULL);
+                }
+                break;
+            case 3:
+                if (!filling) {
+                    i = refbound(key, 0);
+                    if ((i < nref) && (ref[i]->key == key)) {
+                        CHECK(SLremove(list, &k) == ref[i]);
+                        refremove(i);
+                    }
+                    break;
+                }
+                /* fall through */
+            default:
+                if ((filling || (step % 3 == 0)) && (nref < MAXSIZE)) {
+                    e = &pool[fresh];
+                    e->key = key;
+                    e->id = fresh++;
+                    CHECK(SLinsert(list, e) == e);
+                    refinsert(refbound(key, 1), e);
+                }
+                break;
+        }
+        CHECK(SLverify(list) == 0);
+        CHECK(SLsize(list) == nref);
+        if (nref > 0) {
+            i = (int)(nextrand(state) % nref);
+            CHECK(SLget(list, i) == ref[i]);
+        }
+        probe(list, key);
+        probe(list, (int)(nextrand(state) % (KEYRANGE + 2)) - 1);
+        if (step % 5000 == 0) {
+            checklist(list);
+        }
+    }
+    checklist(list);
+}
+
+
+int main(void) {
+    unsigned long state = 0x9E3779B97F4A7C15UL;
+    SortedList list = SLnew(cmp);
+    int i = 0;
+    
+    CHECK(list >= 0);
+    checklist(list);
+    walk(list, &state, 1);
+    CHECK(nref > MAXSIZE/2);
+    walk(list, &state, 0);
+    while (nref > 0) {
+        i = (nref > 1)?nref/2:0;
+        CHECK(SLremoveat(list, i) == ref[i]);
+        refremove(i);
+        CHECK(SLverify(list) == 0);
+    }
+    checklist(list);
+    SLdispose(list);
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,171 @@
+/**
+ *  @file   test_stats.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of the ArrayList and LinkedList counters
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Built with MOUSTASHED_STATS, a known sequence of adds, inserts,
+ *  removes and iterator steps must leave reallocs, bytes, peak,
+ *  shifted, walked and steps at the values worked out by hand below.
+ *  Built without it, ALstats and LLstats must fail with ENOTSUP. make
+ *  check runs it both ways.
+ */
+#include "harness.h"
+#include <errno.h>
+#include "arraylist.h"
+#include "linkedlist.h"
+
+#define NODE (4*sizeof(void *))
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void expect(stats *st, unsigned long reallocs, size_t bytes, size_t peak,
+                   unsigned long shifted, unsigned long walked, unsigned long steps) {
+    CHECK(st->reallocs == reallocs);
+    CHECK(st->bytes == bytes);
+    CHECK(st->peak == peak);
+    CHECK(st->shifted == shifted);
+    CHECK(st->walked == walked);
+    CHECK(st->steps == steps);
+}
+
+#if defined(MOUSTASHED_STATS)
+/*
+ * Four slots growing four at a time, so the 5th and 9th adds reallocate.
+ */
+static void arrays(void) {
+    ArrayList list = ALnew(4);
+    size_t slot = sizeof(void *);
+    void *out[4];
+    iterator it;
+    stats st;
+    long v = 0;
+    
+    CHECK(ALgrowbyamount(list, 4) == 0);
+    CHECK(ALstats(list, &st) == 0);
+    expect(&st, 0, 4*slot, 4*slot, 0, 0, 0);
+    for (v = 1; v <= 10; v++) {
+        CHECK(ALadd(list, (void *)v) != NULL);
+    }
+    CHECK(ALstats(list, &st) == 0);
+    expect(&st, 2, 12*slot, 12*slot, 0, 0, 0);
+    /* The two elements after 8, then the ten after 1, move up. */
+    CHECK(ALset(list, 8, (void *)11L) != NULL);
+    CHECK(ALset(list, 1, (void *)12L) != NULL);
+    CHECK(ALstats(list, &st) == 0);
+    expect(&st, 2, 12*slot, 12*slot, 12, 0, 0);
+    /* Removing the first opens a front gap, the next moves one element, the last none. */
+    CHECK(ALremove(list, 0) == (void *)1L);
+    CHECK(ALremove(list, 1) == (void *)2L);
+    CHECK(ALremove(list, 9) == (void *)10L);
+    CHECK(ALpushfront(list, (void *)13L) != NULL);
+    CHECK(ALstats(list, &st) == 0);
+    expect(&st, 2, 12*slot, 12*slot, 13, 0, 0);
+    it = ALiterator(list);
+    it.next(&it);
+    it.next(&it);
+    it.next(&it);
+    CHECK(ALnextbatch(&it, out, 4) == 4);
+    CHECK(ALshrinktofit(list) == 10);
+    CHECK(ALstats(list, &st) == 0);
+    expect(&st, 3, 10*slot, 12*slot, 13, 0, 7);
+    ALdispose(list);
+}
+
+/*
+ * 512 byte slabs hold 14 nodes after their header, the next slab is
+ * twice as large. Nodes are reached from the closer end.
+ */
+static void linked(void) {
+    LinkedList list = LLnew();
+    void *out[6];
+    iterator it;
+    stats st;
+    long v = 0;
+    int k = 0;
+    
+    CHECK(LLstats(list, &st) == 0);
+    expect(&st, 0, 0, 0, 0, 0, 0);
+    for (v = 1; v <= 20; v++) {
+        CHECK(LLadd(list, (void *)v) != NULL);
+    }
+    CHECK((512 - 64)/NODE == 14);
+    CHECK(LLstats(list, &st) == 0);
+    expect(&st, 0, 1536, 1536, 0, 0, 0);
+    CHECK(LLget(list, 3) == (void *)4L);
+    CHECK(LLget(list, 15) == (void *)16L);
+    CHECK(LLremove(list, 10) == (void *)11L);
+    CHECK(LLset(list, 2, (void *)21L) != NULL);
+    CHECK(LLstats(list, &st) == 0);
+    expect(&st, 0, 1536, 1536, 0, 3 + 4 + 9 + 2, 0);
+    it = LLiterator(list);
+    for (k = 0; k < 5; k++) {
+        it.next(&it);
+    }
+    CHECK(LLnextbatch(&it, out, 6) == 6);
+    CHECK(LLstats(list, &st) == 0);
+    expect(&st, 0, 1536, 1536, 0, 18 + 11, 11);
+    LLpurge(list);
+    CHECK(LLstats(list, &st) == 0);
+    expect(&st, 0, 0, 1536, 0, 29, 11);
+    LLdispose(list);
+}
+#else
+static void unsupported(void) {
+    ArrayList list = ALnew(0);
+    LinkedList linked = LLnew();
+    stats st;
+    
+    CHECK(ALadd(list, (void *)1L) != NULL);
+    CHECK(LLadd(linked, (void *)1L) != NULL);
+    st.reallocs = 1;
+    errno = 0;
+    CHECK(ALstats(list, &st) == -1);
+    CHECK(errno == ENOTSUP);
+    expect(&st, 0, 0, 0, 0, 0, 0);
+    st.steps = 1;
+    errno = 0;
+    CHECK(LLstats(linked, &st) == -1);
+    CHECK(errno == ENOTSUP);
+    expect(&st, 0, 0, 0, 0, 0, 0);
+    ALdispose(list);
+    LLdispose(linked);
+}
+#endif
+
+
+int main(void) {
+#if defined(MOUSTASHED_STATS)
+    arrays();
+    linked();
+#else
+    unsupported();
+#endif
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,266 @@
+/**
+ *  @file   test_traverse.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks of ALmap, the pops and traversals that cross locked lists
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  ALmap is checked element by element on plain, record and segmented
+ *  lists, short and long enough to be split over the pool, and
+ *  ALpopfront and ALpopback against an array under random pushes at
+ *  both ends. Then one thread traverses or sorts a plain list while
+ *  another traverses a second list whose callbacks read the first:
+ *  the thread holding the first list must never run those callbacks
+ *  while it waits for its own chunks, or it deadlocks on its own lock.
+ *  An alarm turns a deadlock into a failure.
+ */
+#include "harness.h"
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include "arraylist.h"
+#include "threadpool.h"
+
+#define SHORT 100
+#define LONG 50000
+#define POPS 20000
+#define ROUNDS 20
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Record {
+    long value;
+    long twice;
+};
+
+struct _Crossing {
+    ArrayList locked;
+    ArrayList other;
+    long visits;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static long ref[2*POPS + 1];
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *triple(void *elem, void *ctx) {
+    (void)ctx;
+    return (void *)(3*(long)elem);
+}
+
+static void *tripled(void *elem, void *ctx) {
+    struct _Record *r = elem;
+    
+    CHECK(r->twice == 2*r->value);
+    return triple((void *)r->value, ctx);
+}
+
+/*
+ * Plain, record and segmented lists of n elements, mapped and compared.
+ */
+static void maps(int n) {
+    ArrayList lists[3];
+    ArrayList mapped = -1;
+    struct _Record r;
+    long v = 0;
+    int k = 0, i = 0;
+    
+    lists[0] = ALnew(0);
+    lists[1] = ALnewsized(0, sizeof(struct _Record));
+    lists[2] = ALnewsegmented(64, 0);
+    for (v = 1; v <= n; v++) {
+        r.value = v;
+        r.twice = 2*v;
+        CHECK(ALadd(lists[0], (void *)v) != NULL);
+        CHECK(ALadd(lists[1], &r) != NULL);
+        CHECK(ALadd(lists[2], (void *)v) != NULL);
+    }
+    for (k = 0; k < 3; k++) {
+        mapped = ALmap(lists[k], (k == 1)?tripled:triple, NULL);
+        CHECK(mapped >= 0);
+        CHECK(ALsize(mapped) == n);
+        CHECK(ALsize(lists[k]) == n);
+        for (i = 0; i < n; i++) {
+            CHECK(ALget(mapped, i) == (void *)(3*(long)(i + 1)));
+        }
+        ALdispose(mapped);
+        ALdispose(lists[k]);
+    }
+    CHECK(ALmap(lists[0], triple, NULL) == -1);
+}
+
+static void pops(int layout, unsigned long *state) {
+    ArrayList list = (layout == 0)?ALnew(0):(layout == 1)
+        ?ALnewsized(0, sizeof(struct _Record)):ALnewsegmented(64, 0);
+    struct _Record r, *p = NULL;
+    int head = POPS, tail = POPS;
+    long fresh = 1;
+    int i = 0;
+    
+    CHECK(ALpopfront(list) == NULL);
+    CHECK(ALpopback(list) == NULL);
+    for (i = 0; i < POPS; i++) {
+        r.value = fresh;
+        r.twice = 2*fresh;
+        switch (nextrand(state) % 4) {
+            case 0:
+                CHECK(ALpushfront(list, (layout == 1)?(void *)&r:(void *)fresh) != NULL);
+                ref[--head] = fresh++;
+                break;
+            case 1:
+                CHECK(ALadd(list, (layout == 1)?(void *)&r:(void *)fresh) != NULL);
+                ref[tail++] = fresh++;
+                break;
+            case 2:
+                if (head < tail) {
+                    CHECK(ALpopfront(list) == ((layout == 1)?NULL:(void *)ref[head]));
+                    head++;
+                }
+                break;
+            default:
+                if (head < tail) {
+                    tail--;
+                    CHECK(ALpopback(list) == ((layout == 1)?NULL:(void *)ref[tail]));
+                }
+                break;
+        }
+        CHECK(ALsize(list) == tail - head);
+        if ((head < tail) && (layout == 1)) {
+            p = ALget(list, 0);
+            CHECK((p->value == ref[head]) && (p->twice == 2*ref[head]));
+            p = ALget(list, tail - head - 1);
+            CHECK(p->value == ref[tail - 1]);
+        }
+    }
+    for (i = 0; i < tail - head; i++) {
+        p = ALget(list, i);
+        CHECK(((layout == 1)?p->value:(long)p) == ref[head + i]);
+    }
+    while (head < tail) {
+        CHECK(ALpopfront(list) == ((layout == 1)?NULL:(void *)ref[head]));
+        head++;
+    }
+    CHECK(ALsize(list) == 0);
+    CHECK(ALpopback(list) == NULL);
+    ALdispose(list);
+}
+
+/*
+ * Yields now and then so the pool gets to steal chunks of the locked
+ * list, leaving its owner waiting for them.
+ */
+static void count(void *elem, void *ctx) {
+    struct _Crossing *c = ctx;
+    
+    if (((long)elem & 255) == 0) {
+        sched_yield();
+    }
+    __atomic_add_fetch(&c->visits, 1, __ATOMIC_RELAXED);
+}
+
+static void reads(void *elem, void *ctx) {
+    struct _Crossing *c = ctx;
+    
+    CHECK(elem != NULL);
+    CHECK(ALget(c->locked, 0) != NULL);
+    __atomic_add_fetch(&c->visits, 1, __ATOMIC_RELAXED);
+}
+
+static int descending(const void *x, const void *y) {
+    return (x < y) - (x > y);
+}
+
+static void *traverseother(void *arg) {
+    struct _Crossing *c = arg;
+    int round = 0;
+    
+    for (round = 0; round < ROUNDS; round++) {
+        ALforeach(c->other, reads, c);
+    }
+    return NULL;
+}
+
+/*
+ * The other thread's callbacks only ever wait for the locked list, so
+ * everything must finish and visit every element.
+ */
+static void crossing(struct _Crossing *c, int sort) {
+    pthread_t tid;
+    int round = 0;
+    
+    c->visits = 0;
+    CHECK(pthread_create(&tid, NULL, traverseother, c) == 0);
+    for (round = 0; round < ROUNDS; round++) {
+        if (sort) {
+            ALsort(c->locked, descending);
+        } else {
+            ALforeach(c->locked, count, c);
+        }
+    }
+    CHECK(pthread_join(tid, NULL) == 0);
+    CHECK(c->visits == (long)ROUNDS*LONG*(2 - sort));
+    if (sort) {
+        CHECK(ALget(c->locked, 0) == (void *)(long)LONG);
+        CHECK(ALget(c->locked, LONG - 1) == (void *)1L);
+    }
+}
+
+int main(void) {
+    struct _Crossing c = { -1, -1, 0 };
+    unsigned long state = 12;
+    long v = 0;
+    int layout = 0;
+    
+    freopen("/dev/null", "w", stderr);
+    alarm(120);
+    if (TPthreads() < 4) {
+        TPsetthreads(4);
+    }
+    c.locked = ALnew(LONG);
+    c.other = ALnew(LONG);
+    for (v = 1; v <= LONG; v++) {
+        CHECK(ALadd(c.locked, (void *)v) != NULL);
+        CHECK(ALadd(c.other, (void *)v) != NULL);
+    }
+    crossing(&c, 0);
+    crossing(&c, 1);
+    ALdispose(c.other);
+    ALdispose(c.locked);
+    maps(SHORT);
+    maps(LONG);
+    for (layout = 0; layout < 3; layout++) {
+        pops(layout, &state);
+    }
+    printf("ok\n");
+    return 0;
+}
@@ -0,0 +1,216 @@
+/**
+ *  @file   test_unrolledlist.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Randomized checks of UnrolledList chunk upkeep and iterators
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Fills lists with whole chunks and inserts and removes at the chunk
+ *  edges, so full chunks split and sparse ones merge, then empties lists
+ *  from the head and from the tail. An iterator then walks a small list
+ *  both ways at random, removing and inserting across chunk edges. A
+ *  plain array takes every step too and the list is compared against it
+ *  after each one.
+ */
+#include "harness.h"
+#include <string.h>
+#include "unrolledlist.h"
+
+#define CHUNKS 8
+#define MAXSIZE 1024
+#define STEPS 200000
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static void *ref[MAXSIZE];
+static int nref = 0;
+static long fresh = 1;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void refinsert(int i, void *elem) {
+    memmove(&ref[i + 1], &ref[i], sizeof(void *)*(nref - i));
+    ref[i] = elem;
+    nref++;
+}
+
+static void refremove(int i) {
+    memmove(&ref[i], &ref[i + 1], sizeof(void *)*(nref - i - 1));
+    nref--;
+}
+
+static void checklist(UnrolledList list) {
+    iterator it = ULiterator(list);
+    void **all = ULtoarray(list);
+    int i = 0;
+    
+    CHECK(ULsize(list) == nref);
+    for (i = 0; i < nref; i++) {
+        CHECK(all[i] == ref[i]);
+        CHECK(ULget(list, i) == ref[i]);
+        CHECK(it.next(&it) == ref[i]);
+    }
+    CHECK(!it.hasnext);
+    for (i = nref - 1; i >= 0; i--) {
+        CHECK(it.prev(&it) == ref[i]);
+    }
+    CHECK(!it.hasprev);
+    free(all);
+}
+
+static void insert(UnrolledList list, int i) {
+    if (i == nref) {
+        ULadd(list, (void *)fresh);
+    } else {
+        ULset(list, i, (void *)fresh);
+    }
+    refinsert(i, (void *)fresh++);
+    checklist(list);
+}
+
+static void removeat(UnrolledList list, int i) {
+    CHECK(ULremove(list, i) == ref[i]);
+    refremove(i);
+    checklist(list);
+}
+
+static void fill(UnrolledList list, int n) {
+    while (nref < n) {
+        insert(list, nref);
+    }
+}
+
+/*
+ * Appends keep chunks packed, so with whole chunks every multiple of
+ * UL_CHUNKCAP is a chunk edge and every insert there splits a full one.
+ */
+static void edges(void) {
+    UnrolledList list = ULnew();
+    int k = 0;
+    
+    nref = 0;
+    fill(list, CHUNKS*UL_CHUNKCAP);
+    for (k = CHUNKS - 1; k > 0; k--) {
+        insert(list, k*UL_CHUNKCAP);
+        insert(list, k*UL_CHUNKCAP - 1);
+        insert(list, k*UL_CHUNKCAP + 1);
+    }
+    insert(list, 0);
+    insert(list, nref);
+    for (k = 0; nref > UL_CHUNKCAP; k = (k + UL_CHUNKCAP/2) % nref) {
+        removeat(list, k);
+    }
+    while (nref > 0) {
+        removeat(list, nref/2);
+    }
+    insert(list, 0);
+    ULdispose(list);
+}
+
+static void drain(int fromtail) {
+    UnrolledList list = ULnew();
+    
+    nref = 0;
+    fill(list, CHUNKS*UL_CHUNKCAP + UL_CHUNKCAP/2);
+    insert(list, UL_CHUNKCAP);
+    insert(list, 2*UL_CHUNKCAP + 1);
+    while (nref > 0) {
+        removeat(list, fromtail?(nref - 1):0);
+    }
+    CHECK(ULget(list, 0) == NULL);
+    fill(list, UL_CHUNKCAP + 1);
+    ULdispose(list);
+}
+
+/*
+ * cursor is the position next would return, last that of the element
+ * the last next or prev returned, -1 after a remove or an insert.
+ */
+static void walk(unsigned long *state) {
+    UnrolledList list = ULnew();
+    iterator it;
+    int cursor = 0, last = -1, step = 0;
+    
+    nref = 0;
+    fill(list, 3*UL_CHUNKCAP);
+    it = ULiterator(list);
+    for (step = 0; step < STEPS; step++) {
+        CHECK(it.hasnext == (cursor < nref));
+        CHECK(it.hasprev == (cursor > 0));
+        switch (nextrand(state) % 4) {
+            case 0:
+                if (cursor < nref) {
+                    CHECK(it.next(&it) == ref[cursor]);
+                    last = cursor++;
+                }
+                break;
+            case 1:
+                if (cursor > 0) {
+                    CHECK(it.prev(&it) == ref[--cursor]);
+                    last = cursor;
+                }
+                break;
+            case 2:
+                if (last >= 0) {
+                    CHECK(it.remove(&it) == ref[last]);
+                    refremove(last);
+                    if (last < cursor) {
+                        cursor--;
+                    }
+                    last = -1;
+                }
+                break;
+            default:
+                if (nref < 6*UL_CHUNKCAP) {
+                    it.insert(&it, (void *)fresh);
+                    refinsert(cursor++, (void *)fresh++);
+                    last = -1;
+                }
+                break;
+        }
+        if (step % 64 == 0) {
+            CHECK(ULsize(list) == nref);
+            CHECK((nref == 0) || (ULget(list, nref - 1) == ref[nref - 1]));
+        }
+    }
+    checklist(list);
+    ULdispose(list);
+}
+
+
+int main(void) {
+    unsigned long state = 0x9E3779B97F4A7C15UL;
+    
+    edges();
+    drain(0);
+    drain(1);
+    walk(&state);
+    printf("ok\n");
+    return 0;
+}
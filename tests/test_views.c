@@ -0,0 +1,178 @@
+/**
+ *  @file   test_views.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Checks that ArrayList views stay frozen while writers change the list
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  A writer keeps a segmented list holding g, g+1, ..., g+n-1 whenever it
+ *  publishes, and in between removes from the front, appends, inserts and
+ *  removes again in the middle, so it keeps writing to blocks that views
+ *  still hold. Readers take views with ALsnapshot, check that each holds
+ *  such a run, then check again after the writer has moved on before
+ *  releasing it. Plain and record lists are both covered. Clean under
+ *  make check CFLAGS="-O1 -g -fsanitize=thread".
+ */
+#include "harness.h"
+#include <pthread.h>
+#include <sched.h>
+#include "arraylist.h"
+
+#define BLOCK 16
+#define START 200
+#define ROUNDS 20000
+#define READERS 4
+#define VIEWS 3000
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Record {
+    long value;
+    long negated;
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static ArrayList list = -1;
+static char record = 0;
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void *elem(long v, struct _Record *r) {
+    r->value = v;
+    r->negated = -v;
+    return record?(void *)r:(void *)v;
+}
+
+static long viewvalue(view *v, int i) {
+    struct _Record *r = ALviewget(v, i);
+    
+    if (!record) {
+        return (long)r;
+    }
+    CHECK(r->negated == -r->value);
+    return r->value;
+}
+
+/*
+ * The run a view holds must not change while it is held.
+ */
+static void *reader(void *arg) {
+    view *v = NULL;
+    long first = 0;
+    int n = 0, i = 0, k = 0;
+    
+    (void)arg;
+    for (k = 0; k < VIEWS; k++) {
+        CHECK((v = ALsnapshot(list)) != NULL);
+        n = ALviewsize(v);
+        CHECK(n > 0);
+        first = viewvalue(v, 0);
+        for (i = 0; i < n; i++) {
+            CHECK(viewvalue(v, i) == first + i);
+        }
+        sched_yield();
+        CHECK(ALviewsize(v) == n);
+        for (i = n - 1; i >= 0; i--) {
+            CHECK(viewvalue(v, i) == first + i);
+        }
+        CHECK(ALviewget(v, n) == NULL);
+        ALviewrelease(v);
+    }
+    return NULL;
+}
+
+static void *writer(void *arg) {
+    unsigned long state = 0x2545F4914F6CDD1DUL;
+    struct _Record r;
+    long first = 1, n = START;
+    int round = 0, i = 0;
+    
+    (void)arg;
+    for (round = 0; round < ROUNDS; round++) {
+        ALremove(list, 0);
+        first++;
+        CHECK(ALadd(list, elem(first + n - 1, &r)) != NULL);
+        if ((nextrand(&state) % 2) && (n < 4*START)) {
+            CHECK(ALadd(list, elem(first + n, &r)) != NULL);
+            n++;
+        } else if (n > START/2) {
+            ALremove(list, (int)n - 1);
+            n--;
+        }
+        i = (int)(nextrand(&state) % n);
+        CHECK(ALset(list, i, elem(-1, &r)) != NULL);
+        ALremove(list, i);
+        CHECK(ALpublish(list) == 0);
+    }
+    return NULL;
+}
+
+static void run(void) {
+    pthread_t readers[READERS];
+    pthread_t w;
+    struct _Record r;
+    view *v = NULL;
+    long i = 0;
+    
+    list = record?ALnewsegmented(BLOCK, sizeof(struct _Record)):ALnewsegmented(BLOCK, 0);
+    CHECK(list >= 0);
+    for (i = 1; i <= START; i++) {
+        CHECK(ALadd(list, elem(i, &r)) != NULL);
+    }
+    CHECK(ALpublish(list) == 0);
+    v = ALsnapshot(list);
+    
+    CHECK(pthread_create(&w, NULL, writer, NULL) == 0);
+    for (i = 0; i < READERS; i++) {
+        CHECK(pthread_create(&readers[i], NULL, reader, NULL) == 0);
+    }
+    CHECK(pthread_join(w, NULL) == 0);
+    for (i = 0; i < READERS; i++) {
+        CHECK(pthread_join(readers[i], NULL) == 0);
+    }
+    
+    CHECK(ALviewsize(v) == START);
+    for (i = 0; i < START; i++) {
+        CHECK(viewvalue(v, (int)i) == i + 1);
+    }
+    ALviewrelease(v);
+    ALdispose(list);
+}
+
+
+int main(void) {
+    for (record = 0; record < 2; record++) {
+        run();
+    }
+    printf("ok\n");
+    return 0;
+}
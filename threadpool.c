@@ -0,0 +1,455 @@
+/**
+ *  @file   threadpool.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Fork-join worker pool used by the parallel algorithms
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#if !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <errno.h>
+#if !defined(MOUSTASHED_NOTHREADS)
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+#include "threadpool.h"
+
+#ifndef MOUSTASHED_ERROR_STRINGS
+#define MOUSTASHED_ERROR_STRINGS
+#define S_NOMEM "Allocating memory"
+#define S_EFAULT "Invalid handler"
+#endif
+
+#if !defined(MOUSTASHED_NOTHREADS)
+
+#define TP_DEQUECAP 4096
+#define TP_MAXDEQUES (2*TP_MAXTHREADS)
+#define TP_SPINS 64
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Task {
+    void (*fn)(void *);
+    void *arg;
+    taskgroup *group;
+    struct _Task *next;
+};
+
+/*
+ * Chase-Lev deque: the owner pushes and pops at the bottom, thieves take
+ * from the top. Indices only grow; slots wrap around the fixed ring.
+ * nextfree links the deque on the pool's free stack once its thread has
+ * exited.
+ */
+struct _Deque {
+    long top;
+    char pad1[64 - sizeof(long)];
+    long bottom;
+    char pad2[64 - sizeof(long)];
+    struct _Task *tasks[TP_DEQUECAP];
+    struct _Task *spare;
+    struct _Deque *nextfree;
+};
+
+struct _Pool {
+    pthread_mutex_t lock;
+    pthread_cond_t wake;
+    pthread_once_t once;
+    pthread_key_t key;
+    int started;
+    int active;
+    int sleepers;
+    int ndeques;
+    struct _Deque *freedeques;
+    struct _Deque *deques[TP_MAXDEQUES];
+};
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static struct _Pool pool = {
+    PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_ONCE_INIT,
+    0, 0, -1, 0, 0, NULL, {NULL}
+};
+static __thread struct _Deque *self = NULL;
+static __thread unsigned int seed = 0;
+
+/**
+ * Static-scope functions declaration
+ *
+ */
+static void startpool(void);
+static void startworkers(int);
+static void *worker(void *);
+static struct _Deque *mydeque(void);
+static void releasedeque(void *);
+static int push(struct _Deque *, struct _Task *);
+static struct _Task *pop(struct _Deque *);
+static struct _Task *steal(struct _Deque *);
+static struct _Task *findtask(struct _Deque *);
+static void runtask(struct _Deque *, struct _Task *);
+
+
+/**
+ * Functions definition
+ *
+ */
+
+/*
+ * Pushes the task on the calling thread's own deque. When the deque is
+ * full, or the thread could not get one or a task record, the task
+ * simply runs inline.
+ */
+void TPspawn(taskgroup *group, void (*fn)(void *), void *arg) {
+    struct _Deque *d = NULL;
+    struct _Task *t = NULL;
+    
+    pthread_once(&pool.once, startpool);
+    if ((d = mydeque()) == NULL) {
+        fn(arg);
+        return;
+    }
+    if (d->spare != NULL) {
+        t = d->spare;
+        d->spare = t->next;
+    } else if ((t = malloc(sizeof(struct _Task))) == NULL) {
+        fn(arg);
+        return;
+    }
+    t->fn = fn;
+    t->arg = arg;
+    t->group = group;
+    __atomic_add_fetch(&group->pending, 1, __ATOMIC_RELAXED);
+    if (!push(d, t)) {
+        runtask(d, t);
+        return;
+    }
+    if (__atomic_load_n(&pool.sleepers, __ATOMIC_SEQ_CST) > 0) {
+        pthread_mutex_lock(&pool.lock);
+        pthread_cond_signal(&pool.wake);
+        pthread_mutex_unlock(&pool.lock);
+    }
+}
+
+/*
+ * Runs its own tasks first, newest first, then steals from the others
+ * while the group still has pending ones. A thread without a deque only
+ * steals. Confined groups never steal, and a task of another group found
+ * on the own deque is pushed back where it was.
+ */
+void TPwait(taskgroup *group) {
+    struct _Deque *d = NULL;
+    struct _Task *t = NULL;
+    
+    if (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) == 0) {
+        return;
+    }
+    d = mydeque();
+    while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) > 0) {
+        if (!group->confined) {
+            t = findtask(d);
+        } else if (((t = (d != NULL)?pop(d):NULL) != NULL) && (t->group != group)) {
+            push(d, t);
+            t = NULL;
+        }
+        if (t != NULL) {
+            runtask(d, t);
+        } else {
+            sched_yield();
+        }
+    }
+}
+
+int TPthreads(void) {
+    pthread_once(&pool.once, startpool);
+    return __atomic_load_n(&pool.active, __ATOMIC_RELAXED) + 1;
+}
+
+/*
+ * Sets how many threads, the waiting one included, run tasks.
+ */
+void TPsetthreads(int n) {
+    if (n < 1) {
+        n = 1;
+    } else if (n > TP_MAXTHREADS) {
+        n = TP_MAXTHREADS;
+    }
+    pthread_mutex_lock(&pool.lock);
+    __atomic_store_n(&pool.active, n - 1, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&pool.lock);
+    pthread_once(&pool.once, startpool);
+    startworkers(n - 1);
+    pthread_mutex_lock(&pool.lock);
+    pthread_cond_broadcast(&pool.wake);
+    pthread_mutex_unlock(&pool.lock);
+}
+
+
+/**
+ * Static-scope functions definition
+ *
+ */
+static void startpool(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    
+    pthread_key_create(&pool.key, releasedeque);
+    pthread_mutex_lock(&pool.lock);
+    if (pool.active < 0) {
+        n = (n > 1)?((n > TP_MAXTHREADS)?TP_MAXTHREADS:n) - 1:0;
+        __atomic_store_n(&pool.active, (int)n, __ATOMIC_RELAXED);
+    }
+    n = pool.active;
+    pthread_mutex_unlock(&pool.lock);
+    startworkers((int)n);
+}
+
+/*
+ * Workers are only ever added; the ones above the active count sleep.
+ */
+static void startworkers(int n) {
+    pthread_t tid;
+    
+    pthread_mutex_lock(&pool.lock);
+    while (pool.started < n) {
+        if (pthread_create(&tid, NULL, worker, (void *)(size_t)pool.started) != 0) {
+            break;
+        }
+        pthread_detach(tid);
+        pool.started++;
+    }
+    pthread_mutex_unlock(&pool.lock);
+}
+
+/*
+ * A worker that found nothing to steal for a while goes to sleep. It
+ * announces itself in sleepers before its last look, and spawners check
+ * sleepers after pushing, so a task is never left behind unnoticed.
+ */
+static void *worker(void *arg) {
+    int id = (int)(size_t)arg;
+    struct _Deque *d = mydeque();
+    struct _Task *t = NULL;
+    int idle = 0;
+    
+    for (;;) {
+        if ((id < __atomic_load_n(&pool.active, __ATOMIC_RELAXED))
+            && ((t = findtask(d)) != NULL)) {
+            runtask(d, t);
+            idle = 0;
+        } else if (++idle < TP_SPINS) {
+            sched_yield();
+        } else {
+            pthread_mutex_lock(&pool.lock);
+            __atomic_add_fetch(&pool.sleepers, 1, __ATOMIC_SEQ_CST);
+            if ((id >= pool.active) || ((t = findtask(d)) == NULL)) {
+                pthread_cond_wait(&pool.wake, &pool.lock);
+            }
+            __atomic_sub_fetch(&pool.sleepers, 1, __ATOMIC_SEQ_CST);
+            pthread_mutex_unlock(&pool.lock);
+            if (t != NULL) {
+                runtask(d, t);
+            }
+            idle = 0;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Every thread that spawns or runs tasks gets a deque of its own the
+ * first time it does so, preferably one left by a thread that exited.
+ * Deques stay in the table for good, since thieves may still be looking
+ * at them, and their indices keep growing across owners. Returns NULL
+ * when every deque is taken or none can be allocated.
+ */
+static struct _Deque *mydeque(void) {
+    struct _Deque *d = self;
+    
+    if (d != NULL) {
+        return d;
+    }
+    pthread_mutex_lock(&pool.lock);
+    if ((d = pool.freedeques) != NULL) {
+        pool.freedeques = d->nextfree;
+    } else if ((pool.ndeques < TP_MAXDEQUES)
+               && (posix_memalign((void **)&d, 64, sizeof(struct _Deque)) == 0)) {
+        d->top = 0;
+        d->bottom = 0;
+        d->spare = NULL;
+        pool.deques[pool.ndeques] = d;
+        __atomic_store_n(&pool.ndeques, pool.ndeques + 1, __ATOMIC_RELEASE);
+    } else {
+        pthread_mutex_unlock(&pool.lock);
+        return NULL;
+    }
+    pthread_mutex_unlock(&pool.lock);
+    pthread_setspecific(pool.key, d);
+    seed = (unsigned int)(size_t)d;
+    self = d;
+    return d;
+}
+
+/*
+ * Runs on thread exit. Tasks the thread spawned but never waited for are
+ * run here, then its spare tasks are freed and the deque is put back.
+ */
+static void releasedeque(void *arg) {
+    struct _Deque *d = arg;
+    struct _Task *t = NULL;
+    
+    while ((t = pop(d)) != NULL) {
+        runtask(d, t);
+    }
+    while ((t = d->spare) != NULL) {
+        d->spare = t->next;
+        free(t);
+    }
+    self = NULL;
+    pthread_mutex_lock(&pool.lock);
+    d->nextfree = pool.freedeques;
+    pool.freedeques = d;
+    pthread_mutex_unlock(&pool.lock);
+}
+
+static int push(struct _Deque *d, struct _Task *t) {
+    long b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED);
+    long top = __atomic_load_n(&d->top, __ATOMIC_ACQUIRE);
+    
+    if (b - top >= TP_DEQUECAP) {
+        return 0;
+    }
+    __atomic_store_n(&d->tasks[b & (TP_DEQUECAP - 1)], t, __ATOMIC_RELAXED);
+    __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELEASE);
+    return 1;
+}
+
+static struct _Task *pop(struct _Deque *d) {
+    long b = __atomic_load_n(&d->bottom, __ATOMIC_RELAXED) - 1;
+    long t = 0;
+    struct _Task *task = NULL;
+    
+    __atomic_store_n(&d->bottom, b, __ATOMIC_SEQ_CST);
+    t = __atomic_load_n(&d->top, __ATOMIC_SEQ_CST);
+    if (t <= b) {
+        task = __atomic_load_n(&d->tasks[b & (TP_DEQUECAP - 1)], __ATOMIC_RELAXED);
+        if (t == b) {
+            if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, 0,
+                                             __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+                task = NULL;
+            }
+            __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+        }
+    } else {
+        __atomic_store_n(&d->bottom, b + 1, __ATOMIC_RELAXED);
+    }
+    return task;
+}
+
+static struct _Task *steal(struct _Deque *d) {
+    long t = __atomic_load_n(&d->top, __ATOMIC_SEQ_CST);
+    long b = __atomic_load_n(&d->bottom, __ATOMIC_SEQ_CST);
+    struct _Task *task = NULL;
+    
+    if (t < b) {
+        task = __atomic_load_n(&d->tasks[t & (TP_DEQUECAP - 1)], __ATOMIC_RELAXED);
+        if (!__atomic_compare_exchange_n(&d->top, &t, t + 1, 0,
+                                         __ATOMIC_SEQ_CST, __ATOMIC_RELAXED)) {
+            return NULL;
+        }
+    }
+    return task;
+}
+
+/*
+ * Pops from the own deque, then tries every other deque once starting
+ * from a random victim.
+ */
+static struct _Task *findtask(struct _Deque *d) {
+    struct _Task *t = NULL;
+    int n = 0, i = 0, start = 0;
+    
+    if ((d != NULL) && ((t = pop(d)) != NULL)) {
+        return t;
+    }
+    if ((n = __atomic_load_n(&pool.ndeques, __ATOMIC_ACQUIRE)) == 0) {
+        return NULL;
+    }
+    seed = seed*1103515245u + 12345u;
+    start = (int)((seed >> 16) % (unsigned int)n);
+    for (i = 0; i < n; i++) {
+        d = pool.deques[(start + i) % n];
+        if ((d != self) && ((t = steal(d)) != NULL)) {
+            return t;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * Finished tasks go back to the free list of whichever thread ran them,
+ * or are freed when it has no deque.
+ */
+static void runtask(struct _Deque *d, struct _Task *t) {
+    taskgroup *group = t->group;
+    
+    t->fn(t->arg);
+    if (d != NULL) {
+        t->next = d->spare;
+        d->spare = t;
+    } else {
+        free(t);
+    }
+    __atomic_sub_fetch(&group->pending, 1, __ATOMIC_RELEASE);
+}
+
+#else
+
+void TPspawn(taskgroup *group, void (*fn)(void *), void *arg) {
+    (void)group;
+    fn(arg);
+}
+
+void TPwait(taskgroup *group) {
+    (void)group;
+}
+
+int TPthreads(void) {
+    return 1;
+}
+
+void TPsetthreads(int n) {
+    (void)n;
+}
+
+#endif
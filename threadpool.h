@@ -0,0 +1,65 @@
+/**
+ *  @file   threadpool.h
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Fork-join worker pool used by the parallel algorithms
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *  Tasks are spawned into a group and TPwait blocks until every task of
+ *  the group is done, running queued tasks itself meanwhile, so tasks may
+ *  spawn and wait on groups of their own. Every thread pushes the tasks
+ *  it spawns on a deque of its own and idle threads steal from the
+ *  others. The pool is started on first use with one worker less than
+ *  the number of online processors, the waiting thread being the last
+ *  one. A thread gives its deque back when it exits; while all of them
+ *  are taken, further threads run the tasks they spawn inline.
+ *
+ *  A thread waiting on a confined group runs none but that group's own
+ *  tasks, for callers holding a lock that another group's task might
+ *  need: it only pops the group's task back off its own deque, and yields
+ *  while a thief runs it.
+ */
+#ifndef moustached_threadpool_h
+#define moustached_threadpool_h
+
+#define TP_MAXTHREADS 256
+
+struct _TaskGroup {
+    int pending;
+    char confined;
+};
+typedef struct _TaskGroup taskgroup;
+
+#define TP_GROUP_INITIALIZER { 0, 0 }
+#define TP_CONFINED_INITIALIZER { 0, 1 }
+
+
+void TPspawn(taskgroup*, void (*)(void*), void*);
+void TPwait(taskgroup*);
+
+int TPthreads(void);
+void TPsetthreads(int);
+
+#endif
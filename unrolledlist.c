@@ -0,0 +1,548 @@
+/**
+ *  @file   unrolledlist.c
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Unrolled Doubly-LinkedList
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "unrolledlist.h"
+#include "controller.h"
+
+
+#ifndef MOUSTASHED_ERROR_STRINGS
+#define MOUSTASHED_ERROR_STRINGS
+#define S_NOMEM "Allocating memory"
+#define S_EFAULT "Invalid handler"
+#endif
+
+/**
+ * Struct and Type definitions
+ *
+ */
+struct _Chunk {
+    int used;
+    struct _Chunk *next;
+    struct _Chunk *prev;
+    
+    void *elems[UL_CHUNKCAP];
+};
+
+struct _UnrolledList {
+    int used_buckets;
+    unsigned int modcount;
+    struct _Chunk *head;
+    struct _Chunk *tail;
+};
+
+/*
+ * A position inside the list: the chunk and the offset inside it.
+ * The offset may be equal to the chunk usage, meaning "just after
+ * the last element of the chunk".
+ */
+struct _Position {
+    struct _Chunk *c;
+    int off;
+};
+
+
+/**
+ * Static-scope variables declaration
+ *
+ */
+static struct _Controller controller = CT_INITIALIZER(struct _UnrolledList);
+
+/**
+ * Static-scope functions declaration
+ *
+ */
+static struct _Position locate(struct _UnrolledList *, int);
+static struct _Chunk *newchunk(struct _UnrolledList *, struct _Chunk *);
+static void freechunks(struct _UnrolledList *);
+static void unlinkchunk(struct _UnrolledList *, struct _Chunk *);
+static void insertat(struct _UnrolledList *, struct _Position *, void *);
+static void *removeat(struct _UnrolledList *, struct _Position *);
+static struct _UnrolledList *acquireit(iterator *);
+static void *ULitnext(iterator *);
+static void *ULitprev(iterator *);
+static void *ULitremove(iterator *);
+static void *ULitinsert(iterator *, void *);
+static void ULupdateit(iterator *);
+static void ULresetit(iterator *);
+static void updateit(iterator *, struct _UnrolledList *);
+
+
+UnrolledList ULnew(void) {
+    int handler = -1;
+    struct _UnrolledList *a = NULL;
+    
+    if ((handler = CTclaim(&controller, (void **)&a)) < 0) {
+        return -1;
+    }
+    a->used_buckets = 0;
+    a->head = NULL;
+    a->tail = NULL;
+    CTrelease(a);
+    return handler;
+}
+
+void ULpurge(int handler) {
+    struct _UnrolledList *a = NULL;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        freechunks(a);
+        a->modcount++;
+        CTrelease(a);
+    }
+    return;
+}
+
+void ULdispose(int handler) {
+    struct _UnrolledList *a = NULL;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        freechunks(a);
+        CTdispose(&controller, a);
+    }
+    return;
+}
+
+
+
+void *ULadd(int handler, void *elem) {
+    struct _UnrolledList *a = NULL;
+    struct _Position pos;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        pos.c = a->tail;
+        pos.off = (a->tail != NULL)?a->tail->used:0;
+        insertat(a, &pos, elem);
+        CTrelease(a);
+    }
+    return elem;
+}
+
+void *ULget(int handler, int i) {
+    void *elem = NULL;
+    struct _UnrolledList *a = NULL;
+    struct _Position pos;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        if ((i >= 0) && (i < a->used_buckets)) {
+            pos = locate(a, i);
+            elem = pos.c->elems[pos.off];
+        } else {
+            errno = EINVAL;
+        }
+        CTrelease(a);
+    }
+    return elem;
+}
+
+void *ULset(int handler, int i, void *elem) {
+    struct _UnrolledList *a = NULL;
+    struct _Position pos;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        if ((i >= 0) && (i < a->used_buckets)) {
+            pos = locate(a, i);
+            insertat(a, &pos, elem);
+        }
+        CTrelease(a);
+    }
+    return elem;
+}
+
+void *ULremove(int handler, int i) {
+    struct _UnrolledList *a = NULL;
+    struct _Position pos;
+    void *elem = NULL;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        if ((i >= 0) && (i < a->used_buckets)) {
+            pos = locate(a, i);
+            elem = removeat(a, &pos);
+        } else {
+            errno = EINVAL;
+        }
+        CTrelease(a);
+    }
+    return elem;
+}
+
+
+int ULsize(int handler) {
+    int size = -1;
+    struct _UnrolledList *a = NULL;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        size = a->used_buckets;
+        CTrelease(a);
+    }
+    return size;
+}
+
+void** ULtoarray(int handler) {
+    void **array = NULL;
+    struct _UnrolledList *a = NULL;
+    struct _Chunk *c = NULL;
+    int i = 0;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        array = malloc(sizeof(void *)*a->used_buckets);
+        if (array == NULL) {
+            perror(S_NOMEM);
+            exit(EXIT_FAILURE);
+        }
+        for (c = a->head; c != NULL; c = c->next) {
+            memcpy(&array[i], c->elems, sizeof(void *)*c->used);
+            i += c->used;
+        }
+        CTrelease(a);
+    }
+    return array;
+}
+
+iterator ULiterator(int handler) {
+    iterator it;
+    struct _UnrolledList *a = NULL;
+    if ((a = CTacquire(&controller, handler)) != NULL) {
+        it.handler = handler;
+        it.next = ULitnext;
+        it.prev = ULitprev;
+        it.remove = ULitremove;
+        it.insert = ULitinsert;
+        it.update = ULupdateit;
+        it.reset = ULresetit;
+        CTrelease(a);
+        it.reset(&it);
+    }
+    return it;
+}
+
+
+/**
+ * Static-scope functions definition
+ *
+ */
+/*
+ * Skips whole chunks from whichever end is closer to the index.
+ * The caller must ensure 0 <= i < used_buckets.
+ */
+static struct _Position locate(struct _UnrolledList *a, int i) {
+    struct _Position pos;
+    int base = 0;
+    if (i < (a->used_buckets >> 1)) {
+        pos.c = a->head;
+        while (i - base >= pos.c->used) {
+            base += pos.c->used;
+            pos.c = pos.c->next;
+        }
+    } else {
+        pos.c = a->tail;
+        base = a->used_buckets - pos.c->used;
+        while (i < base) {
+            pos.c = pos.c->prev;
+            base -= pos.c->used;
+        }
+    }
+    pos.off = i - base;
+    return pos;
+}
+
+/*
+ * Allocates an empty chunk and links it after the given one, or as the
+ * head when it is NULL.
+ */
+static struct _Chunk *newchunk(struct _UnrolledList *a, struct _Chunk *after) {
+    struct _Chunk *c = NULL;
+    c = malloc(sizeof(struct _Chunk));
+    if (c == NULL) {
+        perror(S_NOMEM);
+        exit(EXIT_FAILURE);
+    }
+    c->used = 0;
+    c->prev = after;
+    c->next = (after != NULL)?after->next:a->head;
+    if (c->next != NULL) {
+        c->next->prev = c;
+    } else {
+        a->tail = c;
+    }
+    if (after != NULL) {
+        after->next = c;
+    } else {
+        a->head = c;
+    }
+    return c;
+}
+
+static void freechunks(struct _UnrolledList *a) {
+    struct _Chunk *c = a->head;
+    struct _Chunk *next = NULL;
+    while (c != NULL) {
+        next = c->next;
+        free(c);
+        c = next;
+    }
+    a->used_buckets = 0;
+    a->head = NULL;
+    a->tail = NULL;
+}
+
+static void unlinkchunk(struct _UnrolledList *a, struct _Chunk *c) {
+    if (c->next) {
+        c->next->prev = c->prev;
+    } else {
+        a->tail = c->prev;
+    }
+    if (c->prev) {
+        c->prev->next = c->next;
+    } else {
+        a->head = c->next;
+    }
+    free(c);
+}
+
+/*
+ * Inserts elem at the position and leaves the position just after it.
+ * A full chunk is split in half, except at the tail where a fresh chunk
+ * is started so that appends keep chunks completely packed.
+ */
+static void insertat(struct _UnrolledList *a, struct _Position *pos, void *elem) {
+    struct _Chunk *c = pos->c;
+    struct _Chunk *n = NULL;
+    int half = 0;
+    
+    if (c == NULL) {
+        c = newchunk(a, NULL);
+        pos->off = 0;
+    } else if (c->used == UL_CHUNKCAP) {
+        if ((pos->off == UL_CHUNKCAP) && (c->next == NULL)) {
+            c = newchunk(a, c);
+            pos->off = 0;
+        } else {
+            half = UL_CHUNKCAP >> 1;
+            n = newchunk(a, c);
+            memcpy(n->elems, &c->elems[half], sizeof(void *)*(c->used - half));
+            n->used = c->used - half;
+            c->used = half;
+            if (pos->off > half) {
+                c = n;
+                pos->off -= half;
+            }
+        }
+    }
+    memmove(&c->elems[pos->off + 1], &c->elems[pos->off],
+            sizeof(void *)*(c->used - pos->off));
+    c->elems[pos->off] = elem;
+    c->used++;
+    pos->c = c;
+    pos->off++;
+    a->used_buckets++;
+    a->modcount++;
+}
+
+/*
+ * Removes the element at the position, which is left pointing at the
+ * element that followed it. Chunks that drop below half usage are merged
+ * with a neighbour whenever both fit in a single chunk.
+ */
+static void *removeat(struct _UnrolledList *a, struct _Position *pos) {
+    struct _Chunk *c = pos->c;
+    struct _Chunk *p = NULL;
+    void *elem = c->elems[pos->off];
+    
+    memmove(&c->elems[pos->off], &c->elems[pos->off + 1],
+            sizeof(void *)*(c->used - pos->off - 1));
+    c->used--;
+    a->used_buckets--;
+    a->modcount++;
+    
+    if (c->used == 0) {
+        if (c->next != NULL) {
+            pos->c = c->next;
+            pos->off = 0;
+        } else {
+            pos->c = c->prev;
+            pos->off = (c->prev != NULL)?c->prev->used:0;
+        }
+        unlinkchunk(a, c);
+    } else if (c->used < (UL_CHUNKCAP >> 1)) {
+        if ((c->next != NULL) && (c->used + c->next->used <= UL_CHUNKCAP)) {
+            memcpy(&c->elems[c->used], c->next->elems, sizeof(void *)*c->next->used);
+            c->used += c->next->used;
+            unlinkchunk(a, c->next);
+        } else if ((c->prev != NULL) && (c->prev->used + c->used <= UL_CHUNKCAP)) {
+            p = c->prev;
+            memcpy(&p->elems[p->used], c->elems, sizeof(void *)*c->used);
+            pos->c = p;
+            pos->off += p->used;
+            p->used += c->used;
+            unlinkchunk(a, c);
+        }
+    }
+    return elem;
+}
+
+/*
+ * Locks the list behind an iterator. An iterator is only valid while the
+ * list has not been modified through any other path than the iterator
+ * itself.
+ */
+static struct _UnrolledList *acquireit(iterator *it) {
+    struct _UnrolledList *a = NULL;
+    if ((a = CTacquire(&controller, it->handler)) != NULL) {
+        if (it->modcount == a->modcount) {
+            return a;
+        }
+        CTrelease(a);
+    }
+    errno = EFAULT;
+    it->hasnext = 0;
+    it->hasprev = 0;
+    return NULL;
+}
+
+/*
+ * The cursor is the chunk and offset of the element next() returns. It is
+ * not normalised, so the offset may sit past the end of its chunk; last
+ * points at the slot of the element returned by the previous step.
+ */
+static void *ULitnext(iterator *it) {
+    void *elem = NULL;
+    struct _UnrolledList *a = NULL;
+    struct _Chunk *c = NULL;
+    if (it->hasnext && ((a = acquireit(it)) != NULL)) {
+        c = it->cursor;
+        if (it->offset == c->used) {
+            c = c->next;
+            it->cursor = c;
+            it->offset = 0;
+        }
+        it->last = &c->elems[it->offset];
+        elem = c->elems[it->offset];
+        it->offset++;
+        it->carriage++;
+        updateit(it, a);
+        CTrelease(a);
+    }
+    return elem;
+}
+
+static void *ULitprev(iterator *it) {
+    void *elem = NULL;
+    struct _UnrolledList *a = NULL;
+    struct _Chunk *c = NULL;
+    if (it->hasprev && ((a = acquireit(it)) != NULL)) {
+        c = it->cursor;
+        if (it->offset == 0) {
+            c = c->prev;
+            it->cursor = c;
+            it->offset = c->used;
+        }
+        it->offset--;
+        it->last = &c->elems[it->offset];
+        elem = c->elems[it->offset];
+        it->carriage--;
+        updateit(it, a);
+        CTrelease(a);
+    }
+    return elem;
+}
+
+/*
+ * Removes the element returned by the last call to next or prev.
+ */
+static void *ULitremove(iterator *it) {
+    void *elem = NULL;
+    struct _UnrolledList *a = NULL;
+    struct _Position pos;
+    if ((a = acquireit(it)) != NULL) {
+        if (it->last != NULL) {
+            pos.c = it->cursor;
+            pos.off = (int)((void **)it->last - pos.c->elems);
+            if (pos.off < it->offset) {
+                it->carriage--;
+            }
+            elem = removeat(a, &pos);
+            it->cursor = pos.c;
+            it->offset = pos.off;
+            it->last = NULL;
+            it->modcount = a->modcount;
+            updateit(it, a);
+        } else {
+            errno = EINVAL;
+        }
+        CTrelease(a);
+    }
+    return elem;
+}
+
+/*
+ * Inserts elem before the element that would be returned by next.
+ */
+static void *ULitinsert(iterator *it, void *elem) {
+    struct _UnrolledList *a = NULL;
+    struct _Position pos;
+    if ((a = acquireit(it)) != NULL) {
+        pos.c = it->cursor;
+        pos.off = it->offset;
+        insertat(a, &pos, elem);
+        it->cursor = pos.c;
+        it->offset = pos.off;
+        it->carriage++;
+        it->last = NULL;
+        it->modcount = a->modcount;
+        updateit(it, a);
+        CTrelease(a);
+    }
+    return elem;
+}
+
+static void ULupdateit(iterator *it) {
+    struct _UnrolledList *a = NULL;
+    if ((a = acquireit(it)) != NULL) {
+        updateit(it, a);
+        CTrelease(a);
+    }
+    return;
+}
+
+static void ULresetit(iterator *it) {
+    struct _UnrolledList *a = NULL;
+    if ((a = CTacquire(&controller, it->handler)) != NULL) {
+        it->carriage = 0;
+        it->cursor = a->head;
+        it->offset = 0;
+        it->last = NULL;
+        it->modcount = a->modcount;
+        updateit(it, a);
+        CTrelease(a);
+    }
+}
+
+static void updateit(iterator *it, struct _UnrolledList *a) {
+    it->total_elems = a->used_buckets;
+    it->hasnext = (it->carriage < it->total_elems)?1:0;
+    it->hasprev = (it->carriage > 0)?1:0;
+}
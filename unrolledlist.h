@@ -0,0 +1,80 @@
+/**
+ *  @file   unrolledlist.h
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @brief  Unrolled Doubly-LinkedList
+ *
+ *  @author João Pinho
+ *  @link   https://github.com/joaolpinho
+ *
+ *  @date   16/10/2026
+ *
+ *  This file is part of moustashed-library.
+ *
+ *  moustashed-library is a C library of many utils and data structures.
+ *  Copyright (C) 2012  João Pinho
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU Lesser Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU Lesser Public License for more details.
+ *
+ *  You should have received a copy of the GNU Lesser Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#ifndef moustached_unrolledlist_h
+#define moustached_unrolledlist_h
+
+/*
+ * 13 pointers plus the chunk header fill exactly two cache lines
+ * on 64-bit targets.
+ */
+#define UL_CHUNKCAP 13
+
+#if !defined(MOUSTASHED_ITERATOR)
+#define MOUSTASHED_ITERATOR
+struct _Iterator {
+    int handler;
+    int carriage;
+    int total_elems;
+    unsigned int modcount;
+    
+    char hasnext;
+    char hasprev;
+    
+    void *cursor;
+    void *last;
+    int offset;
+    
+    void (*update)(struct _Iterator*);
+    void (*reset)(struct _Iterator*);
+    void *(*next)(struct _Iterator*);
+    void *(*prev)(struct _Iterator*);
+    void *(*remove)(struct _Iterator*);
+    void *(*insert)(struct _Iterator*, void*);
+};
+typedef struct _Iterator iterator;
+#endif
+typedef int UnrolledList;
+
+
+UnrolledList ULnew(void);
+void ULpurge(UnrolledList);
+void ULdispose(UnrolledList);
+
+void *ULadd(UnrolledList, void*);
+void *ULget(UnrolledList, int);
+void *ULset(UnrolledList, int, void*);
+void *ULremove(UnrolledList, int);
+
+int ULsize(UnrolledList);
+void **ULtoarray(UnrolledList);
+iterator ULiterator(UnrolledList);
+
+#endif